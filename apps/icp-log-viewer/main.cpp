@@ -12,6 +12,7 @@
  */
 
 // The goal is to visualize these guys:
+#include <mp2p_icp/LogArchive.h>
 #include <mp2p_icp/LogRecord.h>
 // using this:
 #include <mrpt/gui/CDisplayWindowGUI.h>
@@ -58,6 +59,18 @@ static TCLAP::ValueArg<std::string> argSingleFile(
     "f", "file", "Load just this one single log *.icplog file.", false,
     "log.icplog", "log.icplog", cmd);
 
+static TCLAP::ValueArg<std::string> argArchive(
+    "a", "archive",
+    "Load all records from this log archive file, as generated with the ICP "
+    "parameter `debugArchiveFile`.",
+    false, "log.icparchive", "log.icparchive", cmd);
+
+static TCLAP::ValueArg<std::string> argFilterReason(
+    "", "termination-reason",
+    "Only for --archive: load only those records with this ICP termination "
+    "reason (e.g. `MaxIterations`, `Stalled`).",
+    false, "MaxIterations", "MaxIterations", cmd);
+
 static TCLAP::ValueArg<std::string> arg_plugins(
     "l", "load-plugins",
     "One or more (comma separated) *.so files to load as plugins", false,
@@ -134,12 +147,26 @@ class DelayedLoadLog
     {
     }
 
+    /** A record within a log archive */
+    DelayedLoadLog(
+        const std::shared_ptr<mp2p_icp::LogArchiveReader>& archive,
+        std::size_t indexInArchive, const std::string& shortFileName)
+        : filename_(shortFileName),
+          shortFileName_(shortFileName),
+          archive_(archive),
+          indexInArchive_(indexInArchive)
+    {
+    }
+
     mp2p_icp::LogRecord& get()
     {
         if (!log_)
         {
             // Load now:
-            log_ = mp2p_icp::LogRecord::LoadFromFile(filename_);
+            if (archive_)
+                log_ = archive_->load(indexInArchive_);
+            else
+                log_ = mp2p_icp::LogRecord::LoadFromFile(filename_);
         }
 
         return log_.value();
@@ -153,6 +180,9 @@ class DelayedLoadLog
    private:
     std::optional<mp2p_icp::LogRecord> log_;
     std::string                        filename_, shortFileName_;
+
+    std::shared_ptr<mp2p_icp::LogArchiveReader> archive_;
+    std::size_t                                 indexInArchive_ = 0;
 };
 
 std::vector<DelayedLoadLog> logRecords;
@@ -197,7 +227,42 @@ void main_show_gui()
 
     mrpt::system::CDirectoryExplorer::TFileInfoList files;
 
-    if (!argSingleFile.isSet())
+    if (argArchive.isSet())
+    {
+        // Records from one archive file:
+        const auto archiveFile = argArchive.getValue();
+        std::cout << "Loading log archive: " << archiveFile << std::endl;
+
+        auto archive = std::make_shared<mp2p_icp::LogArchiveReader>();
+        archive->open(archiveFile);
+
+        std::vector<std::size_t> idxs;
+        if (argFilterReason.isSet())
+        {
+            using te = mrpt::typemeta::TEnumType<mp2p_icp::IterTermReason>;
+            const auto reason = te::name2value(argFilterReason.getValue());
+
+            idxs = archive->filter([reason](const auto& r)
+                                   { return r.terminationReason == reason; });
+        }
+        else
+        {
+            for (std::size_t i = 0; i < archive->size(); i++)
+                idxs.push_back(i);
+        }
+
+        std::cout << "Found " << archive->size() << " ICP records ("
+                  << archive->map_count() << " distinct maps), "
+                  << idxs.size() << " selected." << std::endl;
+
+        const auto baseName = mrpt::system::extractFileName(archiveFile);
+        for (const auto idx : idxs)
+        {
+            logRecords.emplace_back(
+                archive, idx, mrpt::format("%s #%05zu", baseName.c_str(), idx));
+        }
+    }
+    else if (!argSingleFile.isSet())
     {
         const std::string searchDir = argSearchDir.getValue();
         ASSERT_DIRECTORY_EXISTS_(searchDir);
@@ -228,7 +293,7 @@ void main_show_gui()
     for (const auto& file : files)
         logRecords.emplace_back(file.wholePath, file.name);
 
-    ASSERT_(!logRecords.empty());
+    ASSERTMSG_(!logRecords.empty(), "No ICP records to show");
 
     // Obtain layer info from first entry:
     {
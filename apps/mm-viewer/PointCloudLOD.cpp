@@ -0,0 +1,475 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   mm-viewer/PointCloudLOD.cpp
+ * @brief  Octree level-of-detail rendering of large point clouds
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include "PointCloudLOD.h"
+
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/math/CHistogram.h>
+#include <mrpt/math/distributions.h>  // confidenceIntervals()
+#include <mrpt/opengl/CPointCloud.h>
+#include <mrpt/opengl/CPointCloudColoured.h>
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_set>
+
+namespace
+{
+void applyPointSize(const mrpt::opengl::CRenderizable::Ptr& o, float pointSize)
+{
+    if (auto glPtsCol =
+            std::dynamic_pointer_cast<mrpt::opengl::CPointCloudColoured>(o);
+        glPtsCol)
+    {
+        glPtsCol->setPointSize(pointSize);
+    }
+    else if (auto glPts =
+                 std::dynamic_pointer_cast<mrpt::opengl::CPointCloud>(o);
+             glPts)
+    {
+        glPts->setPointSize(pointSize);
+    }
+}
+}  // namespace
+
+PointCloudLOD::PointCloudLOD(
+    const mrpt::maps::CPointsMap::Ptr& pts, const Parameters& p)
+    : params_(p), pts_(pts), glRoot_(mrpt::opengl::CSetOfObjects::Create())
+{
+    ASSERT_(pts_);
+    ASSERT_GT_(params_.maxPointsPerNode, 0U);
+    ASSERT_GT_(params_.decimationCellsPerSide, 0U);
+    ASSERT_LE_(params_.decimationCellsPerSide, 1024U);
+
+    // A decimated sample must never be truncated, or it would only cover the
+    // part of the node with the first points:
+    const uint64_t G = params_.decimationCellsPerSide;
+    ASSERTMSG_(
+        G * G * G <= params_.maxPointsPerNode,
+        "decimationCellsPerSide^3 must not be larger than maxPointsPerNode");
+
+    if (pts_->empty()) return;
+
+    // Root node: a cube enclosing the whole cloud:
+    const auto bb = pts_->boundingBox();
+
+    Node root;
+    root.center   = (bb.min + bb.max) * 0.5f;
+    root.halfSize = 0.5f * std::max(
+                               {bb.max.x - bb.min.x, bb.max.y - bb.min.y,
+                                bb.max.z - bb.min.z});
+    // Make sure all points are strictly inside:
+    root.halfSize = root.halfSize * 1.001f + 1e-3f;
+    nodes_.push_back(root);
+
+    std::vector<uint32_t> idxs(pts_->size());
+    for (size_t i = 0; i < idxs.size(); i++) idxs[i] = static_cast<uint32_t>(i);
+
+    build(0, std::move(idxs), 0);
+}
+
+void PointCloudLOD::build(
+    int32_t nodeIdx, std::vector<uint32_t>&& idxs, std::size_t depth)
+{
+    // Note: nodes_ grows below, so do not keep references to its elements
+    // across recursive calls.
+    if (idxs.size() <= params_.maxPointsPerNode || depth >= params_.maxDepth)
+    {
+        auto& node   = nodes_[nodeIdx];
+        node.isLeaf  = true;
+        node.spacing = 0;
+        node.sample  = std::move(idxs);
+        return;
+    }
+
+    nodes_[nodeIdx].isLeaf = false;
+    decimate(nodes_[nodeIdx], idxs);
+
+    const auto  c = nodes_[nodeIdx].center;
+    const float h = 0.5f * nodes_[nodeIdx].halfSize;
+
+    const auto& xs = pts_->getPointsBufferRef_x();
+    const auto& ys = pts_->getPointsBufferRef_y();
+    const auto& zs = pts_->getPointsBufferRef_z();
+
+    std::array<std::vector<uint32_t>, 8> childIdxs;
+    for (const uint32_t i : idxs)
+    {
+        const unsigned int octant = (xs[i] >= c.x ? 1 : 0) |
+                                    (ys[i] >= c.y ? 2 : 0) |
+                                    (zs[i] >= c.z ? 4 : 0);
+        childIdxs[octant].push_back(i);
+    }
+    // Free memory before going down:
+    idxs.clear();
+    idxs.shrink_to_fit();
+
+    for (unsigned int octant = 0; octant < 8; octant++)
+    {
+        if (childIdxs[octant].empty()) continue;
+
+        Node child;
+        child.center = {
+            c.x + ((octant & 1) ? h : -h), c.y + ((octant & 2) ? h : -h),
+            c.z + ((octant & 4) ? h : -h)};
+        child.halfSize = h;
+        child.parent   = nodeIdx;
+
+        const auto childIdx = static_cast<int32_t>(nodes_.size());
+        nodes_.push_back(child);
+        nodes_[nodeIdx].children[octant] = childIdx;
+
+        build(childIdx, std::move(childIdxs[octant]), depth + 1);
+    }
+}
+
+void PointCloudLOD::decimate(
+    Node& node, const std::vector<uint32_t>& idxs) const
+{
+    // Keep the first point falling into each cell of a regular grid:
+    const uint32_t G        = params_.decimationCellsPerSide;
+    const float    cellSize = 2 * node.halfSize / G;
+    const float    x0       = node.center.x - node.halfSize,
+                y0          = node.center.y - node.halfSize,
+                z0          = node.center.z - node.halfSize;
+
+    const auto& xs = pts_->getPointsBufferRef_x();
+    const auto& ys = pts_->getPointsBufferRef_y();
+    const auto& zs = pts_->getPointsBufferRef_z();
+
+    const auto lambdaCell = [&](float v, float v0)
+    {
+        const auto c = static_cast<int64_t>((v - v0) / cellSize);
+        return static_cast<uint32_t>(std::clamp<int64_t>(c, 0, G - 1));
+    };
+
+    std::unordered_set<uint32_t> occupied;
+    node.sample.clear();
+
+    for (const uint32_t i : idxs)
+    {
+        const uint32_t key =
+            lambdaCell(xs[i], x0) +
+            G * (lambdaCell(ys[i], y0) + G * lambdaCell(zs[i], z0));
+
+        if (occupied.insert(key).second) node.sample.push_back(i);
+    }
+    node.spacing = cellSize;
+}
+
+void PointCloudLOD::setRenderParams(
+    const mp2p_icp::render_params_point_layer_t& rp)
+{
+    auto newColors = rp, oldColors = rp_;
+    newColors.pointSize = oldColors.pointSize = 1.0f;
+
+    if (newColors == oldColors)
+    {
+        // Only the point size may have changed:
+        if (rp.pointSize == rp_.pointSize) return;
+
+        rp_.pointSize = rp.pointSize;
+        for (const auto& node : nodes_)
+            if (node.gl) applyPointSize(node.gl, rp_.pointSize);
+        return;
+    }
+
+    rp_ = rp;
+    dropAllObjects();
+
+    if (!rp_.colorMode.has_value() ||
+        !rp_.colorMode->recolorizeByCoordinate.has_value())
+        return;
+
+    // Limits of the color map, as in metric_map_t::get_visualization():
+    const auto& cm = rp_.colorMode.value();
+
+    const unsigned int coordIdx =
+        static_cast<unsigned int>(cm.recolorizeByCoordinate.value());
+    ASSERT_(coordIdx < 3);
+
+    auto bb = pts_->boundingBox();
+
+    float min = bb.min[coordIdx], max = bb.max[coordIdx];
+
+    if (!cm.colorMapMinCoord.has_value() || !cm.colorMapMaxCoord.has_value())
+    {
+        if (cm.autoBoundingBoxOutliersPercentile.has_value())
+        {
+            // handle planar maps (avoids error in histogram below):
+            if (bb.max[coordIdx] == bb.min[coordIdx])
+                bb.max[coordIdx] = bb.min[coordIdx] + 0.1f;
+
+            constexpr size_t     nBins = 100;
+            mrpt::math::CHistogram hist(
+                bb.min[coordIdx], bb.max[coordIdx], nBins);
+
+            const auto& coords = coordIdx == 0   ? pts_->getPointsBufferRef_x()
+                                 : coordIdx == 1 ? pts_->getPointsBufferRef_y()
+                                                 : pts_->getPointsBufferRef_z();
+            for (const float v : coords) hist.add(v);
+
+            std::vector<double> binCoords, hits;
+            hist.getHistogramNormalized(binCoords, hits);
+            mrpt::math::confidenceIntervalsFromHistogram(
+                binCoords, hits, min, max,
+                *cm.autoBoundingBoxOutliersPercentile);
+        }
+    }
+
+    colorLimits_[0] = cm.colorMapMinCoord.value_or(min);
+    colorLimits_[1] = cm.colorMapMaxCoord.value_or(max);
+}
+
+mrpt::opengl::CRenderizable::Ptr PointCloudLOD::createNodeObject(
+    const Node& node) const
+{
+    const auto& xs = pts_->getPointsBufferRef_x();
+    const auto& ys = pts_->getPointsBufferRef_y();
+    const auto& zs = pts_->getPointsBufferRef_z();
+
+    if (!rp_.colorMode.has_value())
+    {
+        // uniform color point cloud:
+        auto glPts = mrpt::opengl::CPointCloud::Create();
+        for (const uint32_t i : node.sample)
+            glPts->insertPoint(xs[i], ys[i], zs[i]);
+
+        glPts->setPointSize(rp_.pointSize);
+        glPts->setColor_u8(rp_.color);
+        return glPts;
+    }
+
+    const auto& cm    = rp_.colorMode.value();
+    auto        glPts = mrpt::opengl::CPointCloudColoured::Create();
+
+    if (cm.keep_original_cloud_color)
+    {
+        for (const uint32_t i : node.sample)
+        {
+            float x, y, z, R, G, B;
+            pts_->getPointRGB(i, x, y, z, R, G, B);
+            glPts->push_back(x, y, z, R, G, B);
+        }
+    }
+    else
+    {
+        ASSERT_(cm.recolorizeByCoordinate.has_value());
+        for (const uint32_t i : node.sample)
+            glPts->push_back(xs[i], ys[i], zs[i], 1.0f, 1.0f, 1.0f);
+
+        glPts->recolorizeByCoordinate(
+            colorLimits_[0], colorLimits_[1],
+            static_cast<unsigned int>(cm.recolorizeByCoordinate.value()),
+            cm.colorMap);
+    }
+
+    glPts->setPointSize(rp_.pointSize);
+    return glPts;
+}
+
+PointCloudLOD::UpdateStats PointCloudLOD::update(const ViewParams& v)
+{
+    UpdateStats stats;
+    if (nodes_.empty()) return stats;
+
+    frame_++;
+
+    const double tanHalfFov = std::tan(0.5 * v.fovVertical);
+    const double pixelsPerRad =
+        v.viewportHeightPixels / std::max(2 * tanHalfFov, 1e-6);
+    // Half angle of the cone enclosing the frustum (through its corners):
+    const double frustumHalfAngle =
+        std::atan(tanHalfFov * std::sqrt(1.0 + mrpt::square(v.aspectRatio)));
+
+    // Returns the projected error of a node, or nothing if it is culled:
+    const auto lambdaEval = [&](int32_t nodeIdx) -> std::optional<double>
+    {
+        const Node&  n = nodes_[nodeIdx];
+        const double r = n.halfSize * std::sqrt(3.0);
+
+        const mrpt::math::TPoint3D c = v.cloudPose.composePoint(
+            mrpt::math::TPoint3D(n.center.x, n.center.y, n.center.z));
+        const mrpt::math::TVector3D d    = c - v.eye;
+        const double                dist = d.norm();
+
+        if (dist > r)
+        {
+            if (dist - r > v.clipFar) return {};
+
+            if (v.projective)
+            {
+                const double cosAng = std::clamp(
+                    (d.x * v.forward.x + d.y * v.forward.y +
+                     d.z * v.forward.z) /
+                        dist,
+                    -1.0, 1.0);
+                if (std::acos(cosAng) >
+                    frustumHalfAngle + std::asin(std::min(1.0, r / dist)))
+                    return {};
+            }
+        }
+
+        if (v.projective)
+            return n.spacing / std::max(dist - r, 1e-3) * pixelsPerRad;
+        else
+            return n.spacing * v.viewportHeightPixels /
+                   std::max(v.orthoZoomDistance, 1e-3);
+    };
+
+    // Refine nodes with the largest error first, while within the budgets:
+    struct Candidate
+    {
+        double  error   = 0;
+        int32_t nodeIdx = 0;
+
+        bool operator<(const Candidate& o) const { return error < o.error; }
+    };
+
+    std::priority_queue<Candidate> queue;
+    std::vector<int32_t>           selected;
+    std::size_t                    committedPoints = 0;
+
+    if (auto e = lambdaEval(0); e)
+    {
+        queue.push({*e, 0});
+        committedPoints += nodes_[0].sample.size();
+    }
+
+    while (!queue.empty())
+    {
+        const Candidate cand = queue.top();
+        queue.pop();
+
+        const Node& n = nodes_[cand.nodeIdx];
+
+        bool refine = !n.isLeaf && cand.error > v.errorBudgetPixels;
+        if (refine)
+        {
+            std::vector<Candidate> children;
+            std::size_t            childrenPoints = 0;
+            for (const int32_t c : n.children)
+            {
+                if (c < 0) continue;
+                if (auto e = lambdaEval(c); e)
+                {
+                    children.push_back({*e, c});
+                    childrenPoints += nodes_[c].sample.size();
+                }
+            }
+
+            const std::size_t newCommitted =
+                committedPoints - n.sample.size() + childrenPoints;
+
+            if (newCommitted > v.pointBudget) { refine = false; }
+            else
+            {
+                committedPoints = newCommitted;
+                for (const auto& c : children) queue.push(c);
+            }
+        }
+
+        if (!refine) selected.push_back(cand.nodeIdx);
+    }
+
+    // Upload new nodes. Those that do not fit in this update are replaced by
+    // their nearest uploaded ancestor:
+    std::size_t                 uploads = 0;
+    std::vector<int32_t>        drawn;
+    std::unordered_set<int32_t> fallbacks;
+    for (const int32_t idx : selected)
+    {
+        Node& n = nodes_[idx];
+        if (!n.gl && uploads < params_.maxUploadsPerUpdate)
+        {
+            n.gl = createNodeObject(n);
+            glRoot_->insert(n.gl);
+            cachedPoints_ += n.sample.size();
+            uploads++;
+        }
+
+        if (n.gl)
+        {
+            drawn.push_back(idx);
+            continue;
+        }
+
+        stats.pendingNodes++;
+
+        int32_t a = n.parent;
+        while (a >= 0 && !nodes_[a].gl) a = nodes_[a].parent;
+        if (a >= 0) fallbacks.insert(a);
+    }
+    drawn.insert(drawn.end(), fallbacks.begin(), fallbacks.end());
+
+    // An ancestor drawn instead of pending nodes covers its whole octant, so
+    // none of its descendants is drawn until all of them are uploaded:
+    const auto lambdaHasFallbackAncestor = [&](int32_t idx)
+    {
+        for (int32_t a = nodes_[idx].parent; a >= 0; a = nodes_[a].parent)
+            if (fallbacks.count(a) != 0) return true;
+        return false;
+    };
+
+    for (const int32_t idx : drawn)
+    {
+        if (lambdaHasFallbackAncestor(idx)) continue;
+
+        Node& n    = nodes_[idx];
+        n.lastUsed = frame_;
+        stats.visibleNodes++;
+        stats.renderedPoints += n.sample.size();
+    }
+
+    // Show/hide:
+    for (auto& n : nodes_)
+        if (n.gl) n.gl->setVisibility(n.lastUsed == frame_);
+
+    evictObjects(static_cast<std::size_t>(
+        params_.cacheSizeFactor * static_cast<double>(v.pointBudget)));
+
+    stats.cachedPoints = cachedPoints_;
+    return stats;
+}
+
+void PointCloudLOD::dropAllObjects()
+{
+    glRoot_->clear();
+    for (auto& n : nodes_) n.gl.reset();
+    cachedPoints_ = 0;
+}
+
+void PointCloudLOD::evictObjects(std::size_t maxCachedPoints)
+{
+    if (cachedPoints_ <= maxCachedPoints) return;
+
+    // Hidden nodes, least recently used first:
+    std::vector<Node*> hidden;
+    for (auto& n : nodes_)
+        if (n.gl && n.lastUsed != frame_) hidden.push_back(&n);
+
+    std::sort(
+        hidden.begin(), hidden.end(),
+        [](const Node* a, const Node* b) { return a->lastUsed < b->lastUsed; });
+
+    for (Node* n : hidden)
+    {
+        if (cachedPoints_ <= maxCachedPoints) break;
+
+        glRoot_->removeObject(n->gl);
+        n->gl.reset();
+        cachedPoints_ -= n->sample.size();
+    }
+}
@@ -0,0 +1,160 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   mm-viewer/PointCloudLOD.h
+ * @brief  Octree level-of-detail rendering of large point clouds
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+#pragma once
+
+#include <mp2p_icp/render_params.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/TPoint3D.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/** An octree built once for a (large) point cloud, where each node keeps a
+ * spatially decimated subset of the points below it, and leaves keep all
+ * their points.
+ *
+ * OpenGL objects are only created (and uploaded to the GPU) for the nodes
+ * selected by update() for the current view: those within the view frustum,
+ * refined until their projected point spacing is below a screen-space error
+ * budget, or a maximum number of rendered points is reached. Objects of nodes
+ * that are no longer visible are kept in a cache, and evicted in least
+ * recently used order. While selected nodes are waiting to be uploaded, their
+ * nearest already uploaded ancestor is drawn instead, so refining the view
+ * never leaves holes.
+ *
+ * Changing the point size does not rebuild any OpenGL object. Changing the
+ * color options drops the cached objects, but not the octree.
+ */
+class PointCloudLOD
+{
+   public:
+    struct Parameters
+    {
+        /** Maximum points in leaves, and in the decimated subset of inner
+         * nodes */
+        std::size_t maxPointsPerNode = 32768;
+
+        /** Inner nodes are decimated keeping one point per cell of a grid of
+         * this number of cells per side. Its cube must not be larger than
+         * maxPointsPerNode, so the decimated subset always covers the whole
+         * node. */
+        uint32_t decimationCellsPerSide = 32;
+
+        std::size_t maxDepth = 16;
+
+        /** Maximum number of nodes to upload to the GPU on each update() */
+        std::size_t maxUploadsPerUpdate = 64;
+
+        /** Maximum number of points in the cache of OpenGL objects, in
+         * multiples of the point budget of update(). */
+        double cacheSizeFactor = 2.0;
+    };
+
+    PointCloudLOD(
+        const mrpt::maps::CPointsMap::Ptr& pts, const Parameters& p);
+
+    /** Defines the colors and point size of all nodes. Only color changes
+     * drop the cached OpenGL objects. */
+    void setRenderParams(const mp2p_icp::render_params_point_layer_t& rp);
+
+    struct ViewParams
+    {
+        /** Camera position and unit viewing direction, in world coordinates
+         */
+        mrpt::math::TPoint3D  eye;
+        mrpt::math::TVector3D forward;
+
+        bool   projective = true;
+        double fovVertical = 1.0;  //!< [rad]
+        double aspectRatio = 1.0;  //!< width / height
+        double viewportHeightPixels = 800;
+        double orthoZoomDistance    = 10.0;  //!< Only for non-projective
+        double clipFar              = 1e4;
+
+        /** Pose of the cloud (of glObject()) in world coordinates */
+        mrpt::poses::CPose3D cloudPose;
+
+        /** Maximum projected point spacing [pixels] */
+        double errorBudgetPixels = 2.0;
+
+        /** Maximum number of rendered points */
+        std::size_t pointBudget = 10'000'000;
+    };
+
+    struct UpdateStats
+    {
+        std::size_t visibleNodes   = 0;
+        std::size_t renderedPoints = 0;
+        std::size_t cachedPoints   = 0;
+
+        /** Selected nodes not uploaded yet, due to maxUploadsPerUpdate, and
+         * temporarily replaced by an ancestor. If >0, update() should be
+         * called again. */
+        std::size_t pendingNodes = 0;
+    };
+
+    /** Selects the nodes to render for the given view, uploads the new ones
+     * and shows/hides all cached objects accordingly. */
+    UpdateStats update(const ViewParams& v);
+
+    /** The container of all node objects, to be inserted in the scene */
+    const mrpt::opengl::CSetOfObjects::Ptr& glObject() const { return glRoot_; }
+
+    std::size_t nodeCount() const { return nodes_.size(); }
+
+   private:
+    struct Node
+    {
+        mrpt::math::TPoint3Df center;
+        float                 halfSize = 0;
+
+        /** Point spacing of `sample` [meters] (0 for leaves) */
+        float spacing = 0;
+
+        /** Indices of the points rendered for this node */
+        std::vector<uint32_t> sample;
+
+        /** Indices in nodes_, or -1 if none */
+        std::array<int32_t, 8> children{-1, -1, -1, -1, -1, -1, -1, -1};
+        int32_t                parent = -1;
+
+        bool isLeaf = true;
+
+        mrpt::opengl::CRenderizable::Ptr gl;
+        uint64_t                         lastUsed = 0;
+    };
+
+    Parameters                       params_;
+    mrpt::maps::CPointsMap::Ptr      pts_;
+    std::vector<Node>                nodes_;
+    mrpt::opengl::CSetOfObjects::Ptr glRoot_;
+
+    mp2p_icp::render_params_point_layer_t rp_;
+    std::array<float, 2>                  colorLimits_ = {0, 1};
+    uint64_t                              frame_        = 0;
+    std::size_t                           cachedPoints_ = 0;
+
+    void build(
+        int32_t nodeIdx, std::vector<uint32_t>&& idxs, std::size_t depth);
+
+    void decimate(Node& node, const std::vector<uint32_t>& idxs) const;
+
+    mrpt::opengl::CRenderizable::Ptr createNodeObject(const Node& node) const;
+
+    void dropAllObjects();
+    void evictObjects(std::size_t maxCachedPoints);
+};
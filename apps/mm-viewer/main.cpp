@@ -27,6 +27,8 @@
 #include <mrpt/opengl/CArrow.h>
 #include <mrpt/opengl/CGridPlaneXY.h>
 #include <mrpt/opengl/COpenGLScene.h>
+#include <mrpt/opengl/CPointCloud.h>
+#include <mrpt/opengl/CPointCloudColoured.h>
 #include <mrpt/opengl/stock_objects.h>
 #include <mrpt/poses/CPose3DInterpolator.h>
 #include <mrpt/system/filesystem.h>
@@ -36,6 +38,7 @@
 #include <iostream>
 
 #include "../libcfgpath/cfgpath.h"
+#include "PointCloudLOD.h"
 
 constexpr const char* APP_NAME        = "mm-viewer";
 constexpr int         MID_FONT_SIZE   = 14;
@@ -58,6 +61,25 @@ static TCLAP::ValueArg<std::string> arg_tumTrajectory(
     "Also draw a trajectory, given by a TUM file trajectory.", false,
     "trajectory.tum", "trajectory.tum", cmd);
 
+static TCLAP::ValueArg<size_t> arg_lod_min_points(
+    "", "lod-min-points",
+    "Point layers with at least this number of points are rendered using an "
+    "octree with levels of detail, uploading to the GPU only the visible "
+    "nodes (Default: 2000000)",
+    false, 2'000'000, "2000000", cmd);
+
+static TCLAP::ValueArg<double> arg_lod_error(
+    "", "lod-error",
+    "Maximum screen-space error (point spacing) of level-of-detail point "
+    "layers, in pixels (Default: 2.0)",
+    false, 2.0, "2.0", cmd);
+
+static TCLAP::ValueArg<size_t> arg_lod_point_budget(
+    "", "lod-point-budget",
+    "Maximum number of points rendered at once for each level-of-detail point "
+    "layer (Default: 10000000)",
+    false, 10'000'000, "10000000", cmd);
+
 // =========== Declare global variables ===========
 #if MRPT_HAS_NANOGUI
 
@@ -88,6 +110,7 @@ nanogui::Label*                  lbCameraPointing          = nullptr;
 nanogui::Label *lbDepthFieldValues = nullptr, *lbDepthFieldMid = nullptr,
                *lbDepthFieldThickness = nullptr, *lbPointSize = nullptr;
 nanogui::Label*    lbTrajThick      = nullptr;
+nanogui::Label*    lbLODStats       = nullptr;
 nanogui::Widget*   panelLayers      = nullptr;
 nanogui::ComboBox* cbTravellingKeys = nullptr;
 nanogui::TextBox*  edAnimFPS        = nullptr;
@@ -102,6 +125,23 @@ bool                                      doFitView = false;
 mp2p_icp::metric_map_t theMap;
 std::string            theMapFileName = "unnamed.mm";
 
+// Cached opengl representation of each map layer, so only the layers whose
+// render options changed are rebuilt:
+struct LayerViz
+{
+    /** Render options used to build glObj (with a fixed point size, since it
+     *  is applied to existing objects without rebuilding them) */
+    std::optional<mp2p_icp::render_params_point_layer_t> geometryParams;
+
+    mrpt::opengl::CSetOfObjects::Ptr glObj;
+
+    /** Only for large point layers */
+    std::shared_ptr<PointCloudLOD> lod;
+};
+std::map<std::string, LayerViz>  layerViz;
+mrpt::opengl::CSetOfObjects::Ptr glPlanesLines;
+bool                             lodNeedsUpdate = true;
+
 // Robot path to display (optional):
 mrpt::poses::CPose3DInterpolator trajectory;
 
@@ -128,6 +168,11 @@ void loadMapFile(const std::string& mapFile)
     }
     theMapFileName = mapFile;
 
+    // Drop the opengl objects of the former map:
+    layerViz.clear();
+    glPlanesLines.reset();
+    glVizMap->clear();
+
     // Obtain layer info:
     std::cout << "Loaded map: " << theMap.contents_summary() << std::endl;
 
@@ -200,6 +245,187 @@ void updateMiniCornerView()
     view_cam.setZoomDistance(5);
 }
 
+void applyPointSize(const mrpt::opengl::CSetOfObjects& o, float pointSize)
+{
+    for (const auto& obj : o)
+    {
+        if (auto glPtsCol =
+                std::dynamic_pointer_cast<mrpt::opengl::CPointCloudColoured>(
+                    obj);
+            glPtsCol)
+        {
+            glPtsCol->setPointSize(pointSize);
+        }
+        else if (auto glPts =
+                     std::dynamic_pointer_cast<mrpt::opengl::CPointCloud>(obj);
+                 glPts)
+        {
+            glPts->setPointSize(pointSize);
+        }
+        else if (auto glSet =
+                     std::dynamic_pointer_cast<mrpt::opengl::CSetOfObjects>(
+                         obj);
+                 glSet)
+        {
+            applyPointSize(*glSet, pointSize);
+        }
+    }
+}
+
+// Rebuilds the opengl objects of one layer, if needed:
+void updateLayerViz(
+    const std::string& lyName, const mp2p_icp::render_params_point_layer_t& rp)
+{
+    const auto itL = theMap.layers.find(lyName);
+    if (itL == theMap.layers.end()) return;
+
+    auto& lv = layerViz[lyName];
+    if (!lv.glObj)
+    {
+        lv.glObj = mrpt::opengl::CSetOfObjects::Create();
+        glVizMap->insert(lv.glObj);
+    }
+    lv.glObj->setVisibility(true);
+
+    auto geomParams      = rp;
+    geomParams.pointSize = 1.0f;
+
+    if (lv.geometryParams == geomParams)
+    {
+        // Render-only changes:
+        if (lv.lod)
+            lv.lod->setRenderParams(rp);
+        else
+            applyPointSize(*lv.glObj, rp.pointSize);
+        return;
+    }
+    lv.geometryParams = geomParams;
+
+    auto pts = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(itL->second);
+    if (pts && pts->size() >= arg_lod_min_points.getValue())
+    {
+        if (!lv.lod)
+        {
+            std::cout << "Building level-of-detail octree for layer '"
+                      << lyName << "'..." << std::endl;
+
+            lv.lod = std::make_shared<PointCloudLOD>(
+                pts, PointCloudLOD::Parameters());
+            lv.glObj->clear();
+            lv.glObj->insert(lv.lod->glObject());
+
+            std::cout << "Done: " << lv.lod->nodeCount() << " nodes."
+                      << std::endl;
+        }
+        lv.lod->setRenderParams(rp);
+        lodNeedsUpdate = true;
+    }
+    else
+    {
+        lv.glObj->clear();
+        mp2p_icp::metric_map_t::get_visualization_map_layer(
+            *lv.glObj, rp, itL->second);
+    }
+}
+
+void getClipDistances(double& clipNear, double& clipFar)
+{
+    const auto depthFieldMid = std::pow(10.0, slMidDepthField->value());
+    const auto depthFieldThickness =
+        std::pow(10.0, slThicknessDepthField->value());
+
+    clipNear = std::max(1e-2, depthFieldMid - 0.5 * depthFieldThickness);
+    clipFar  = depthFieldMid + 0.5 * depthFieldThickness;
+}
+
+// Selects the visible nodes of level-of-detail layers for the current view:
+void updateLODs()
+{
+    using mrpt::DEG2RAD;
+
+    bool anyLOD = false;
+    for (const auto& [name, lv] : layerViz)
+        if (lv.lod && lv.glObj->isVisible()) anyLOD = true;
+
+    if (!anyLOD)
+    {
+        if (lbLODStats) lbLODStats->setCaption(" ");
+        return;
+    }
+
+    PointCloudLOD::ViewParams vp;
+
+    const auto&  cam = win->camera();
+    const double az  = DEG2RAD(cam.getAzimuthDegrees());
+    const double el  = DEG2RAD(cam.getElevationDegrees());
+    const double d   = cam.getZoomDistance();
+
+    const mrpt::math::TVector3D dir(
+        std::cos(el) * std::cos(az), std::cos(el) * std::sin(az), std::sin(el));
+    const mrpt::math::TPoint3D pointing(
+        cam.getCameraPointingX(), cam.getCameraPointingY(),
+        cam.getCameraPointingZ());
+
+    vp.eye                  = pointing + dir * d;
+    vp.forward              = dir * -1.0;
+    vp.projective           = !cbViewOrtho->checked() && !cbView2D->checked();
+    vp.fovVertical          = DEG2RAD(slCameraFOV->value());
+    vp.viewportHeightPixels = std::max(1, win->height());
+    vp.aspectRatio          = static_cast<double>(win->width()) /
+                     vp.viewportHeightPixels;
+    vp.orthoZoomDistance = d;
+    double clipNear;
+    getClipDistances(clipNear, vp.clipFar);
+
+    if (cbApplyGeoRef->checked() && theMap.georeferencing.has_value())
+        vp.cloudPose = theMap.georeferencing->T_enu_to_map.mean;
+
+    vp.errorBudgetPixels = arg_lod_error.getValue();
+    vp.pointBudget       = arg_lod_point_budget.getValue();
+
+    // Skip if the view did not change:
+    static std::optional<std::array<double, 12>> prevView;
+    const std::array<double, 12> view = {
+        vp.eye.x,
+        vp.eye.y,
+        vp.eye.z,
+        vp.forward.x,
+        vp.forward.y,
+        vp.forward.z,
+        vp.projective ? 1.0 : 0.0,
+        vp.fovVertical,
+        vp.viewportHeightPixels,
+        vp.aspectRatio,
+        vp.clipFar,
+        cbApplyGeoRef->checked() ? 1.0 : 0.0};
+
+    if (!lodNeedsUpdate && prevView == view) return;
+    prevView       = view;
+    lodNeedsUpdate = false;
+
+    PointCloudLOD::UpdateStats total;
+    for (const auto& [name, lv] : layerViz)
+    {
+        if (!lv.lod || !lv.glObj->isVisible()) continue;
+
+        const auto st = lv.lod->update(vp);
+        total.visibleNodes += st.visibleNodes;
+        total.renderedPoints += st.renderedPoints;
+        total.cachedPoints += st.cachedPoints;
+        total.pendingNodes += st.pendingNodes;
+    }
+
+    // Keep streaming nodes in the next iterations:
+    if (total.pendingNodes > 0) lodNeedsUpdate = true;
+
+    lbLODStats->setCaption(mrpt::format(
+        "LOD: %s points in %zu nodes (%zu pending)",
+        mrpt::system::unitsFormat(
+            static_cast<double>(total.renderedPoints), 2, false)
+            .c_str(),
+        total.visibleNodes, total.pendingNodes));
+}
+
 void rebuildLayerCheckboxes()
 {
     ASSERT_(panelLayers);
@@ -526,6 +752,9 @@ void main_show_gui()
         cbKeepOriginalCloudColors->setCallback([&](bool)
                                                { rebuild_3d_view(); });
 
+        lbLODStats = tab2->add<nanogui::Label>(" ");
+        lbLODStats->setFontSize(SMALL_FONT_SIZE);
+
         tab2->add<nanogui::Label>(" ");
         {
             auto pn = tab2->add<nanogui::Widget>();
@@ -913,6 +1142,7 @@ void main_show_gui()
             observeViewOptions();
             updateMiniCornerView();
             processCameraTravelling();
+            updateLODs();
         });
 
     nanogui::mainloop(1000 /*idleLoopPeriod ms*/, 25 /* minRepaintPeriod ms */);
@@ -1002,25 +1232,35 @@ void rebuild_3d_view()
     for (auto& [layer, rp] : rpMap.points.perLayer)
         rp.color = mrpt::img::TColor(0xff, 0x00, 0x00, 0xff);
 
-    // Regenerate points opengl representation only if some parameter changed:
-    static std::optional<mp2p_icp::render_params_t> prevRenderParams;
-
-    if (!prevRenderParams.has_value() || prevRenderParams.value() != rpMap)
+    // Elements not depending on the render options:
+    if (glVizMap->empty())
     {
-        prevRenderParams = rpMap;
-        glVizMap->clear();
+        glPlanesLines = mrpt::opengl::CSetOfObjects::Create();
+        theMap.get_visualization_planes(*glPlanesLines, rpMap.planes);
+        theMap.get_visualization_lines(*glPlanesLines, rpMap.lines);
 
-        auto glPts = theMap.get_visualization(rpMap);
-
-        // Show all or selected layers:
-        rpMap.points.allLayers.color =
-            mrpt::img::TColor(0xff, 0x00, 0x00, 0xff);
-
-        glVizMap->insert(glPts);
+        glVizMap->insert(glPlanesLines);
         glVizMap->insert(glMapCorner);
         glVizMap->insert(glTrajectory);
     }
 
+    // Regenerate the opengl representation of each layer only if some
+    // parameter changed:
+    for (const auto& [lyName, cb] : cbLayersByName)
+    {
+        const auto itRp = rpMap.points.perLayer.find(lyName);
+        if (itRp == rpMap.points.perLayer.end())
+        {
+            // hidden:
+            if (auto itV = layerViz.find(lyName);
+                itV != layerViz.end() && itV->second.glObj)
+                itV->second.glObj->setVisibility(false);
+            continue;
+        }
+        updateLayerViz(lyName, itRp->second);
+    }
+    lodNeedsUpdate = true;
+
     if (cbApplyGeoRef->checked() && theMap.georeferencing.has_value())
     {
         glVizMap->setPose(theMap.georeferencing->T_enu_to_map.mean);
@@ -1115,9 +1355,8 @@ void rebuild_3d_view()
         const auto depthFieldThickness =
             std::pow(10.0, slThicknessDepthField->value());
 
-        const auto clipNear =
-            std::max(1e-2, depthFieldMid - 0.5 * depthFieldThickness);
-        const auto clipFar = depthFieldMid + 0.5 * depthFieldThickness;
+        double clipNear, clipFar;
+        getClipDistances(clipNear, clipFar);
 
         const float cameraFOV = slCameraFOV->value();
         win->camera().setCameraFOV(cameraFOV);
@@ -11,19 +11,29 @@
  * @date   Oct 21, 2024
  */
 
+#include <mp2p_icp/BlockGZOutputStream.h>
 #include <mp2p_icp_filters/FilterBase.h>
 #include <mp2p_icp_filters/Generator.h>
 #include <mrpt/3rdparty/tclap/CmdLine.h>
 #include <mrpt/containers/yaml.h>
+#include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/io/CMemoryStream.h>
 #include <mrpt/io/lazy_load_path.h>
 #include <mrpt/obs/CObservationPointCloud.h>
-#include <mrpt/obs/CRawlog.h>
 #include <mrpt/obs/CSensoryFrame.h>
 #include <mrpt/serialization/CArchive.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/progress.h>
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+
 // CLI flags:
 struct Cli
 {
@@ -69,6 +79,47 @@ struct Cli
         "<ExternalsDirectory>",
         cmd};
 
+    TCLAP::ValueArg<size_t> arg_threads{
+        "t",
+        "threads",
+        "Number of worker threads. Each one runs its own copy of the pipeline. "
+        "Output is identical for any number of threads only if all generators "
+        "and filters are stateless; use 1 for pipelines that depend on former "
+        "observations. Default: number of CPU cores.",
+        false,
+        0,
+        "4",
+        cmd};
+
+    TCLAP::ValueArg<size_t> arg_read_ahead{
+        "",
+        "read-ahead",
+        "Maximum number of observations read or being processed ahead of the "
+        "last one written to the output (Default: 64)",
+        false,
+        64,
+        "64",
+        cmd};
+
+    TCLAP::ValueArg<int> arg_compression_level{
+        "",
+        "compression-level",
+        "GZIP compression level for the output, 0 (none) to 9 (best). "
+        "(Default: 1)",
+        false,
+        1,
+        "1",
+        cmd};
+
+    TCLAP::SwitchArg arg_parallel_gzip{
+        "",
+        "parallel-gzip",
+        "Compress the output in blocks, each one as an independent gzip "
+        "member, in a pool of threads. The output is still a valid .rawlog "
+        "file, slightly larger, but compression is no longer a serial "
+        "bottleneck.",
+        cmd};
+
     TCLAP::ValueArg<std::string> arg_verbosity_level{
         "v",
         "verbosity",
@@ -79,83 +130,67 @@ struct Cli
         cmd};
 };
 
-void run_mm_filter(Cli& cli)
+namespace
 {
-    using namespace std::string_literals;
-
-    ASSERT_FILE_EXISTS_(cli.argInput.getValue());
-    ASSERT_FILE_EXISTS_(cli.argPipeline.getValue());
-
-    const auto& filInput = cli.argInput.getValue();
-
-    std::cout << "[rawlog-filter] Reading input rawlog from: '" << filInput
-              << "'..." << std::endl;
-
-    mrpt::obs::CRawlog dataset;
-
-    bool readOk = dataset.loadFromRawLogFile(filInput);
-    ASSERT_(readOk);
-
-    std::cout << "[rawlog-filter] Done read dataset (" << dataset.size()
-              << " entries)" << std::endl;
-
-    // Load pipeline:
-    mrpt::system::VerbosityLevel logLevel = mrpt::system::LVL_INFO;
-    if (cli.arg_verbosity_level.isSet())
-    {
-        using vl = mrpt::typemeta::TEnumType<mrpt::system::VerbosityLevel>;
-        logLevel = vl::name2value(cli.arg_verbosity_level.getValue());
-    }
+// One copy of the pipeline for each worker thread:
+struct Pipeline
+{
+    mp2p_icp_filters::GeneratorSet   generators;
+    mp2p_icp_filters::FilterPipeline filters;
+    mp2p_icp::ParameterSource        ps;
+};
 
-    const auto yamlData =
-        mrpt::containers::yaml::FromFile(cli.argPipeline.getValue());
+std::unique_ptr<Pipeline> build_pipeline(
+    const mrpt::containers::yaml& yamlData, mrpt::system::VerbosityLevel logLevel,
+    bool verbose)
+{
+    auto p = std::make_unique<Pipeline>();
 
     // Generators:
-    mp2p_icp_filters::GeneratorSet generators;
     if (yamlData.has("generators"))
     {
-        generators = mp2p_icp_filters::generators_from_yaml(
+        p->generators = mp2p_icp_filters::generators_from_yaml(
             yamlData["generators"], logLevel);
     }
     else
     {
-        std::cout << "[rawlog-filter] Warning: no generators defined in the "
-                     "pipeline, using default generator."
-                  << std::endl;
+        if (verbose)
+            std::cout << "[rawlog-filter] Warning: no generators defined in "
+                         "the pipeline, using default generator."
+                      << std::endl;
 
         auto defaultGen = mp2p_icp_filters::Generator::Create();
         defaultGen->setMinLoggingLevel(logLevel);
         defaultGen->initialize({});
-        generators.push_back(defaultGen);
+        p->generators.push_back(defaultGen);
     }
 
     // Filters:
-    mp2p_icp_filters::FilterPipeline filters;
     if (yamlData.has("filters"))
     {
-        filters = mp2p_icp_filters::filter_pipeline_from_yaml(
+        p->filters = mp2p_icp_filters::filter_pipeline_from_yaml(
             yamlData["filters"], logLevel);
     }
-    else
+    else if (verbose)
     {
-        std::cout << "[sm2mm] Warning: no filters defined in the pipeline."
+        std::cout << "[rawlog-filter] Warning: no filters defined in the "
+                     "pipeline."
                   << std::endl;
     }
 
     // Parameters for twist, and possibly other user-provided variables.
-    mp2p_icp::ParameterSource ps;
-    mp2p_icp::AttachToParameterSource(generators, ps);
-    mp2p_icp::AttachToParameterSource(filters, ps);
+    mp2p_icp::AttachToParameterSource(p->generators, p->ps);
+    mp2p_icp::AttachToParameterSource(p->filters, p->ps);
 
     // Default values for twist variables:
-    ps.updateVariables(
+    p->ps.updateVariables(
         {{"vx", .0},
          {"vy", .0},
          {"vz", .0},
          {"wx", .0},
          {"wy", .0},
          {"wz", .0}});
-    ps.updateVariables(
+    p->ps.updateVariables(
         {{"robot_x", .0},
          {"robot_y", .0},
          {"robot_z", .0},
@@ -163,91 +198,400 @@ void run_mm_filter(Cli& cli)
          {"robot_pitch", .0},
          {"robot_roll", .0}});
 
-    // ps.updateVariables(options.customVariables);
+    p->ps.realize();
 
-    ps.realize();
+    return p;
+}
 
-    // progress bar:
-    std::cout << "\n";  // Needed for the VT100 codes below.
+// Calls a function when going out of scope, also during stack unwinding:
+template <typename F>
+class ScopeExit
+{
+   public:
+    explicit ScopeExit(F f) : f_(std::move(f)) {}
+    ~ScopeExit() { f_(); }
 
-    const double tStart = mrpt::Clock::nowDouble();
+    ScopeExit(const ScopeExit&)            = delete;
+    ScopeExit& operator=(const ScopeExit&) = delete;
+
+   private:
+    F f_;
+};
+
+// Runs the pipeline on one observation and returns the serialized output
+// entry, or an empty buffer if no generator handled the observation.
+std::vector<uint8_t> process_observation(
+    Pipeline& p, const mrpt::obs::CObservation::Ptr& obs)
+{
+    using namespace std::string_literals;
+
+    obs->load();
+
+    mp2p_icp::metric_map_t mm;
+
+    bool handled = mp2p_icp_filters::apply_generators(p.generators, *obs, mm);
+
+    if (!handled) return {};
+
+    // process it:
+    mp2p_icp_filters::apply_filter_pipeline(p.filters, mm);
+    obs->unload();
+
+    // Create output:
+    mrpt::obs::CSensoryFrame sf;
+    // Input:
+    sf.insert(obs);
+    // Output:
+    for (const auto& [name, layer] : mm.layers)
+    {
+        if (!layer) continue;
+        if (auto ptsMap =
+                std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(layer);
+            ptsMap)
+        {
+            auto obsPts         = mrpt::obs::CObservationPointCloud::Create();
+            obsPts->timestamp   = obs->timestamp;
+            obsPts->sensorLabel = "out_"s + name;
+            obsPts->pointcloud  = ptsMap;
+            sf.insert(obsPts);
+        }
+    }
+
+    // Serialize here, in the worker thread. The bytes are exactly those that
+    // would be written by "archive << sf" on the output stream.
+    mrpt::io::CMemoryStream buf;
+    auto                    arch = mrpt::serialization::archiveFrom(buf);
+    arch << sf;
+
+    const auto* data = reinterpret_cast<const uint8_t*>(buf.getRawBufferData());
+    return std::vector<uint8_t>(data, data + buf.getTotalBytesCount());
+}
+
+}  // namespace
+
+/* Three-stage pipeline:
+ *  - a reader thread, reading observations ahead (up to `read-ahead`),
+ *  - N workers, each one with its own copy of the generators & filters,
+ *  - this (main) thread, writing outputs in the original order.
+ *
+ * Since outputs are always written in order, the output file is byte-identical
+ * for any number of threads, as long as the pipeline is stateless, that is,
+ * the output for each observation only depends on that observation. Each
+ * worker only sees a subset of the observations, so pipelines with state kept
+ * across observations must be run with one single thread.
+ */
+void run_mm_filter(Cli& cli)
+{
+    using namespace std::string_literals;
+
+    ASSERT_FILE_EXISTS_(cli.argInput.getValue());
+    ASSERT_FILE_EXISTS_(cli.argPipeline.getValue());
+
+    const auto& filInput = cli.argInput.getValue();
+
+    // Load pipeline:
+    mrpt::system::VerbosityLevel logLevel = mrpt::system::LVL_INFO;
+    if (cli.arg_verbosity_level.isSet())
+    {
+        using vl = mrpt::typemeta::TEnumType<mrpt::system::VerbosityLevel>;
+        logLevel = vl::name2value(cli.arg_verbosity_level.getValue());
+    }
 
-    size_t nKFs = dataset.size();
-    if (cli.arg_to.isSet()) mrpt::keep_min(nKFs, cli.arg_to.getValue() + 1);
+    const auto yamlData =
+        mrpt::containers::yaml::FromFile(cli.argPipeline.getValue());
 
-    size_t curKF = 0;
-    if (cli.arg_from.isSet()) mrpt::keep_max(curKF, cli.arg_from.getValue());
+    size_t nThreads = cli.arg_threads.getValue();
+    if (nThreads == 0)
+        nThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    const size_t readAhead = std::max<size_t>(1, cli.arg_read_ahead.getValue());
+    const bool   parallelGz       = cli.arg_parallel_gzip.isSet();
+    const int    compressionLevel = cli.arg_compression_level.getValue();
+    ASSERT_GE_(compressionLevel, 0);
+    ASSERT_LE_(compressionLevel, 9);
+
+    std::vector<std::unique_ptr<Pipeline>> pipelines;
+    for (size_t i = 0; i < nThreads; i++)
+        pipelines.emplace_back(build_pipeline(yamlData, logLevel, i == 0));
+
+    std::cout << "[rawlog-filter] Using " << nThreads << " worker threads."
+              << std::endl;
+
+    if (cli.arg_lazy_load_base_dir.isSet())
+        mrpt::io::setLazyLoadPathBase(cli.arg_lazy_load_base_dir.getValue());
+
+    // Input rawlog file:
+    std::cout << "[rawlog-filter] Reading input rawlog from: '" << filInput
+              << "'..." << std::endl;
+
+    mrpt::io::CFileGZInputStream fi(filInput);
 
     // Create output Rawlog file:
     const auto filOut = cli.argOutput.getValue();
     std::cout << "[rawlog-filter] Creating output rawlog file: '" << filOut
               << "'..." << std::endl;
 
-    mrpt::io::CFileGZOutputStream fo(filOut);
-    auto outArch = mrpt::serialization::archiveFrom(fo);
+    // Either compress on the fly (serial) or by blocks, in parallel:
+    std::optional<mrpt::io::CFileGZOutputStream> foGz;
+    std::optional<mp2p_icp::BlockGZOutputStream>   foBlockGz;
+    if (parallelGz)
+    {
+        mp2p_icp::BlockGZOutputStream::Parameters gzParams;
+        gzParams.compressionLevel = compressionLevel;
 
-    if (cli.arg_lazy_load_base_dir.isSet())
-        mrpt::io::setLazyLoadPathBase(cli.arg_lazy_load_base_dir.getValue());
+        foBlockGz.emplace();
+        if (!foBlockGz->open(filOut, gzParams))
+            THROW_EXCEPTION_FMT("Error creating file: '%s'", filOut.c_str());
+    }
+    else
+    {
+        foGz.emplace();
+        if (!foGz->open(filOut, compressionLevel))
+            THROW_EXCEPTION_FMT("Error creating file: '%s'", filOut.c_str());
+    }
 
-    for (; curKF < nKFs; curKF++)
+    // Shared state between stages:
+    // ---------------------------------------
+    struct Job
     {
-        auto obs = dataset.getAsObservation(curKF);
-        ASSERTMSG_(
-            obs, "Dataset is expected to have CObservation objects only!");
+        size_t                      seq = 0;
+        mrpt::obs::CObservation::Ptr obs;
+    };
 
-        obs->load();
+    std::mutex              mtx;
+    std::condition_variable cvJobs, cvResults, cvSpace;
 
-        mp2p_icp::metric_map_t mm;
+    std::deque<Job>                         jobs;
+    std::map<size_t, std::vector<uint8_t>>  results;
+    size_t                                  nextToWrite = 0;
+    std::optional<size_t>                   totalJobs;  // set by the reader
+    bool                                    aborted = false;
+    std::exception_ptr                      firstError;
 
-        bool handled = mp2p_icp_filters::apply_generators(generators, *obs, mm);
+    const auto lambdaSetError = [&](std::exception_ptr e)
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        if (!firstError) firstError = e;
+        aborted = true;
+        cvJobs.notify_all();
+        cvResults.notify_all();
+        cvSpace.notify_all();
+    };
+
+    std::thread              reader;
+    std::vector<std::thread> workers;
+
+    // Stops and joins all threads. Always called before leaving this function,
+    // even if an exception is thrown in this thread:
+    const auto lambdaStopAndJoin = [&]()
+    {
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            aborted = true;
+            cvJobs.notify_all();
+            cvResults.notify_all();
+            cvSpace.notify_all();
+        }
+        if (reader.joinable()) reader.join();
+        for (auto& w : workers)
+            if (w.joinable()) w.join();
+    };
+    const ScopeExit joinAllOnExit(lambdaStopAndJoin);
+
+    // Stage 1: reader
+    // ---------------------------------------
+    reader = std::thread(
+        [&]()
+        {
+            try
+            {
+                auto inArch = mrpt::serialization::archiveFrom(fi);
+
+                const size_t first =
+                    cli.arg_from.isSet() ? cli.arg_from.getValue() : 0;
+
+                size_t seq = 0;
+                for (size_t rawlogIdx = 0;; rawlogIdx++)
+                {
+                    if (cli.arg_to.isSet() && rawlogIdx > cli.arg_to.getValue())
+                        break;
+
+                    mrpt::serialization::CSerializable::Ptr o;
+                    try
+                    {
+                        o = inArch.ReadObject();
+                    }
+                    catch (const mrpt::serialization::CExceptionEOF&)
+                    {
+                        break;
+                    }
+
+                    if (rawlogIdx < first) continue;
+
+                    auto obs =
+                        std::dynamic_pointer_cast<mrpt::obs::CObservation>(o);
+                    ASSERTMSG_(
+                        obs,
+                        "Dataset is expected to have CObservation objects "
+                        "only!");
+
+                    // Wait for room (bounded memory):
+                    std::unique_lock<std::mutex> lck(mtx);
+                    cvSpace.wait(
+                        lck, [&]()
+                        { return aborted || seq - nextToWrite < readAhead; });
+                    if (aborted) return;
+
+                    jobs.push_back({seq++, obs});
+                    cvJobs.notify_one();
+                }
+
+                std::lock_guard<std::mutex> lck(mtx);
+                totalJobs = seq;
+                cvJobs.notify_all();
+                cvResults.notify_all();
+            }
+            catch (...)
+            {
+                lambdaSetError(std::current_exception());
+            }
+        });
 
-        if (!handled) continue;
+    // Stage 2: workers
+    // ---------------------------------------
+    for (size_t t = 0; t < nThreads; t++)
+    {
+        workers.emplace_back(
+            [&, t]()
+            {
+                try
+                {
+                    for (;;)
+                    {
+                        Job job;
+                        {
+                            std::unique_lock<std::mutex> lck(mtx);
+                            cvJobs.wait(
+                                lck,
+                                [&]()
+                                {
+                                    return aborted || !jobs.empty() ||
+                                           totalJobs.has_value();
+                                });
+                            if (aborted || jobs.empty()) return;
+
+                            job = std::move(jobs.front());
+                            jobs.pop_front();
+                        }
+
+                        auto out = process_observation(*pipelines[t], job.obs);
+                        job.obs.reset();
+
+                        std::lock_guard<std::mutex> lck(mtx);
+                        results[job.seq] = std::move(out);
+                        cvResults.notify_all();
+                    }
+                }
+                catch (...)
+                {
+                    lambdaSetError(std::current_exception());
+                }
+            });
+    }
 
-        // process it:
-        mp2p_icp_filters::apply_filter_pipeline(filters, mm);
-        obs->unload();
+    // Stage 3: ordered writer (this thread)
+    // ---------------------------------------
+    const double tStart = mrpt::Clock::nowDouble();
 
-        // Create output:
-        mrpt::obs::CSensoryFrame sf;
-        // Input:
-        sf.insert(obs);
-        // Output:
-        for (const auto& [name, layer] : mm.layers)
+    // progress bar:
+    std::cout << "\n";  // Needed for the VT100 codes below.
+
+    std::optional<size_t> expectedTotal;
+    if (cli.arg_to.isSet())
+    {
+        const size_t first = cli.arg_from.isSet() ? cli.arg_from.getValue() : 0;
+        if (cli.arg_to.getValue() >= first)
+            expectedTotal = cli.arg_to.getValue() + 1 - first;
+    }
+
+    try
+    {
+        for (;;)
         {
-            if (!layer) continue;
-            if (auto ptsMap =
-                    std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(layer);
-                ptsMap)
+            std::vector<uint8_t> entry;
             {
-                auto obsPts       = mrpt::obs::CObservationPointCloud::Create();
-                obsPts->timestamp = obs->timestamp;
-                obsPts->sensorLabel = "out_"s + name;
-                obsPts->pointcloud  = ptsMap;
-                sf.insert(obsPts);
+                std::unique_lock<std::mutex> lck(mtx);
+                cvResults.wait(
+                    lck,
+                    [&]()
+                    {
+                        return aborted || results.count(nextToWrite) != 0 ||
+                               (totalJobs && nextToWrite >= *totalJobs);
+                    });
+                if (aborted) break;
+                if (results.count(nextToWrite) == 0) break;  // all done
+
+                entry = std::move(results[nextToWrite]);
+                results.erase(nextToWrite);
+                nextToWrite++;
+                cvSpace.notify_one();
             }
-        }
-        outArch << sf;  // save to disk
 
-        // progress bar:
-        {
-            const size_t N  = nKFs;
-            const double pc = (1.0 * curKF) / N;
-
-            const double tNow = mrpt::Clock::nowDouble();
-            const double ETA  = pc > 0 ? (tNow - tStart) * (1.0 / pc - 1) : .0;
-            const double totalTime = ETA + (tNow - tStart);
-
-            std::cout
-                << "\033[A\33[2KT\r"  // VT100 codes: cursor up and clear
-                                      // line
-                << mrpt::system::progress(pc, 30)
-                << mrpt::format(
-                       " %6zu/%6zu (%.02f%%) ETA=%s / T=%s\n", curKF, N,
-                       100 * pc, mrpt::system::formatTimeInterval(ETA).c_str(),
-                       mrpt::system::formatTimeInterval(totalTime).c_str());
-            std::cout.flush();
-        }
-    }  // end for each KF.
+            // save to disk (empty: observation not handled by generators)
+            if (!entry.empty())
+            {
+                if (foGz)
+                    foGz->Write(entry.data(), entry.size());
+                else
+                    foBlockGz->Write(entry.data(), entry.size());
+            }
+
+            // progress bar:
+            {
+                const double tNow    = mrpt::Clock::nowDouble();
+                const double elapsed = tNow - tStart;
+
+                // VT100 codes: cursor up and clear line
+                std::cout << "\033[A\33[2KT\r";
+
+                if (expectedTotal)
+                {
+                    const size_t N   = *expectedTotal;
+                    const double pc  = (1.0 * nextToWrite) / N;
+                    const double ETA = pc > 0 ? elapsed * (1.0 / pc - 1) : .0;
+                    const double totalTime = ETA + elapsed;
+
+                    std::cout
+                        << mrpt::system::progress(pc, 30)
+                        << mrpt::format(
+                               " %6zu/%6zu (%.02f%%) ETA=%s / T=%s\n",
+                               nextToWrite, N, 100 * pc,
+                               mrpt::system::formatTimeInterval(ETA).c_str(),
+                               mrpt::system::formatTimeInterval(totalTime)
+                                   .c_str());
+                }
+                else
+                {
+                    std::cout << mrpt::format(
+                        " %6zu entries (%.01f/s) T=%s\n", nextToWrite,
+                        elapsed > 0 ? nextToWrite / elapsed : .0,
+                        mrpt::system::formatTimeInterval(elapsed).c_str());
+                }
+                std::cout.flush();
+            }
+        }  // end for each entry.
+    }
+    catch (...)
+    {
+        lambdaSetError(std::current_exception());
+    }
+
+    lambdaStopAndJoin();
+
+    if (firstError) std::rethrow_exception(firstError);
+
+    // Flush the last blocks, with error reporting:
+    if (foBlockGz) foBlockGz->close();
 }
 
 int main(int argc, char** argv)
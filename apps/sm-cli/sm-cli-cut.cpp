@@ -25,25 +25,26 @@ int commandCut()
     // Take second unlabeled argument:
     const std::string file = lstCmds.at(1);
 
-    const mrpt::maps::CSimpleMap sm = read_input_sm_from_cli(file);
+    const auto reader = open_input_sm_from_cli(file);
 
     const auto idxFirst = cli->arg_from.getValue();
     const auto idxLast  = cli->arg_to.getValue();
 
-    ASSERT_LT_(idxFirst, sm.size());
-    ASSERT_LT_(idxLast, sm.size());
-
-    mrpt::maps::CSimpleMap outSM;
-
-    for (size_t i = idxFirst; i <= idxLast; i++)  //
-        outSM.insert(sm.get(i));
+    ASSERT_LT_(idxFirst, reader->size());
+    ASSERT_LT_(idxLast, reader->size());
 
     const auto outFil = cli->arg_output.getValue();
+    const auto writer = create_output_sm_from_cli(outFil);
+
+    // Keyframes after the last one are not even read:
+    mrpt::maps::CSimpleMap::Keyframe kf;
+    for (size_t i = 0; i <= idxLast && reader->next(kf); i++)
+        if (i >= idxFirst) writer->append(kf);
 
-    std::cout << "Writing cut simplemap with " << outSM.size()
+    std::cout << "Writing cut simplemap with " << writer->size()
               << " keyframes to '" << outFil << "'" << std::endl;
 
-    outSM.saveToFile(outFil);
+    writer->close();
 
     return 0;
 }
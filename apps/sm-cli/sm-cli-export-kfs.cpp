@@ -27,7 +27,7 @@ int commandExportKF()
     // Take second unlabeled argument:
     const std::string file = lstCmds.at(1);
 
-    const mrpt::maps::CSimpleMap sm = read_input_sm_from_cli(file);
+    const auto reader = open_input_sm_from_cli(file);
 
     const auto outFil      = cli->arg_output.getValue();
     const auto outTwistFil = cli->arg_output_twist.getValue();
@@ -42,8 +42,11 @@ int commandExportKF()
 
     size_t kfsWithoutTimestamp = 0;
 
-    for (const auto& [kf, sf, twist] : sm)
+    mrpt::maps::CSimpleMap::Keyframe keyframe;
+    while (reader->next(keyframe))
     {
+        const auto& [kf, sf, twist] = keyframe;
+
         const auto                             pose = kf->getMeanVal();
         std::optional<mrpt::Clock::time_point> tim;
 
@@ -7,12 +7,13 @@
   |   See COPYING                                                           |
   +-------------------------------------------------------------------------+ */
 
+#include <mp2p_icp/BlockGZOutputStream.h>
 #include <mrpt/core/exceptions.h>
 #include <mrpt/maps/CSimpleMap.h>
 #include <mrpt/obs/CObservationComment.h>
 #include <mrpt/obs/CObservationRobotPose.h>
-#include <mrpt/obs/CRawlog.h>
 #include <mrpt/poses/CPose3DInterpolator.h>
+#include <mrpt/serialization/CArchive.h>
 
 #include <sstream>
 
@@ -30,14 +31,24 @@ int commandExportRawlog()
     // Take second unlabeled argument:
     const std::string file = lstCmds.at(1);
 
-    const mrpt::maps::CSimpleMap sm = read_input_sm_from_cli(file);
+    const auto reader = open_input_sm_from_cli(file);
 
     const auto outFil = cli->arg_output.getValue();
 
-    mrpt::obs::CRawlog rawlog;
+    // Rawlog entries are written as they are generated:
+    mp2p_icp::BlockGZOutputStream::Parameters outParams;
+    outParams.threads          = cli->arg_threads.getValue();
+    outParams.compressionLevel = cli->arg_compression_level.getValue();
 
-    for (const auto& [kf, sf, twist] : sm)
+    mp2p_icp::BlockGZOutputStream f(outFil, outParams);
+    auto   rawlog        = mrpt::serialization::archiveFrom(f);
+    size_t rawlogEntries = 0;
+
+    mrpt::maps::CSimpleMap::Keyframe keyframe;
+    while (reader->next(keyframe))
     {
+        const auto& [kf, sf, twist] = keyframe;
+
         ASSERT_(kf);
         ASSERT_(sf);
 
@@ -80,13 +91,14 @@ int commandExportRawlog()
             outSF.insert(obsTwist);
         }
 
-        rawlog.insert(outSF);
+        rawlog << outSF;
+        rawlogEntries++;
     }
 
-    std::cout << "Saving rawlog with " << rawlog.size() << " entries to: '"
-              << outFil << "'" << std::endl;
+    f.close();
 
-    rawlog.saveToRawLogFile(outFil);
+    std::cout << "Saved rawlog with " << rawlogEntries << " entries to: '"
+              << outFil << "'" << std::endl;
 
     return 0;
 }
@@ -25,7 +25,8 @@ int commandInfo()
     // Take second unlabeled argument:
     const std::string file = lstCmds.at(1);
 
-    const mrpt::maps::CSimpleMap sm = read_input_sm_from_cli(file);
+    // Visit keyframes one by one, without loading the whole map:
+    const auto reader = open_input_sm_from_cli(file);
 
     // estimate path bounding box:
     auto bbox     = mrpt::math::TBoundingBox::PlusMinusInfinity();
@@ -35,8 +36,11 @@ int commandInfo()
     std::map<std::string, std::string> obsTypes;
     std::map<std::string, size_t>      obsCount;
 
-    for (const auto& [pose, sf, twist] : sm)
+    mrpt::maps::CSimpleMap::Keyframe kf;
+    while (reader->next(kf))
     {
+        const auto& [pose, sf, twist] = kf;
+
         if (twist.has_value()) hasTwist = true;
 
         const auto p = pose->getMeanVal().asTPose();
@@ -60,7 +64,7 @@ int commandInfo()
 
     std::cout << "\n";
     std::cout << "size_bytes:           " << sizeBytes << "\n";
-    std::cout << "keyframe_count:       " << sm.size() << "\n";
+    std::cout << "keyframe_count:       " << reader->size() << "\n";
     std::cout << "has_twist:            " << (hasTwist ? "true" : "false")
               << "\n";
     std::cout << "kf_bounding_box_min:  " << bbox.min.asString() << "\n";
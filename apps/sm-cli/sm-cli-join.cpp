@@ -21,27 +21,23 @@ int commandJoin()
     if (lstCmds.size() < 2 || !cli->arg_output.isSet())
         return printCommandsJoin(true);
 
-    // Take second unlabeled argument:
-    mrpt::maps::CSimpleMap outSM;
+    const auto outFil = cli->arg_output.getValue();
+    const auto writer = create_output_sm_from_cli(outFil);
 
+    // Take second and next unlabeled arguments, and copy their keyframes one
+    // by one:
     for (size_t i = 1; i < lstCmds.size(); i++)
     {
-        const std::string      file = lstCmds.at(i);
-        mrpt::maps::CSimpleMap sm   = read_input_sm_from_cli(file);
+        const auto reader = open_input_sm_from_cli(lstCmds.at(i));
 
-        for (size_t k = 0; k < sm.size(); k++)
-        {
-            const auto kf = sm.get(k);
-            outSM.insert(kf);
-        }
+        mrpt::maps::CSimpleMap::Keyframe kf;
+        while (reader->next(kf)) writer->append(kf);
     }
 
-    const auto outFil = cli->arg_output.getValue();
-
-    std::cout << "Writing merged simplemap with " << outSM.size()
+    std::cout << "Writing merged simplemap with " << writer->size()
               << " keyframes to '" << outFil << "'" << std::endl;
 
-    outSM.saveToFile(outFil);
+    writer->close();
 
     return 0;
 }
@@ -27,17 +27,16 @@ int commandLevel()
     const std::string inFile  = lstCmds.at(1);
     const std::string outFile = lstCmds.at(2);
 
-    mrpt::maps::CSimpleMap sm = read_input_sm_from_cli(inFile);
-
-    ASSERT_(!sm.empty());
+    // 1st pass: only keep all SF KeyFrame poses in memory
+    std::vector<mrpt::poses::CPose3D> poses;
+    {
+        const auto reader = open_input_sm_from_cli(inFile);
+        ASSERT_(reader->size() != 0);
 
-    std::vector<mrpt::poses::CPose3D> poses;  // all SF KeyFrame poses
-    poses.reserve(sm.size());
+        poses.reserve(reader->size());
 
-    for (const auto& [pose, sf, twist] : sm)
-    {
-        const auto p = pose->getMeanVal();
-        poses.push_back(p);
+        mrpt::maps::CSimpleMap::Keyframe kf;
+        while (reader->next(kf)) poses.push_back(kf.pose->getMeanVal());
     }
 
     // Optimize them such as the vertical variation is minimized:
@@ -91,17 +90,21 @@ int commandLevel()
         optimal_x[0], optimal_x[1], optimal_x[2]);
     std::cout << "Final optimized rotation: " << delta << std::endl;
 
-    // Modify KFs:
-    for (auto& [pose, sf, twist] : sm)
+    // 2nd pass: modify KFs, and save them as we go:
+    std::cout << "Saving result to: '" << outFile << "... " << std::endl;
+
+    const auto reader = open_input_sm_from_cli(inFile);
+    const auto writer = create_output_sm_from_cli(outFile);
+
+    mrpt::maps::CSimpleMap::Keyframe kf;
+    while (reader->next(kf))
     {
-        const auto p = pose->getMeanVal();
         // This changes both, the mean and the covariance:
-        pose->changeCoordinatesReference(delta);
+        kf.pose->changeCoordinatesReference(delta);
+        writer->append(kf);
     }
 
-    // save:
-    std::cout << "Saving result to: '" << outFile << "... " << std::endl;
-    sm.saveToFile(outFile);
+    writer->close();
 
     return 0;
 }
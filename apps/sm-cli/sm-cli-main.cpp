@@ -16,7 +16,7 @@
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/os.h>  // consoleColorAndStyle()
 
-// register, for read_input_sm_from_cli()
+// register, for open_input_sm_from_cli()
 #include <mrpt/maps/registerAllClasses.h>
 #include <mrpt/obs/registerAllClasses.h>
 
@@ -131,13 +131,14 @@ void printVersion()
 }
 
 // Common part of most commands:
-mrpt::maps::CSimpleMap read_input_sm_from_cli(const std::string& inFile)
+std::unique_ptr<mp2p_icp::SimpleMapReader> open_input_sm_from_cli(
+    const std::string& inFile)
 {
     ASSERT_FILE_EXISTS_(inFile);
 
     const auto sizeBytes = mrpt::system::getFileSize(inFile);
 
-    std::cout << "Loading: '" << inFile << "' of "
+    std::cout << "Reading: '" << inFile << "' of "
               << mrpt::system::unitsFormat(sizeBytes) << "B..." << std::endl;
 
     // register mrpt-obs classes, since we are not using them explicitly and
@@ -145,10 +146,15 @@ mrpt::maps::CSimpleMap read_input_sm_from_cli(const std::string& inFile)
     mrpt::maps::registerAllClasses_mrpt_maps();
     mrpt::obs::registerAllClasses_mrpt_obs();
 
-    mrpt::maps::CSimpleMap sm;
+    return std::make_unique<mp2p_icp::SimpleMapReader>(inFile);
+}
 
-    bool loadOk = sm.loadFromFile(inFile);
-    ASSERT_(loadOk);
+std::unique_ptr<mp2p_icp::SimpleMapWriter> create_output_sm_from_cli(
+    const std::string& outFile)
+{
+    mp2p_icp::BlockGZOutputStream::Parameters p;
+    p.threads          = cli->arg_threads.getValue();
+    p.compressionLevel = cli->arg_compression_level.getValue();
 
-    return sm;
+    return std::make_unique<mp2p_icp::SimpleMapWriter>(outFile, p);
 }
@@ -28,24 +28,26 @@ int commandTf()
     const std::string outFile = lstCmds.at(2);
     const std::string strTf   = lstCmds.at(3);
 
-    mrpt::maps::CSimpleMap sm = read_input_sm_from_cli(inFile);
+    const auto reader = open_input_sm_from_cli(inFile);
 
-    ASSERT_(!sm.empty());
+    ASSERT_(reader->size() != 0);
 
     const auto tf = mrpt::poses::CPose3D::FromString(strTf);
     std::cout << "tf to apply: " << tf << "\n";
 
-    // Modify KFs:
-    for (auto& [pose, sf, twist] : sm)
+    // Modify KFs, and save them as we go:
+    std::cout << "Saving result to: '" << outFile << "... " << std::endl;
+    const auto writer = create_output_sm_from_cli(outFile);
+
+    mrpt::maps::CSimpleMap::Keyframe kf;
+    while (reader->next(kf))
     {
-        const auto p = pose->getMeanVal();
         // This changes both, the mean and the covariance:
-        pose->changeCoordinatesReference(tf);
+        kf.pose->changeCoordinatesReference(tf);
+        writer->append(kf);
     }
 
-    // save:
-    std::cout << "Saving result to: '" << outFile << "... " << std::endl;
-    sm.saveToFile(outFile);
+    writer->close();
 
     return 0;
 }
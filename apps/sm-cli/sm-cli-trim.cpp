@@ -32,26 +32,26 @@ int commandTrim()
 
     const auto bbox = mrpt::math::TBoundingBox(cornerMin, cornerMax);
 
-    const mrpt::maps::CSimpleMap sm = read_input_sm_from_cli(file);
+    const auto reader = open_input_sm_from_cli(file);
 
-    mrpt::maps::CSimpleMap outSM;
+    const auto outFil = cli->arg_output.getValue();
+    const auto writer = create_output_sm_from_cli(outFil);
 
-    for (const auto& [posePDF, sf, twist] : sm)
+    mrpt::maps::CSimpleMap::Keyframe kf;
+    while (reader->next(kf))
     {
-        ASSERT_(posePDF);
-        const auto p = posePDF->getMeanVal();
+        ASSERT_(kf.pose);
+        const auto p = kf.pose->getMeanVal();
 
         if (!bbox.containsPoint(p.translation())) continue;
 
-        outSM.insert(posePDF, sf, twist);
+        writer->append(kf);
     }
 
-    const auto outFil = cli->arg_output.getValue();
-
-    std::cout << "Writing trimmed simplemap with " << outSM.size()
+    std::cout << "Writing trimmed simplemap with " << writer->size()
               << " keyframes to '" << outFil << "'" << std::endl;
 
-    outSM.saveToFile(outFil);
+    writer->close();
 
     return 0;
 }
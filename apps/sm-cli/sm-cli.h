@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <mp2p_icp/SimpleMapStream.h>
 #include <mrpt/3rdparty/tclap/CmdLine.h>
 #include <mrpt/maps/CSimpleMap.h>
 
@@ -65,6 +66,26 @@ struct cli_flags
         "twist.txt",
         cmd};
 
+    TCLAP::ValueArg<size_t> arg_threads{
+        "",
+        "threads",
+        "Number of threads used to compress output files (Default: 0=all "
+        "cores)",
+        false,
+        0,
+        "0",
+        cmd};
+
+    TCLAP::ValueArg<int> arg_compression_level{
+        "",
+        "compression-level",
+        "GZIP compression level for output files, 0 (none) to 9 (best). "
+        "(Default: 1)",
+        false,
+        1,
+        "1",
+        cmd};
+
     TCLAP::SwitchArg argHelp{
         "h", "help", "Shows more detailed help for command", cmd};
 
@@ -87,7 +108,14 @@ int  commandTf();  // "tf"
 int  commandExportKF();  // "export-keyframes"
 int  commandExportRawlog();  // "export-rawlog"
 
-mrpt::maps::CSimpleMap read_input_sm_from_cli(const std::string& fil);
+/** Opens a simplemap for reading its keyframes one by one */
+std::unique_ptr<mp2p_icp::SimpleMapReader> open_input_sm_from_cli(
+    const std::string& fil);
+
+/** Creates a simplemap, to be written keyframe by keyframe and compressed in
+ *  parallel threads. */
+std::unique_ptr<mp2p_icp::SimpleMapWriter> create_output_sm_from_cli(
+    const std::string& fil);
 
 void setConsoleErrorColor();
 void setConsoleNormalColor();
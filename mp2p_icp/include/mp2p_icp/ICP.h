@@ -227,6 +227,8 @@ class ICP : public mrpt::system::COutputLogger, public mrpt::rtti::CObject
         iteration_hook_ = ih;
     }
 
+    const iteration_hook_t& getIterationHook() const { return iteration_hook_; }
+
     const mrpt::system::CTimeLogger& profiler() const { return profiler_; }
     mrpt::system::CTimeLogger&       profiler() { return profiler_; }
 
@@ -245,7 +247,9 @@ class ICP : public mrpt::system::COutputLogger, public mrpt::rtti::CObject
     struct ICP_State
     {
         ICP_State(const metric_map_t& pcsGlobal, const metric_map_t& pcsLocal)
-            : pcGlobal(pcsGlobal), pcLocal(pcsLocal)
+            : pcGlobal(pcsGlobal),
+              pcLocal(pcsLocal),
+              matchState(pcsGlobal, pcsLocal)
         {
         }
 
@@ -255,6 +259,10 @@ class ICP : public mrpt::system::COutputLogger, public mrpt::rtti::CObject
         OptimalTF_Result    currentSolution;
         uint32_t            currentIteration = 0;
         LogRecord*          log              = nullptr;
+
+        /** Reused across iterations, to avoid reallocating the bit fields
+         * of both maps on each one. */
+        MatchState matchState;
     };
 
    private:
@@ -0,0 +1,149 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ICP_BatchRunner.h
+ * @brief  Runs many independent ICP alignments in parallel
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+#pragma once
+
+#include <mp2p_icp/ICP.h>
+#include <mp2p_icp/Parameters.h>
+#include <mp2p_icp/Results.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/math/TPose3D.h>
+#include <mrpt/poses/CPose3DPDFGaussianInf.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace mp2p_icp
+{
+/** Runs a list of independent ICP::align() jobs (e.g. loop closure candidates)
+ * in parallel, using a pool of ICP pipelines created once from the same YAML
+ * configuration.
+ *
+ * Each worker thread owns one complete ICP pipeline (matchers, solvers,
+ * quality evaluators and their ParameterSource), so no mutable state is ever
+ * shared between threads. Jobs are handed to idle workers dynamically, so
+ * slow and fast alignments are balanced across threads.
+ *
+ * Global (and local) maps are shared, read-only, among all jobs referencing
+ * them. Before starting a batch, the NN structures (e.g. KD-trees) of all
+ * distinct maps are built once from the calling thread, so concurrent queries
+ * from the workers never trigger a rebuild.
+ *
+ * Usage:
+ * \code
+ * mp2p_icp::ICP_BatchRunner runner(yamlIcpPipeline);
+ *
+ * std::vector<mp2p_icp::ICP_BatchRunner::Job> jobs;
+ * jobs.push_back({localMap, submap1, initialGuess1});
+ * // ...
+ * // Stop as soon as any candidate reaches quality>=0.75:
+ * const auto results = runner.run(jobs, 0.75);
+ * \endcode
+ *
+ * \note Matchers with a custom `kdtree_leaf_max_points` use their own KD-tree,
+ * built once on first use by metric_map_t::layer_for_nn_queries().
+ *
+ * \ingroup mp2p_icp_grp
+ */
+class ICP_BatchRunner
+{
+   public:
+    /** Creates the pool of ICP pipelines.
+     * \param icpPipelineConfig YAML configuration, as expected by
+     *        mp2p_icp::icp_pipeline_from_yaml()
+     * \param numThreads Number of worker threads (and ICP pipeline
+     *        instances). 0 means std::thread::hardware_concurrency().
+     */
+    explicit ICP_BatchRunner(
+        const mrpt::containers::yaml& icpPipelineConfig,
+        std::size_t                   numThreads = 0);
+
+    ~ICP_BatchRunner();
+
+    /** One independent ICP::align() invocation */
+    struct Job
+    {
+        Job() = default;
+        Job(metric_map_t::ConstPtr local, metric_map_t::ConstPtr global,
+            const mrpt::math::TPose3D& guess)
+            : pcLocal(std::move(local)),
+              pcGlobal(std::move(global)),
+              initialGuessLocalWrtGlobal(guess)
+        {
+        }
+
+        metric_map_t::ConstPtr pcLocal, pcGlobal;
+        mrpt::math::TPose3D    initialGuessLocalWrtGlobal;
+
+        std::optional<mrpt::poses::CPose3DPDFGaussianInf> prior;
+    };
+
+    struct JobResult
+    {
+        /** false if the job was never started due to early cancellation */
+        bool executed = false;
+
+        /** Output of ICP::align(). Only valid if `executed` is true. If the job
+         * was interrupted by early cancellation, the termination reason will be
+         * IterTermReason::HookRequest. */
+        Results result;
+    };
+
+    /** Runs all jobs and blocks until all of them are finished or cancelled.
+     *
+     * \param stopOnQualityAbove If defined, as soon as any job ends with a
+     *        quality greater or equal than this value, pending jobs are
+     *        skipped and running ones are interrupted at their next ICP
+     *        iteration.
+     * \return One entry per input job, in the same order.
+     *
+     * Concurrent calls from different threads are serialized.
+     */
+    [[nodiscard]] std::vector<JobResult> run(
+        const std::vector<Job>&      jobs,
+        const std::optional<double>& stopOnQualityAbove = std::nullopt);
+
+    /** ICP parameters (loaded from the YAML config) used for all jobs */
+    Parameters&       parameters() { return icpParams_; }
+    const Parameters& parameters() const { return icpParams_; }
+
+    /** Number of ICP pipelines (and worker threads) in the pool */
+    std::size_t pool_size() const { return pool_.size(); }
+
+    /** Direct access to the i-th ICP pipeline, e.g. to tune parameters of
+     * matchers. Do not modify them while run() is executing.
+     *
+     * An iteration hook installed here with ICP::setIterationHook() is kept:
+     * run() chains its own early cancellation check after it, and restores
+     * it when finished. Note that it will be invoked from the worker thread.
+     */
+    ICP::Ptr& pipeline(std::size_t i) { return pool_.at(i); }
+
+    /** Builds the NN search structures (e.g. KD-trees) and other lazily
+     *  cached data (e.g. bounding boxes) of all layers of a map, so it can be
+     *  later queried from several threads concurrently.
+     *  Automatically called by run() for all input maps.
+     */
+    static void prepare_for_concurrent_queries(const metric_map_t& m);
+
+   private:
+    std::vector<ICP::Ptr> pool_;
+    Parameters            icpParams_;
+
+    std::atomic_bool cancelRequested_{false};
+    std::mutex       runMtx_;
+};
+
+}  // namespace mp2p_icp
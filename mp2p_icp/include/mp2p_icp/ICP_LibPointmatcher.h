@@ -18,6 +18,7 @@
 #include <mp2p_icp/metricmap.h>
 #include <mrpt/rtti/CObject.h>
 
+#include <memory>
 #include <vector>
 
 namespace mp2p_icp
@@ -63,8 +64,11 @@ class ICP_LibPointmatcher : public ICP
 
    private:
     std::string pm_icp_yaml_settings_;
-#if defined(MP2P_HAS_LIBPOINTMATCHER)
 
-#endif
+    /** The libpointmatcher ICP object, built once in initialize_derived()
+     * and reused in all calls to align(). Opaque here, to avoid exposing
+     * libpointmatcher headers. */
+    struct PmImpl;
+    std::shared_ptr<PmImpl> pm_;
 };
 }  // namespace mp2p_icp
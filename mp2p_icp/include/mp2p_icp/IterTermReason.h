@@ -23,7 +23,12 @@ enum class IterTermReason : uint8_t
     MaxIterations,
     Stalled,
     QualityCheckpointFailed,
-    HookRequest
+    HookRequest,
+    /** The time budget Parameters::maxTimeSeconds was exhausted */
+    Deadline,
+    /** The solution only kept moving along poorly-constrained directions,
+     * see Results::observability */
+    Degenerate
 };
 
 }  // namespace mp2p_icp
@@ -36,4 +41,6 @@ MRPT_FILL_ENUM(IterTermReason::MaxIterations);
 MRPT_FILL_ENUM(IterTermReason::Stalled);
 MRPT_FILL_ENUM(IterTermReason::QualityCheckpointFailed);
 MRPT_FILL_ENUM(IterTermReason::HookRequest);
+MRPT_FILL_ENUM(IterTermReason::Deadline);
+MRPT_FILL_ENUM(IterTermReason::Degenerate);
 MRPT_ENUM_TYPE_END()
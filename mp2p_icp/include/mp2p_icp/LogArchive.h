@@ -0,0 +1,179 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   LogArchive.h
+ * @brief  Single-file, append-only archive of ICP log records
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+#pragma once
+
+#include <mp2p_icp/IterTermReason.h>
+#include <mp2p_icp/LogRecord.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/io/CFileInputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/math/TPose3D.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace mp2p_icp
+{
+/** \addtogroup  mp2p_icp_grp
+ * @{ */
+
+/** Summary of one record in a log archive, available without decompressing
+ *  the record or its maps. \sa LogArchiveReader
+ */
+struct LogArchiveRecordInfo
+{
+    /** Position of the record chunk in the archive file */
+    uint64_t fileOffset = 0;
+
+    IterTermReason             terminationReason = IterTermReason::Undefined;
+    double                     quality           = 0;
+    uint64_t                   nIterations       = 0;
+    mrpt::math::TPose3D        optimalPose;
+    std::optional<uint64_t>    globalId, localId;
+    std::optional<std::string> globalLabel, localLabel;
+
+    /** Content hashes of the global and local maps (0: none) */
+    uint64_t globalMapHash = 0, localMapHash = 0;
+};
+
+/** Appends ICP log records to a single archive file.
+ *
+ * Archives hold a sequence of GZIP-compressed chunks of two kinds: metric maps
+ * and log records. Maps are identified by a hash of their contents and stored
+ * only once, so records sharing the same global map (the usual case in
+ * odometry or localization) do not duplicate it. Each record chunk starts with
+ * an uncompressed LogArchiveRecordInfo, so LogArchiveReader can index the
+ * archive without decompressing anything.
+ *
+ * Opening an existing archive appends to it. A trailing incomplete chunk (e.g.
+ * after a crash) is discarded.
+ *
+ * append() is thread-safe.
+ *
+ * \sa Parameters::debugArchiveFile, LogArchiveReader
+ */
+class LogArchiveWriter
+{
+   public:
+    LogArchiveWriter() = default;
+    ~LogArchiveWriter() = default;
+
+    /** Creates a new archive, or opens an existing one for appending.
+     *  Throws on error. */
+    void open(const std::string& fileName);
+
+    bool is_open() const { return f_.is_open(); }
+
+    void close();
+
+    /** Appends one record, storing its maps if they were not in the archive
+     *  already. Throws on error. */
+    void append(const LogRecord& record);
+
+    std::size_t record_count() const { return recordCount_; }
+    std::size_t map_count() const { return storedMaps_.size(); }
+
+   private:
+    std::mutex                  mtx_;
+    mrpt::io::CFileOutputStream f_;
+    std::set<uint64_t>          storedMaps_;
+    std::size_t                 recordCount_ = 0;
+
+    /** Returns the hash of the map, storing it if needed. */
+    uint64_t store_map(const metric_map_t& m);
+};
+
+/** Random access to the records of an archive created with
+ * LogArchiveWriter.
+ *
+ * open() only reads the chunk headers and record summaries, so it is fast
+ * even for archives with many thousands of records. Records and maps are
+ * decompressed on demand by load(), and the most recently used maps are
+ * cached, so loading consecutive records sharing a global map only
+ * decompresses it once.
+ *
+ * Methods are thread-safe.
+ */
+class LogArchiveReader
+{
+   public:
+    LogArchiveReader() = default;
+    ~LogArchiveReader() = default;
+
+    /** Opens and indexes an archive. Throws on error. */
+    void open(const std::string& fileName);
+
+    bool is_open() const { return f_.is_open(); }
+
+    /** Number of records in the archive */
+    std::size_t size() const { return records_.size(); }
+
+    /** Summaries of all records, in insertion order */
+    const std::vector<LogArchiveRecordInfo>& records() const
+    {
+        return records_;
+    }
+
+    /** Returns the indices of records for which `predicate` is true.
+     *  Example:
+     *  \code
+     *  const auto idxs = reader.filter([](const auto& r) {
+     *      return r.terminationReason == IterTermReason::MaxIterations; });
+     *  \endcode
+     */
+    std::vector<std::size_t> filter(
+        const std::function<bool(const LogArchiveRecordInfo&)>& predicate)
+        const;
+
+    /** Loads one record, by index in records(). If `loadMaps` is false, its
+     *  pcGlobal and pcLocal fields are left empty. Throws on error. */
+    LogRecord load(std::size_t index, bool loadMaps = true) const;
+
+    /** Loads a map by its content hash. Throws if not found. */
+    metric_map_t::ConstPtr load_map(uint64_t hash) const;
+
+    /** Number of distinct maps in the archive */
+    std::size_t map_count() const { return mapOffsets_.size(); }
+
+    /** Size of the archive up to the end of its last complete chunk */
+    uint64_t valid_size() const { return validSize_; }
+
+    /** Maximum number of decompressed maps kept in memory (Default: 4) */
+    std::size_t mapCacheSize = 4;
+
+   private:
+    mutable std::mutex                 mtx_;
+    mutable mrpt::io::CFileInputStream f_;
+
+    std::vector<LogArchiveRecordInfo> records_;
+    std::map<uint64_t, uint64_t>      mapOffsets_;  //!< hash -> offset
+    uint64_t                          validSize_ = 0;
+
+    mutable std::deque<std::pair<uint64_t, metric_map_t::ConstPtr>> mapCache_;
+
+    /** Reads the whole payload of the chunk at the given offset */
+    std::vector<uint8_t> read_chunk_payload(
+        uint64_t fileOffset, uint8_t expectedType) const;
+
+    metric_map_t::ConstPtr load_map_already_locked(uint64_t hash) const;
+};
+
+/** @} */
+
+}  // namespace mp2p_icp
@@ -68,7 +68,8 @@ class LogRecord : public mrpt::serialization::CSerializable
      * @{ */
 
     /** Saves the record object to a file, using MRPT serialization and
-     *  using on-the-fly GZIP compression.
+     *  GZIP compression by blocks in parallel threads, see
+     *  BlockGZOutputStream.
      * \return true on success.
      */
     bool save_to_file(const std::string& fileName) const;
@@ -32,12 +32,17 @@ struct MatchContext
 
     /// The ICP iteration number we are in:
     uint32_t icpIteration = 0;
+
+    /// If !=0, an upper limit to the number of local points per layer, on top
+    /// of the matcher own settings. Set by ICP when running out of time.
+    /// \sa Parameters::deadlineAdaptPointsMinIterations
+    uint64_t maxLocalPointsPerLayer = 0;
 };
 
 struct MatchState
 {
     MatchState(const metric_map_t& pcGlobal, const metric_map_t& pcLocal)
-        : pcGlobal_(pcGlobal), pcLocal_(pcLocal)
+        : pcGlobal_(&pcGlobal), pcLocal_(&pcLocal)
     {
         initialize();
     }
@@ -50,16 +55,29 @@ struct MatchState
     pointcloud_bitfield_t globalPairedBitField;
 
     /** Initialize all bit fields to their correct length and default value
-     * (false) */
+     * (false). Calling it again on the same maps only clears the entries
+     * marked since the former call, so a MatchState can be kept and reused
+     * across ICP iterations at a cost proportional to the number of
+     * pairings, not to the map sizes. */
     void initialize()
     {
-        localPairedBitField.initialize_from(pcLocal_);
-        globalPairedBitField.initialize_from(pcGlobal_);
+        localPairedBitField.initialize_from(*pcLocal_);
+        globalPairedBitField.initialize_from(*pcGlobal_);
+    }
+
+    /** Like initialize(), but for another pair of maps. Bit fields keep
+     * their memory, and are cleared in O(touched) if the maps have the same
+     * sizes as the former ones. */
+    void initialize(const metric_map_t& pcGlobal, const metric_map_t& pcLocal)
+    {
+        pcGlobal_ = &pcGlobal;
+        pcLocal_  = &pcLocal;
+        initialize();
     }
 
    private:
-    const metric_map_t& pcGlobal_;
-    const metric_map_t& pcLocal_;
+    const metric_map_t* pcGlobal_;
+    const metric_map_t* pcLocal_;
 };
 
 /** Pointcloud matching generic base class.
@@ -112,6 +130,9 @@ using matcher_list_t = std::vector<mp2p_icp::Matcher::Ptr>;
  * This is normally invoked by mp2p_icp::ICP, but users can use it as a
  * standalone module as needed.
  *
+ * A user-provided MatchState is used as is: call MatchState::initialize() on
+ * it before reusing it for a new set of pairings.
+ *
  * \ingroup mp2p_icp_grp
  */
 Pairings run_matchers(
@@ -82,8 +82,9 @@ class Matcher_Adaptive : public Matcher_Points_Base
     void implMatchOneLayer(
         const mrpt::maps::CMetricMap& pcGlobal,
         const mrpt::maps::CPointsMap& pcLocal,
-        const mrpt::poses::CPose3D& localPose, MatchState& ms,
-        const layer_name_t& globalName, const layer_name_t& localName,
+        const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+        MatchState& ms, const layer_name_t& globalName,
+        const layer_name_t& localName,
         Pairings& out) const override;
 };
 
@@ -0,0 +1,101 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   Matcher_Planes_Normals.h
+ * @brief  Plane matcher: similar planes (centroid distance + normals)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+#pragma once
+
+#include <mp2p_icp/Matcher.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace mp2p_icp
+{
+/** Plane matcher: finds pairings between the `planes` of the `local` and
+ * `global` input metric maps, whose centroids are close and whose normals are
+ * (anti)parallel within a given tolerance.
+ *
+ * For each local plane, the best global candidate (the one with the closest
+ * centroid) is emitted as a plane-to-plane pairing (`paired_pl2pl`) and/or as
+ * a point-to-plane pairing between the local plane centroid and the global
+ * plane (`paired_pt2pl`). Pairings of anti-parallel planes are emitted with
+ * the local plane flipped, so normals of both planes always agree.
+ *
+ * Global planes are indexed in a hash grid of their centroids, with one
+ * bucket per dominant normal axis, built once and reused while the global
+ * planes do not change (detected from a hash of their contents, so modified
+ * or new maps are never matched against a stale index).
+ *
+ * Each global plane is paired to one local plane at most, unless
+ * `allowMatchAlreadyMatchedPlanes` is set. This applies to planes paired by
+ * former matchers in the pipeline too.
+ *
+ * Local planes are processed in parallel (if built with TBB), and pairings
+ * are always emitted in the order of local planes.
+ *
+ * \ingroup mp2p_icp_grp
+ */
+class Matcher_Planes_Normals : public Matcher
+{
+    DEFINE_MRPT_OBJECT(Matcher_Planes_Normals, mp2p_icp)
+
+   public:
+    Matcher_Planes_Normals();
+
+    /** Parameters:
+     * - `distanceThreshold`: Max. distance between plane centroids
+     * [meters][mandatory]
+     * - `planeDistanceThreshold`: Max. distance between the local plane
+     * centroid and the global plane [meters]. Default=0.25 [optional]
+     * - `normalsAngleThresholdDeg`: Max. angle between plane normals [deg].
+     * Default=5.0 [optional]
+     * - `emitPlaneToPlane`: Default=true [optional]
+     * - `emitPointToPlane`: Default=true [optional]
+     * - `allowMatchAlreadyMatchedPlanes`: Allow pairing local or global
+     * planes already paired by this or a former matcher. Default=false
+     * [optional]
+     */
+    void initialize(const mrpt::containers::yaml& params) override;
+
+    double distanceThreshold        = 1.0;  // m
+    double planeDistanceThreshold   = 0.25;  // m
+    double normalsAngleThresholdDeg = 5.0;  // deg
+
+    bool emitPlaneToPlane               = true;
+    bool emitPointToPlane               = true;
+    bool allowMatchAlreadyMatchedPlanes = false;
+
+   protected:
+    bool impl_match(
+        const metric_map_t& pcGlobal, const metric_map_t& pcLocal,
+        const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+        MatchState& ms, Pairings& out) const override;
+
+   private:
+    /** Index over the planes of a global map */
+    struct PlaneIndex
+    {
+        uint64_t    fingerprint = 0;  //!< Hash of the indexed planes
+        std::size_t nPlanes     = 0;
+        double      cellSize    = 0;
+
+        /** key: (centroid cell, dominant normal axis) */
+        std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+
+        static uint64_t key(int32_t cx, int32_t cy, int32_t cz, uint8_t axis);
+    };
+
+    mutable PlaneIndex index_;
+
+    void build_index(const metric_map_t& pcGlobal, uint64_t fingerprint) const;
+};
+
+}  // namespace mp2p_icp
@@ -25,6 +25,8 @@ namespace mp2p_icp
  * member `weight_pt2pt_layers`. Refer to example configuration YAML files for
  * example configurations.
  *
+ * Global layers must implement NearestPlaneCapable, e.g. VoxelSurfelMap.
+ *
  * \ingroup mp2p_icp_grp
  */
 class Matcher_Point2Plane : public Matcher_Points_Base
@@ -47,8 +49,9 @@ class Matcher_Point2Plane : public Matcher_Points_Base
     void implMatchOneLayer(
         const mrpt::maps::CMetricMap& pcGlobal,
         const mrpt::maps::CPointsMap& pcLocal,
-        const mrpt::poses::CPose3D& localPose, MatchState& ms,
-        const layer_name_t& globalName, const layer_name_t& localName,
+        const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+        MatchState& ms, const layer_name_t& globalName,
+        const layer_name_t& localName,
         Pairings& out) const override;
 };
 
@@ -93,7 +93,8 @@ class Matcher_Points_Base : public Matcher
         mrpt::math::TPoint3Df localMin{fMax, fMax, fMax};
         mrpt::math::TPoint3Df localMax{-fMax, -fMax, -fMax};
 
-        /** Reordering indexes, used only if we had to pick random indexes */
+        /** Indices of the random subset of local points, in ascending order.
+         *  Used only if we had to pick random indexes */
         std::optional<std::vector<std::size_t>> idxs;
 
         /** Transformed local points: all, or a random subset */
@@ -115,12 +116,24 @@ class Matcher_Points_Base : public Matcher
         const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
         MatchState& ms, Pairings& out) const override final;
 
+    /** maxLocalPointsPerLayer_, further limited by the given MatchContext
+     * (0: no limit). */
+    uint64_t effectiveMaxLocalPointsPerLayer(const MatchContext& mc) const;
+
+    /** Number of points of the local layer that will be actually matched,
+     * according to effectiveMaxLocalPointsPerLayer(). To be used in
+     * Pairings::potential_pairings, so pairing ratios remain meaningful when
+     * only a random subset of local points is matched. */
+    std::size_t sampledLocalPointCount(
+        const mrpt::maps::CPointsMap& pcLocal, const MatchContext& mc) const;
+
    private:
     virtual void implMatchOneLayer(
         const mrpt::maps::CMetricMap& pcGlobal,
         const mrpt::maps::CPointsMap& pcLocal,
-        const mrpt::poses::CPose3D& localPose, MatchState& ms,
-        const layer_name_t& globalName, const layer_name_t& localName,
+        const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+        MatchState& ms, const layer_name_t& globalName,
+        const layer_name_t& localName,
         Pairings& out) const = 0;
 };
 
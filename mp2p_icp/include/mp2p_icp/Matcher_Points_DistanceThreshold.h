@@ -13,6 +13,10 @@
 
 #include <mp2p_icp/Matcher_Points_Base.h>
 
+#include <map>
+#include <utility>
+#include <vector>
+
 namespace mp2p_icp
 {
 /** Pointcloud matcher: fixed distance thresholds.
@@ -45,6 +49,13 @@ class Matcher_Points_DistanceThreshold : public Matcher_Points_Base
      * - `pairingsPerPoint`: Number of pairings in "global" for each "local"
      * points. Default=1. If more than one, they will be picked in ascending
      * order of distance, up to `threshold`. [optional].
+     * - `correspondenceReuseFraction`: If >0, enables reusing the global
+     * neighbors found in the former ICP iteration, for local points that moved
+     * less than this fraction of `threshold`. Must be in range [0,1).
+     * Default=0 (disabled). [optional].
+     * - `correspondenceReuseCandidates`: Number of global neighbors remembered
+     * for each local point, if `correspondenceReuseFraction`>0. Default=8.
+     * [optional].
      *
      * Plus: the parameters of Matcher_Points_Base::initialize()
      */
@@ -54,12 +65,54 @@ class Matcher_Points_DistanceThreshold : public Matcher_Points_Base
     double   thresholdAngularDeg = 0.50;  // deg
     uint32_t pairingsPerPoint    = 1;
 
+    /** Correspondence reuse between ICP iterations.
+     *
+     * For each local point, the `correspondenceReuseCandidates` nearest global
+     * points are remembered, together with the radius `r` around the query
+     * point that they are known to cover. In the next iteration, if the
+     * transformed local point moved `d` < `correspondenceReuseFraction` *
+     * `threshold`, the candidates are simply re-ranked: those closer than
+     * `r-d` are guaranteed to be the actual nearest neighbors, so the
+     * KD-tree query is skipped whenever they are enough to fill the requested
+     * pairings. Hence, the output pairings are identical to those without
+     * reuse.
+     *
+     * Useful in late ICP iterations, when pose increments are tiny.
+     * The cache is reset at the first ICP iteration, or if the global map
+     * changes.
+     */
+    double   correspondenceReuseFraction   = 0;
+    uint32_t correspondenceReuseCandidates = 8;
+
    private:
+    struct ReuseCache
+    {
+        const mrpt::maps::CMetricMap* global     = nullptr;
+        std::size_t                   globalSize = 0;
+        uint32_t                      K          = 0;
+
+        // One entry per local point:
+        std::vector<uint8_t>               valid;
+        std::vector<mrpt::math::TPoint3Df> query;
+        std::vector<float>                 radius;
+        std::vector<uint32_t>              count;
+
+        // K entries per local point:
+        std::vector<uint64_t>              candIdx;
+        std::vector<mrpt::math::TPoint3Df> candPts;
+
+        void reset(std::size_t nLocal, uint32_t newK);
+    };
+
+    mutable std::map<std::pair<layer_name_t, layer_name_t>, ReuseCache>
+        reuseCache_;
+
     void implMatchOneLayer(
         const mrpt::maps::CMetricMap& pcGlobal,
         const mrpt::maps::CPointsMap& pcLocal,
-        const mrpt::poses::CPose3D& localPose, MatchState& ms,
-        const layer_name_t& globalName, const layer_name_t& localName,
+        const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+        MatchState& ms, const layer_name_t& globalName,
+        const layer_name_t& localName,
         Pairings& out) const override;
 };
 
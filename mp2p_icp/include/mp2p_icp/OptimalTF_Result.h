@@ -12,8 +12,13 @@
 #pragma once
 
 #include <mp2p_icp/Pairings.h>
+#include <mrpt/math/CMatrixFixed.h>
+#include <mrpt/math/CVectorFixed.h>
 #include <mrpt/poses/CPose3D.h>
 
+#include <optional>
+#include <vector>
+
 namespace mp2p_icp
 {
 /** \addtogroup  mp2p_icp_grp
@@ -28,6 +33,42 @@ struct OptimalTF_Result
 
     /** Correspondence that were detected as outliers. */
     OutlierIndices outliers;
+
+    /** Convergence telemetry of one iteration of an iterative solver */
+    struct IterationInfo
+    {
+        /** Cost at the linearization point of this iteration */
+        double cost = 0;
+
+        /** Norm of the proposed SE(3) increment */
+        double stepNorm = 0;
+
+        /** Levenberg-Marquardt damping (0 for plain Gauss-Newton) */
+        double lambda = 0;
+
+        /** Whether the step was applied, or rejected for not reducing the
+         * cost */
+        bool accepted = true;
+    };
+
+    /** Per-iteration telemetry, filled in by iterative solvers only (e.g.
+     * Solver_GaussNewton). Empty for closed-form solvers. */
+    std::vector<IterationInfo> iterations;
+
+    /** Eigenvalues of the 6x6 Hessian approximation of the last
+     * linearization, in ascending order. Small values, relative to the
+     * largest one, reveal poorly-constrained directions (degenerate geometry,
+     * e.g. corridors). Only filled in by Solver_GaussNewton.
+     */
+    std::optional<mrpt::math::CVectorFixedDouble<6>> hessianEigenvalues;
+
+    /** Degeneracy analysis of the last linearization, only if enabled in the
+     * solver (see Solver_GaussNewton::degeneracyThreshold): projector onto
+     * the subspace of well-constrained SE(3) directions, spanned by the
+     * Hessian eigenvectors with large enough eigenvalues. Its diagonal is the
+     * per-axis observability, in the range [0,1].
+     */
+    std::optional<mrpt::math::CMatrixDouble66> wellConstrainedProjector;
 };
 
 /** @} */
@@ -44,6 +44,39 @@ struct Parameters : public mrpt::serialization::CSerializable
     double minAbsStep_rot{1e-4};
     /** @} */
 
+    /** @name Time budget
+        @{ */
+
+    /** If >0, the maximum wall-clock time [seconds] for each ICP::align()
+     * call. The time of each iteration is predicted from a running average of
+     * the time spent in matchers and solvers, and iterations stop, with
+     * IterTermReason::Deadline, before starting one that would not end within
+     * the budget. The solution of the last completed iteration is returned,
+     * along with the pairings it was computed from, which are also those
+     * used for the final quality and covariance.
+     *
+     * At least one iteration is always run. The final quality evaluation and
+     * covariance are not included in the prediction, so leave some margin
+     * for them. Default: 0 (no time limit).
+     */
+    double maxTimeSeconds = 0;
+
+    /** Predicted iteration times are multiplied by this factor before
+     * checking them against the remaining time (Default: 1.2) */
+    double deadlineSafetyFactor = 1.2;
+
+    /** If >0 and maxTimeSeconds is set, when the cost model predicts that
+     * fewer than this number of iterations fit into the remaining time, the
+     * number of local points used by the matchers is reduced accordingly (by
+     * means of MatchContext::maxLocalPointsPerLayer), down to
+     * deadlineMinLocalPointsPerLayer. Default: 0 (disabled).
+     */
+    uint32_t deadlineAdaptPointsMinIterations = 0;
+
+    /** See deadlineAdaptPointsMinIterations */
+    uint64_t deadlineMinLocalPointsPerLayer = 500;
+    /** @} */
+
     /** @name Debugging and logging
         @{ */
 
@@ -79,6 +112,14 @@ struct Parameters : public mrpt::serialization::CSerializable
         "icp-run-$UNIQUE_ID-local-$LOCAL_ID$LOCAL_LABEL-"
         "global-$GLOBAL_ID$GLOBAL_LABEL.icplog";
 
+    /** If not empty, and generateDebugFiles is true, log records are appended
+     * to this single archive file instead of creating one file per ICP run
+     * (debugFileNameFormat is then ignored). Maps repeated across records,
+     * e.g. the global map, are stored only once.
+     * \sa LogArchiveWriter, LogArchiveReader
+     */
+    std::string debugArchiveFile;
+
     /** Function to apply to the local and global maps before saving the map to
      * a log file. Useful to apply deletion filters to save space and time.
      */
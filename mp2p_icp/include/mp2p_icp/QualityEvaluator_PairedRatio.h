@@ -14,6 +14,8 @@
 #include <mp2p_icp/Matcher_Points_DistanceThreshold.h>
 #include <mp2p_icp/QualityEvaluator.h>
 
+#include <optional>
+
 namespace mp2p_icp
 {
 /** Matching quality evaluator: simple ratio [0,1] of paired entities,
@@ -21,6 +23,16 @@ namespace mp2p_icp
  *  or (faster) directly from the ratio of found pairings in the last ICP step
  *  if `reuse_icp_pairings` is `true`, the default.
  *
+ *  With an independent matcher, `maxLocalPointsToEvaluate` bounds its cost by
+ *  matching only a random subset of that many local points per layer. The
+ *  standard error of the estimated ratio is then at most
+ *  0.5/sqrt(maxLocalPointsToEvaluate) (e.g. 1.1% for 2000 points), and
+ *  `hard_discard` is only set if the ratio is below
+ *  `absolute_minimum_pairing_ratio` by more than twice that error.
+ *
+ *  The matcher state is kept and reused across evaluate() calls, so do not
+ *  call evaluate() concurrently on the same object.
+ *
  * \ingroup mp2p_icp_grp
  */
 class QualityEvaluator_PairedRatio : public QualityEvaluator
@@ -34,6 +46,7 @@ class QualityEvaluator_PairedRatio : public QualityEvaluator
      * reuse_icp_pairings: true # Default=true (no more params then required)
      * #thresholdDistance: 0.10
      * #thresholdAngularDeg: 0
+     * #maxLocalPointsToEvaluate: 2000  # Default=0 (all)
      * \endcode
      */
     void initialize(const mrpt::containers::yaml& params) override;
@@ -53,7 +66,12 @@ class QualityEvaluator_PairedRatio : public QualityEvaluator
     Matcher_Points_DistanceThreshold matcher_;
     bool                             reuse_icp_pairings = true;
 
+    /** Reused across calls, so it is not reallocated for each evaluation */
+    mutable std::optional<MatchState> matchState_;
+
     double absolute_minimum_pairing_ratio = 0.20;
+
+    uint64_t maxLocalPointsToEvaluate = 0;
 };
 
 }  // namespace mp2p_icp
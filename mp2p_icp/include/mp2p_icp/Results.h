@@ -6,10 +6,12 @@
 #pragma once
 
 #include <mp2p_icp/Pairings.h>
+#include <mrpt/math/CVectorFixed.h>
 #include <mrpt/poses/CPose3DPDFGaussian.h>
 
 #include <cstdint>
 #include <iosfwd>
+#include <optional>
 
 #include "IterTermReason.h"
 
@@ -40,6 +42,15 @@ struct Results
     /** A copy of the pairings found in the last ICP iteration. */
     Pairings finalPairings;
 
+    /** Per-axis observability of the solution, in the order of the SE(3)
+     * tangent space (x,y,z,rx,ry,rz): 1 for axes fully within the
+     * well-constrained subspace of the last solver linearization, down to 0
+     * for fully degenerate axes (e.g. along a corridor). Only filled in if
+     * the solver performs degeneracy analysis, see
+     * Solver_GaussNewton::degeneracyThreshold.
+     */
+    std::optional<mrpt::math::CVectorFixedDouble<6>> observability;
+
     void serializeTo(mrpt::serialization::CArchive& out) const;
     void serializeFrom(mrpt::serialization::CArchive& in);
 
@@ -13,6 +13,7 @@
 
 #include <mp2p_icp/PairWeights.h>
 #include <mp2p_icp/Solver.h>
+#include <mp2p_icp/optimal_tf_gauss_newton.h>
 #include <mp2p_icp/robust_kernels.h>
 
 namespace mp2p_icp
@@ -20,6 +21,11 @@ namespace mp2p_icp
 /** ICP registration for points, planes, and lines, using an iterative
  * Gauss-Newton numerical solver.
  *
+ * Set `stepControl: LevenbergMarquardt` to use damped steps, only accepted if
+ * they reduce the cost. This avoids overshooting in poorly-constrained
+ * geometry (corridors, tunnels), at the cost of one extra linearization per
+ * rejected step. See optimal_tf_gauss_newton().
+ *
  * \ingroup mp2p_icp_grp
  */
 class Solver_GaussNewton : public Solver
@@ -34,6 +40,16 @@ class Solver_GaussNewton : public Solver
     double       robustKernelParam = 1.0;
     bool         innerLoopVerbose  = false;  //!< Prints GN inner loop details
 
+    GNStepControl stepControl     = GNStepControl::GaussNewton;
+    double        lmInitialLambda = 1e-4;  //!< See OptimalTF_GN_Parameters
+
+    /** Relative eigenvalue threshold for degeneracy-aware remapping
+     * (0=disabled). See OptimalTF_GN_Parameters::degeneracyThreshold */
+    double degeneracyThreshold = 0;
+
+    /** See OptimalTF_GN_Parameters::singlePrecision */
+    bool singlePrecision = false;
+
     void initialize(const mrpt::containers::yaml& params) override;
 
    protected:
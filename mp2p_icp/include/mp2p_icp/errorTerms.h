@@ -55,4 +55,41 @@ mrpt::math::CVectorFixedDouble<3> error_plane2plane(
     mrpt::optional_ref<mrpt::math::CMatrixFixed<double, 3, 12>> jacobian =
         std::nullopt);
 
+/** @name Error terms with closed-form tangent-space Jacobians
+ *
+ * These overloads return the same errors as the functions above, but their
+ * Jacobians are directly evaluated with respect to an SE(3) increment
+ * \f$ \epsilon = [\rho ~ \omega] \f$ on the right of the pose,
+ * \f$ \mathbf{T} \exp(\epsilon) \f$, that is, the product of the 3x12
+ * Jacobians above times `mrpt::poses::Lie::SE<3>::jacob_dDexpe_de()`.
+ * For pt2pt, for example, it is \f$ [\mathbf{R} ~|~ -\mathbf{R}
+ * [\mathbf{l}]_\times] \f$.
+ *
+ * Used in the hot loop of optimal_tf_gauss_newton().
+ * @{ */
+
+mrpt::math::CVectorFixedDouble<3> error_point2point(
+    const mrpt::tfest::TMatchingPair&       pairing,
+    const mrpt::poses::CPose3D&             relativePose,
+    mrpt::math::CMatrixFixed<double, 3, 6>& jacobian);
+
+mrpt::math::CVectorFixedDouble<3> error_point2line(
+    const mp2p_icp::point_line_pair_t&      pairing,
+    const mrpt::poses::CPose3D&             relativePose,
+    mrpt::math::CMatrixFixed<double, 3, 6>& jacobian);
+
+/** Scalar, signed point-to-plane distance. Note that error_point2plane()
+ * above returns the same distance times the (negative) plane normal. */
+double error_point2plane(
+    const mp2p_icp::point_plane_pair_t&     pairing,
+    const mrpt::poses::CPose3D&             relativePose,
+    mrpt::math::CMatrixFixed<double, 1, 6>& jacobian);
+
+mrpt::math::CVectorFixedDouble<3> error_plane2plane(
+    const mp2p_icp::matched_plane_t&        pairing,
+    const mrpt::poses::CPose3D&             relativePose,
+    mrpt::math::CMatrixFixed<double, 3, 6>& jacobian);
+
+/** @} */
+
 }  // namespace mp2p_icp
@@ -0,0 +1,171 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   global_registration.h
+ * @brief  Coarse, initial-guess-free registration (FPFH features + RANSAC)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+#pragma once
+
+#include <mp2p_icp/ICP.h>
+#include <mp2p_icp/Parameters.h>
+#include <mp2p_icp/Results.h>
+#include <mp2p_icp/layer_name_t.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/TPoint3D.h>
+#include <mrpt/math/TPose3D.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace mp2p_icp
+{
+/** \addtogroup  mp2p_icp_grp
+ * @{ */
+
+/** Parameters for global_registration() */
+struct GlobalRegistrationParameters
+{
+    /** Point layers (in the local and global maps) used to extract features.
+     * Typically, the raw point cloud, or the output of a decimation filter. */
+    layer_name_t local_layer  = metric_map_t::PT_LAYER_RAW;
+    layer_name_t global_layer = metric_map_t::PT_LAYER_RAW;
+
+    /** Keypoints are sampled as one point per voxel of this size [m] */
+    double keypoint_voxel_size = 1.0;
+
+    /** Radius for normal estimation around each keypoint [m] */
+    double normal_radius = 1.5;
+
+    /** Radius for the FPFH neighborhood of each keypoint [m] */
+    double feature_radius = 4.0;
+
+    /** Maximum neighbors for each radius search */
+    uint32_t max_neighbors = 100;
+
+    /** Keep only mutual (local<->global) nearest descriptor matches */
+    bool mutual_filter = true;
+
+    /** Number of RANSAC hypotheses (3 correspondences each) */
+    uint32_t ransac_iterations = 20000;
+
+    /** Max distance [m] between a transformed local keypoint and its global
+     * correspondence to count as inlier */
+    double inlier_threshold = 1.5;
+
+    /** Hypotheses are discarded early if the lengths of the triangle edges
+     * formed by the sampled local and global points have a ratio smaller
+     * than this, in the range (0,1). */
+    double edge_length_similarity = 0.9;
+
+    /** Minimum number of inliers to report success */
+    uint32_t min_inliers = 10;
+
+    /** RANSAC random seed (results are deterministic for a given seed,
+     * regardless of the number of threads) */
+    uint64_t seed = 0x1234;
+
+    void load_from(const mrpt::containers::yaml& p);
+};
+
+/** Number of bins of FPFH descriptors (3 angular features x 11 bins) */
+constexpr std::size_t FPFH_LENGTH = 33;
+
+/** Keypoints and their descriptors, as returned by compute_fpfh_features() */
+struct PointFeatures
+{
+    std::vector<mrpt::math::TPoint3Df>            points;
+    std::vector<std::array<float, FPFH_LENGTH>> descriptors;
+
+    std::size_t size() const { return points.size(); }
+};
+
+/** Samples keypoints from a point cloud (one per voxel) and computes a Fast
+ * Point Feature Histogram (FPFH) descriptor for each one. Keypoints without
+ * enough neighbors for a reliable normal are dropped.
+ *
+ * Normals are not oriented towards any sensor viewpoint, which would not be
+ * defined for maps built from many scans. Instead, the pair features are
+ * invariant to the sign of the normals, so the local and global clouds can
+ * be given in any frame.
+ *
+ * Reference: Rusu, R. B., Blodow, N., & Beetz, M. (2009). "Fast point feature
+ * histograms (FPFH) for 3D registration". ICRA.
+ */
+PointFeatures compute_fpfh_features(
+    const mrpt::maps::CPointsMap& pts, const GlobalRegistrationParameters& p);
+
+/** Output of global_registration() */
+struct GlobalRegistrationResult
+{
+    /** true if a hypothesis with at least `min_inliers` inliers was found */
+    bool success = false;
+
+    /** The estimated pose of "local" wrt "global" */
+    mrpt::poses::CPose3D optimalPose;
+
+    std::size_t localKeypoints = 0, globalKeypoints = 0;
+
+    /** Number of (putative) correspondences, and inliers among them */
+    std::size_t correspondences = 0, inliers = 0;
+};
+
+/** Putative keypoint correspondences, as pairs (localIdx, globalIdx) */
+using FeatureCorrespondences = std::vector<std::pair<uint32_t, uint32_t>>;
+
+/** Finds, for each local feature, its nearest global feature in descriptor
+ * space (optionally, only mutual nearest neighbors), using KD-trees over the
+ * FPFH descriptors. */
+FeatureCorrespondences match_features(
+    const PointFeatures& local, const PointFeatures& global,
+    bool mutualFilter);
+
+/** Robustly estimates the SE(3) transformation between two sets of
+ * putative correspondences, using parallel RANSAC over minimal (3-point)
+ * samples solved with optimal_tf_horn(), followed by a final least-squares
+ * refinement over all inliers.
+ */
+GlobalRegistrationResult ransac_registration(
+    const PointFeatures& local, const PointFeatures& global,
+    const FeatureCorrespondences&       corrs,
+    const GlobalRegistrationParameters& p);
+
+/** Coarse alignment of two maps with no initial guess at all, e.g. for
+ * relocalization: features from the given point layers are extracted,
+ * matched, and a robust transformation estimated via RANSAC.
+ *
+ * The result is not accurate, but is intended as initial guess for ICP.
+ * \sa align_with_global_registration()
+ */
+GlobalRegistrationResult global_registration(
+    const metric_map_t& pcLocal, const metric_map_t& pcGlobal,
+    const GlobalRegistrationParameters& p);
+
+/** Two-stage registration: runs global_registration() and feeds its result
+ *  as initial guess to ICP::align().
+ *
+ * \param fallbackInitialGuess Used if global registration fails. If not
+ *        provided, ICP is not run at all in that case, and
+ *        `result.terminationReason` is left as IterTermReason::Undefined.
+ * \return The global registration result, for reference.
+ */
+GlobalRegistrationResult align_with_global_registration(
+    ICP& icp, const metric_map_t& pcLocal, const metric_map_t& pcGlobal,
+    const GlobalRegistrationParameters& grp, const Parameters& icpParams,
+    Results&                                  result,
+    const std::optional<mrpt::math::TPose3D>& fallbackInitialGuess =
+        std::nullopt);
+
+/** @} */
+
+}  // namespace mp2p_icp
@@ -16,11 +16,29 @@
 #include <mp2p_icp/Pairings.h>
 #include <mp2p_icp/robust_kernels.h>
 #include <mrpt/poses/CPose3DPDFGaussianInf.h>
+#include <mrpt/typemeta/TEnumType.h>
+
+#include <cstdint>
 
 namespace mp2p_icp
 {
 /** \addtogroup  mp2p_icp_grp
  * @{ */
+
+/** How to compute and accept steps in optimal_tf_gauss_newton(). Support
+ *  mrpt::typemeta::TEnumType to get/set from strings.
+ */
+enum class GNStepControl : uint8_t
+{
+    /// Plain Gauss-Newton: always take the full step.
+    GaussNewton = 0,
+
+    /// Levenberg-Marquardt: damped steps, only accepted if they reduce the
+    /// cost, with the damping adapted from the actual vs predicted cost
+    /// reduction (Nielsen's update rule).
+    LevenbergMarquardt,
+};
+
 struct OptimalTF_GN_Parameters
 {
     OptimalTF_GN_Parameters() = default;
@@ -38,9 +56,30 @@ struct OptimalTF_GN_Parameters
     /** Minimum SE(3) change to stop iterating. */
     double minDelta = 1e-7;
 
-    /** Maximum cost function; when reached, stop iterating. */
+    /** Maximum cost function (square root of the weighted sum of squared
+     * errors, including the prior, if any); when reached, stop iterating. */
     double maxCost = 0;
 
+    GNStepControl stepControl = GNStepControl::GaussNewton;
+
+    /** Initial Levenberg-Marquardt damping, relative to the largest diagonal
+     * element of the Hessian. Only for GNStepControl::LevenbergMarquardt */
+    double lmInitialLambda = 1e-4;
+
+    /** If >0, enables degeneracy-aware solution remapping: Hessian
+     * eigenvalues smaller than this fraction of the largest one are taken as
+     * poorly-constrained (degenerate) directions, and each step is projected
+     * onto the remaining, well-constrained, subspace. The projector is
+     * reported in OptimalTF_Result::wellConstrainedProjector. */
+    double degeneracyThreshold = 0;
+
+    /** If true, point-to-point and point-to-plane terms (usually, the vast
+     * majority) are evaluated and accumulated in single precision, which is
+     * faster and makes better use of SIMD instructions. Partial sums are
+     * flushed into double precision every few pairings, and the normal
+     * equations are always solved in double precision. */
+    bool singlePrecision = false;
+
     PairWeights pairWeights;
 
     /** Maximum number of iterations trying to solve for the optimal pose */
@@ -58,6 +97,16 @@ struct OptimalTF_GN_Parameters
  * This method requires a linearization point in
  * `OptimalTF_GN_Parameters::linearizationPoint`.
  *
+ * Steps are either plain Gauss-Newton or Levenberg-Marquardt, see
+ * OptimalTF_GN_Parameters::stepControl. The cost, step norm and damping of
+ * each iteration are reported in OptimalTF_Result::iterations, and the
+ * eigenvalues of the Hessian in OptimalTF_Result::hessianEigenvalues.
+ *
+ * Optionally, steps are restricted to the well-constrained directions of the
+ * problem (Zhang et al., "On degeneracy of optimization-based state
+ * estimation problems", ICRA 2016), see
+ * OptimalTF_GN_Parameters::degeneracyThreshold.
+ *
  * \return false If the number of pairings is too small for a unique
  * solution, true on success.
  */
@@ -68,3 +117,8 @@ struct OptimalTF_GN_Parameters
 /** @} */
 
 }  // namespace mp2p_icp
+
+MRPT_ENUM_TYPE_BEGIN_NAMESPACE(mp2p_icp, mp2p_icp::GNStepControl)
+MRPT_FILL_ENUM(GNStepControl::GaussNewton);
+MRPT_FILL_ENUM(GNStepControl::LevenbergMarquardt);
+MRPT_ENUM_TYPE_END()
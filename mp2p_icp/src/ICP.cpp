@@ -11,6 +11,7 @@
  */
 
 #include <mp2p_icp/ICP.h>
+#include <mp2p_icp/LogArchive.h>
 #include <mp2p_icp/covariance.h>
 #include <mrpt/core/exceptions.h>
 #include <mrpt/core/lock_helper.h>
@@ -18,6 +19,7 @@
 #include <mrpt/system/filesystem.h>
 #include <mrpt/tfest/se3.h>
 
+#include <chrono>
 #include <regex>
 
 IMPLEMENTS_MRPT_OBJECT(ICP, mrpt::rtti::CObject, mp2p_icp)
@@ -37,6 +39,13 @@ void ICP::align(
 
     mrpt::system::CTimeLoggerEntry tle(profiler_, "align");
 
+    // Time budget (if p.maxTimeSeconds>0):
+    using std::chrono::steady_clock;
+
+    const auto tStart        = steady_clock::now();
+    const auto lambdaElapsed = [](const steady_clock::time_point& t0)
+    { return std::chrono::duration<double>(steady_clock::now() - t0).count(); };
+
     // ----------------------------
     // Initial sanity checks
     // ----------------------------
@@ -85,12 +94,16 @@ void ICP::align(
             obj.attachToParameterSource(ownParamSource_);
             ps = &ownParamSource_;
         }
-        ps->updateVariable("ICP_ITERATION", result.nIterations);
         activeParamSouces.insert(ps);
     };
     auto lambdaRealizeParamSources = [&]()
     {
-        for (auto& ps : activeParamSouces) ps->realize();
+        // Only once per source, not per attached object:
+        for (auto& ps : activeParamSouces)
+        {
+            ps->updateVariable("ICP_ITERATION", result.nIterations);
+            ps->realize();
+        }
     };
 
     // ------------------------------------------------------
@@ -113,6 +126,28 @@ void ICP::align(
     SolverContext                       sc;
     sc.prior = prior;
 
+    // Cost model for the time budget: running averages of the time spent
+    // per iteration in matchers and solvers [s]:
+    std::optional<double> avrMatchersTime, avrSolversTime;
+    uint64_t              localPointsLimit = 0;  // 0: no limit
+
+    const auto lambdaUpdateAverage = [](std::optional<double>& avr, double t)
+    {
+        if (avr)
+            *avr = 0.5 * (*avr + t);
+        else
+            avr = t;
+    };
+
+    // Largest number of points in a local layer, the starting point if
+    // the local points have to be decimated to meet the deadline:
+    uint64_t maxLocalLayerPoints = 0;
+    for (const auto& [name, layer] : pcLocal.layers)
+    {
+        if (const auto* pts = mp2p_icp::MapToPointsMap(*layer); pts)
+            mrpt::keep_max(maxLocalLayerPoints, pts->size());
+    }
+
     for (result.nIterations = 0; result.nIterations < p.maxIterations;
          result.nIterations++)
     {
@@ -121,6 +156,64 @@ void ICP::align(
         // Update iteration count, both in direct C++ structure...
         state.currentIteration = result.nIterations;
 
+        // Time budget: is there time for one more iteration?
+        if (p.maxTimeSeconds > 0 && avrMatchersTime && avrSolversTime)
+        {
+            const double predicted = p.deadlineSafetyFactor *
+                                     (*avrMatchersTime + *avrSolversTime);
+            const double remaining = p.maxTimeSeconds - lambdaElapsed(tStart);
+
+            if (predicted > remaining)
+            {
+                result.terminationReason = IterTermReason::Deadline;
+                if (p.debugPrintIterationProgress)
+                {
+                    printf(
+                        "[ICP] Iter=%3u Deadline: %.03f ms left, %.03f ms "
+                        "predicted for next iteration.\n",
+                        static_cast<unsigned int>(state.currentIteration),
+                        1e3 * remaining, 1e3 * predicted);
+                }
+                break;
+            }
+
+            // Decimate local points so more iterations fit in the budget?
+            const double itersLeft = remaining / predicted;
+            if (p.deadlineAdaptPointsMinIterations > 0 &&
+                itersLeft < p.deadlineAdaptPointsMinIterations &&
+                maxLocalLayerPoints > 0)
+            {
+                const uint64_t current =
+                    localPointsLimit != 0 ? localPointsLimit
+                                          : maxLocalLayerPoints;
+                const uint64_t newLimit = std::max<uint64_t>(
+                    p.deadlineMinLocalPointsPerLayer,
+                    static_cast<uint64_t>(
+                        current * itersLeft /
+                        p.deadlineAdaptPointsMinIterations));
+
+                if (newLimit < current)
+                {
+                    localPointsLimit = newLimit;
+
+                    // Assume costs are proportional to the number of points:
+                    const double ratio = static_cast<double>(newLimit) /
+                                         static_cast<double>(current);
+                    *avrMatchersTime *= ratio;
+                    *avrSolversTime *= ratio;
+
+                    if (p.debugPrintIterationProgress)
+                    {
+                        printf(
+                            "[ICP] Iter=%3u Deadline: limiting local points "
+                            "to %u per layer.\n",
+                            static_cast<unsigned int>(state.currentIteration),
+                            static_cast<unsigned int>(localPointsLimit));
+                    }
+                }
+            }
+        }
+
         // ...and via programmable formulas:
         for (auto& obj : matchers_) lambdaAddOwnParams(*obj);
         for (auto& obj : solvers_) lambdaAddOwnParams(*obj);
@@ -130,14 +223,26 @@ void ICP::align(
         // Matchings
         // ---------------------------------------
         MatchContext mc;
-        mc.icpIteration = state.currentIteration;
+        mc.icpIteration           = state.currentIteration;
+        mc.maxLocalPointsPerLayer = localPointsLimit;
 
         mrpt::system::CTimeLoggerEntry tle4(profiler_, "align.3.1_matchers");
+        const auto tMatchers = steady_clock::now();
+
+        // No need to reset it in the first iteration: done in its ctor.
+        if (state.currentIteration != 0) state.matchState.initialize();
+
+        // Pairings used to compute the current solution, restored if there
+        // is no time left to run the solvers on the new ones:
+        Pairings prevPairings;
+        if (p.maxTimeSeconds > 0)
+            prevPairings = std::move(state.currentPairings);
 
         state.currentPairings = run_matchers(
             matchers_, state.pcGlobal, state.pcLocal,
-            state.currentSolution.optimalPose, mc);
+            state.currentSolution.optimalPose, mc, state.matchState);
 
+        lambdaUpdateAverage(avrMatchersTime, lambdaElapsed(tMatchers));
         tle4.stop();
 
         if (state.currentPairings.empty())
@@ -154,7 +259,26 @@ void ICP::align(
 
         // Optimal relative pose:
         // ---------------------------------------
+        // Time budget: no time left to run the solvers? Keep the solution
+        // of the former iteration, and the pairings it was computed from, so
+        // the final quality and covariance are consistent with it:
+        if (p.maxTimeSeconds > 0 && avrSolversTime &&
+            p.deadlineSafetyFactor * *avrSolversTime >
+                p.maxTimeSeconds - lambdaElapsed(tStart))
+        {
+            state.currentPairings    = std::move(prevPairings);
+            result.terminationReason = IterTermReason::Deadline;
+            if (p.debugPrintIterationProgress)
+            {
+                printf(
+                    "[ICP] Iter=%3u Deadline: no time left for solvers.\n",
+                    static_cast<unsigned int>(state.currentIteration));
+            }
+            break;
+        }
+
         mrpt::system::CTimeLoggerEntry tle5(profiler_, "align.3.2_solvers");
+        const auto tSolvers = steady_clock::now();
 
         sc.icpIteration = state.currentIteration;
         sc.guessRelativePose.emplace(state.currentSolution.optimalPose);
@@ -166,6 +290,7 @@ void ICP::align(
         const bool solvedOk = run_solvers(
             solvers_, state.currentPairings, state.currentSolution, sc);
 
+        lambdaUpdateAverage(avrSolversTime, lambdaElapsed(tSolvers));
         tle5.stop();
 
         if (!solvedOk)
@@ -221,17 +346,44 @@ void ICP::align(
                 std::abs(delta_xyz), mrpt::RAD2DEG(std::abs(delta_rot)),
                 state.currentSolution.optimalPose.asString().c_str(),
                 state.currentPairings.contents_summary().c_str());
+
+            // Telemetry from iterative solvers:
+            const auto& sol = state.currentSolution;
+            if (!sol.iterations.empty() && sol.hessianEigenvalues)
+            {
+                printf(
+                    "[ICP] Iter=%3u solver: %zu inner iters, cost=%.03e, "
+                    "eig(H)=[%.02e ... %.02e]\n",
+                    static_cast<unsigned int>(state.currentIteration),
+                    sol.iterations.size(), sol.iterations.back().cost,
+                    (*sol.hessianEigenvalues)[0], (*sol.hessianEigenvalues)[5]);
+            }
         }
 
         const bool stalled =
             (std::abs(delta_xyz) < p.minAbsStep_trans &&
              std::abs(delta_rot) < p.minAbsStep_rot);
 
+        // Degeneracy: has the solution only moved along poorly-constrained
+        // directions? (Only if the solver performs degeneracy analysis)
+        bool degenerate = false;
+        if (const auto& P = state.currentSolution.wellConstrainedProjector;
+            !stalled && P.has_value())
+        {
+            const mrpt::math::CVectorFixed<double, 6> dSol =
+                mrpt::poses::Lie::SE<3>::log(deltaSol);
+            const Eigen::Matrix<double, 6, 1> dWell =
+                P->asEigen() * dSol.asEigen();
+
+            degenerate = dWell.head<3>().norm() < p.minAbsStep_trans &&
+                         dWell.tail<3>().norm() < p.minAbsStep_rot;
+        }
+
         // store partial solutions for logging/debuging?
         if (p.saveIterationDetails &&
             (p.decimationIterationDetails == 0 ||
              state.currentIteration % p.decimationIterationDetails == 0 ||
-             stalled))
+             stalled || degenerate))
         {
             if (!currentLog->iterationsDetails.has_value())
                 currentLog->iterationsDetails.emplace();
@@ -256,6 +408,19 @@ void ICP::align(
 
             break;
         }
+        if (degenerate)
+        {
+            result.terminationReason = IterTermReason::Degenerate;
+
+            if (p.debugPrintIterationProgress)
+            {
+                printf(
+                    "[ICP] Iter=%3u Only degenerate directions still move.\n",
+                    static_cast<unsigned int>(state.currentIteration));
+            }
+
+            break;
+        }
 
         // Quality checkpoints to abort ICP iterations as useless?
         if (auto itQ = p.quality_checkpoints.find(state.currentIteration);
@@ -334,6 +499,13 @@ void ICP::align(
     result.optimalScale    = state.currentSolution.optimalScale;
     result.finalPairings   = std::move(state.currentPairings);
 
+    if (const auto& P = state.currentSolution.wellConstrainedProjector;
+        P.has_value())
+    {
+        auto& o = result.observability.emplace();
+        for (int i = 0; i < 6; i++) o[i] = (*P)(i, i);
+    }
+
     // Covariance:
     mp2p_icp::CovarianceParameters covParams;
 
@@ -408,6 +580,50 @@ void ICP::save_log_file(const LogRecord& log, const Parameters& p)
             return;  // skip due to decimation
     }
 
+    // All records into one single archive file?
+    if (!p.debugArchiveFile.empty())
+    {
+        // One writer per archive file, kept open until the program exits:
+        static std::map<std::string, std::shared_ptr<LogArchiveWriter>>
+                          archives;
+        static std::mutex archivesMtx;
+
+        std::shared_ptr<LogArchiveWriter> archive;
+        {
+            auto lck = mrpt::lockHelper(archivesMtx);
+
+            auto& a = archives[p.debugArchiveFile];
+            if (!a)
+            {
+                a = std::make_shared<LogArchiveWriter>();
+                try
+                {
+                    a->open(p.debugArchiveFile);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "[ICP::save_log_file] Could not open icp log "
+                                 "archive: "
+                              << e.what() << std::endl;
+                }
+            }
+            archive = a;
+        }
+        if (!archive->is_open()) return;
+
+        try
+        {
+            archive->append(log);  // thread-safe
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "[ICP::save_log_file] Could not append to icp log "
+                         "archive '"
+                      << p.debugArchiveFile << "': " << e.what() << std::endl;
+        }
+        return;
+    }
+
     std::string filename = p.debugFileNameFormat;
 
     {
@@ -0,0 +1,163 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ICP_BatchRunner.cpp
+ * @brief  Runs many independent ICP alignments in parallel
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/ICP_BatchRunner.h>
+#include <mp2p_icp/icp_pipeline_from_yaml.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/lock_helper.h>
+
+#include <algorithm>
+#include <exception>
+#include <set>
+#include <thread>
+
+using namespace mp2p_icp;
+
+ICP_BatchRunner::ICP_BatchRunner(
+    const mrpt::containers::yaml& icpPipelineConfig, std::size_t numThreads)
+{
+    MRPT_START
+
+    if (numThreads == 0)
+        numThreads = std::max(1U, std::thread::hardware_concurrency());
+
+    // Parse the YAML pipeline once per worker, at construction time only:
+    pool_.resize(numThreads);
+    for (auto& icp : pool_)
+    {
+        auto [newIcp, params] = icp_pipeline_from_yaml(icpPipelineConfig);
+        icp                   = newIcp;
+        icpParams_            = params;
+    }
+
+    MRPT_END
+}
+
+ICP_BatchRunner::~ICP_BatchRunner() = default;
+
+void ICP_BatchRunner::prepare_for_concurrent_queries(const metric_map_t& m)
+{
+    for (const auto& [name, layer] : m.layers)
+    {
+        ASSERT_(layer);
+
+        // This caches the point cloud of voxel maps, if applicable, and
+        // the (also lazily cached) bounding box used by matchers:
+        if (const auto* pts = mp2p_icp::MapToPointsMap(*layer); pts)
+            pts->boundingBox();
+
+        // Build KD-trees, etc. from this single thread:
+        if (const auto* nn = mp2p_icp::MapToNN(*layer, false /*dont throw*/);
+            nn)
+        {
+            nn->nn_prepare_for_3d_queries();
+        }
+    }
+}
+
+std::vector<ICP_BatchRunner::JobResult> ICP_BatchRunner::run(
+    const std::vector<Job>&      jobs,
+    const std::optional<double>& stopOnQualityAbove)
+{
+    MRPT_START
+
+    auto lck = mrpt::lockHelper(runMtx_);
+
+    std::vector<JobResult> results(jobs.size());
+    if (jobs.empty()) return results;
+
+    // Prepare all distinct maps before any worker may query them:
+    std::set<const metric_map_t*> distinctMaps;
+    for (const auto& job : jobs)
+    {
+        ASSERT_(job.pcLocal && job.pcGlobal);
+        distinctMaps.insert(job.pcLocal.get());
+        distinctMaps.insert(job.pcGlobal.get());
+    }
+    for (const auto* m : distinctMaps) prepare_for_concurrent_queries(*m);
+
+    cancelRequested_ = false;
+
+    std::atomic_size_t nextJob{0};
+    std::exception_ptr firstError;
+    std::mutex         errorMtx;
+
+    const auto lambdaWorker = [&](ICP& icp)
+    {
+        for (;;)
+        {
+            if (cancelRequested_) return;
+
+            const std::size_t idx = nextJob++;
+            if (idx >= jobs.size()) return;
+
+            const auto& job = jobs[idx];
+            auto&       out = results[idx];
+
+            try
+            {
+                icp.align(
+                    *job.pcLocal, *job.pcGlobal, job.initialGuessLocalWrtGlobal,
+                    icpParams_, out.result, job.prior);
+                out.executed = true;
+            }
+            catch (...)
+            {
+                auto lckErr = mrpt::lockHelper(errorMtx);
+                if (!firstError) firstError = std::current_exception();
+                cancelRequested_ = true;
+                return;
+            }
+
+            if (stopOnQualityAbove.has_value() &&
+                out.result.quality >= *stopOnQualityAbove)
+            {
+                cancelRequested_ = true;
+            }
+        }
+    };
+
+    const std::size_t nWorkers = std::min(pool_.size(), jobs.size());
+
+    // Early cancellation from other workers, chained after any iteration
+    // hook the user may have installed in the pipelines:
+    std::vector<ICP::iteration_hook_t> userHooks(nWorkers);
+    for (std::size_t i = 0; i < nWorkers; i++)
+    {
+        userHooks[i] = pool_[i]->getIterationHook();
+        const auto& userHook = userHooks[i];
+        pool_[i]->setIterationHook(
+            [this, &userHook](const ICP::IterationHook_Input& hi)
+            {
+                ICP::IterationHook_Output ho;
+                if (userHook) ho = userHook(hi);
+                ho.request_stop = ho.request_stop || cancelRequested_.load();
+                return ho;
+            });
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(nWorkers);
+    for (std::size_t i = 0; i < nWorkers; i++)
+        threads.emplace_back(lambdaWorker, std::ref(*pool_[i]));
+
+    for (auto& t : threads) t.join();
+
+    for (std::size_t i = 0; i < nWorkers; i++)
+        pool_[i]->setIterationHook(userHooks[i]);
+
+    if (firstError) std::rethrow_exception(firstError);
+
+    return results;
+
+    MRPT_END
+}
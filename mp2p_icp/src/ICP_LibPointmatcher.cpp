@@ -14,15 +14,16 @@
 #include <mp2p_icp/Matcher_Points_DistanceThreshold.h>
 #include <mp2p_icp/covariance.h>
 #include <mrpt/core/exceptions.h>
+#include <mrpt/core/lock_helper.h>
 #include <mrpt/maps/CPointsMap.h>
 #include <mrpt/poses/Lie/SE.h>
 #include <mrpt/tfest/se3.h>
 
 #include <fstream>
+#include <mutex>
 #include <sstream>
 
 #if defined(MP2P_HAS_LIBPOINTMATCHER)
-#include <pointmatcher/IO.h>
 #include <pointmatcher/LoggerImpl.h>
 #include <pointmatcher/PointMatcher.h>
 #include <pointmatcher/TransformationsImpl.h>
@@ -41,26 +42,56 @@ bool ICP_LibPointmatcher::methodAvailable()
 #endif
 }
 
+struct ICP_LibPointmatcher::PmImpl
+{
+#if defined(MP2P_HAS_LIBPOINTMATCHER)
+    PointMatcher<double>::ICP icp;
+
+    /// PM::ICP holds state of the ongoing alignment
+    std::mutex icpMtx;
+#endif
+};
+
 #if defined(MP2P_HAS_LIBPOINTMATCHER)
 static PointMatcher<double>::DataPoints pointsToPM(const metric_map_t& pc)
 {
-    // TODO: Convert pointclouds in a more efficient way (!)
-    std::stringstream ss;
+    using DP = PointMatcher<double>::DataPoints;
 
+    std::vector<const mrpt::maps::CPointsMap*> ptLayers;
+    size_t                                     nPoints = 0;
     for (const auto& ly : pc.layers)
     {
-        // const std::string&                 name = ly.first;
         auto pts = mp2p_icp::MapToPointsMap(*ly.second);
         if (!pts) continue;  // Not a point cloud layer
+        ptLayers.push_back(pts);
+        nPoints += pts->size();
+    }
+
+    // Homogeneous coordinates, one column per point:
+    PointMatcher<double>::Matrix features(4, nPoints);
 
-        const auto xs = pts->getPointsBufferRef_x();
-        const auto ys = pts->getPointsBufferRef_y();
-        const auto zs = pts->getPointsBufferRef_z();
-        for (size_t i = 0; i < xs.size(); i++)
-            ss << mrpt::format("%f %f %f\n", xs[i], ys[i], zs[i]);
+    size_t col = 0;
+    for (const auto* pts : ptLayers)
+    {
+        const auto& xs = pts->getPointsBufferRef_x();
+        const auto& ys = pts->getPointsBufferRef_y();
+        const auto& zs = pts->getPointsBufferRef_z();
+        for (size_t i = 0; i < xs.size(); i++, col++)
+        {
+            features(0, col) = xs[i];
+            features(1, col) = ys[i];
+            features(2, col) = zs[i];
+            features(3, col) = 1.0;
+        }
     }
-    ss.seekg(0);
-    return PointMatcherIO<double>::loadCSV(ss);
+
+    DP::Labels labels;
+    labels.push_back(DP::Label("x", 1));
+    labels.push_back(DP::Label("y", 1));
+    labels.push_back(DP::Label("z", 1));
+    labels.push_back(DP::Label("pad", 1));
+
+    return DP(features, labels);
 }
 #endif
 
@@ -70,6 +101,13 @@ void ICP_LibPointmatcher::initialize_derived(
     std::stringstream ss;
     params.printAsYAML(ss);
     pm_icp_yaml_settings_ = ss.str();
+
+    pm_ = std::make_shared<PmImpl>();
+#if defined(MP2P_HAS_LIBPOINTMATCHER)
+    // Parse the libpointmatcher configuration only once:
+    ss.seekg(0);
+    pm_->icp.loadFromYaml(ss);
+#endif
 }
 
 void ICP_LibPointmatcher::align(
@@ -90,7 +128,7 @@ void ICP_LibPointmatcher::align(
     ASSERT_(!pcLocal.empty() && !pcGlobal.empty());
 
     ASSERTMSG_(
-        !pm_icp_yaml_settings_.empty(),
+        pm_ && !pm_icp_yaml_settings_.empty(),
         "You must call initialize_derived() first, or initialize from a YAML "
         "file with a `derived` section with the LibPointMathcer-specific "
         "configuration.");
@@ -134,16 +172,9 @@ void ICP_LibPointmatcher::align(
     ASSERT_GT_(ptsLocal.getNbPoints(), 0);
     ASSERT_GT_(ptsGlobal.getNbPoints(), 0);
 
-    // Create the default ICP algorithm
-    PM::ICP icp;
-
-    {
-        // load YAML config
-        std::stringstream ss;
-        ss << pm_icp_yaml_settings_;
-        ss.seekg(0);
-        icp.loadFromYaml(ss);
-    }
+    // The ICP object, already built from the YAML config:
+    auto     lck = mrpt::lockHelper(pm_->icpMtx);
+    PM::ICP& icp = pm_->icp;
 
     int cloudDimension = ptsLocal.getEuclideanDim();
     ASSERT_EQUAL_(cloudDimension, 3U);
@@ -0,0 +1,463 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   LogArchive.cpp
+ * @brief  Single-file, append-only archive of ICP log records
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/LogArchive.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/io/zip.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/serialization/optional_serialization.h>
+#include <mrpt/system/filesystem.h>
+
+#include <algorithm>
+#include <filesystem>
+
+using namespace mp2p_icp;
+
+/* File format:
+ *  - Header: "MP2PLOGA" (8 bytes), format version (uint32).
+ *  - A sequence of chunks, each one:
+ *    - type (uint8): CHUNK_MAP or CHUNK_RECORD
+ *    - payload length (uint64)
+ *    - payload:
+ *      - CHUNK_MAP: content hash (uint64), GZIP(metric_map_t)
+ *      - CHUNK_RECORD: info length (uint32), LogArchiveRecordInfo,
+ *                      GZIP(LogRecord without maps)
+ */
+namespace
+{
+constexpr char     ARCHIVE_MAGIC[8]       = {'M', 'P', '2', 'P',
+                                             'L', 'O', 'G', 'A'};
+constexpr uint32_t ARCHIVE_VERSION        = 0;
+constexpr uint8_t  CHUNK_MAP              = 'M';
+constexpr uint8_t  CHUNK_RECORD           = 'R';
+constexpr uint64_t CHUNK_HEADER_SIZE      = 1 + 8;
+constexpr uint8_t  RECORD_INFO_VERSION    = 0;
+constexpr int      ARCHIVE_GZ_COMPRESSION = 1;
+
+std::vector<uint8_t> toBytes(const mrpt::io::CMemoryStream& buf)
+{
+    const auto* data =
+        reinterpret_cast<const uint8_t*>(buf.getRawBufferData());
+    return std::vector<uint8_t>(data, data + buf.getTotalBytesCount());
+}
+
+std::vector<uint8_t> serializeObject(const mrpt::serialization::CSerializable& o)
+{
+    mrpt::io::CMemoryStream buf;
+    auto                    arch = mrpt::serialization::archiveFrom(buf);
+    arch << o;
+    return toBytes(buf);
+}
+
+// FNV-1a, 64 bit
+uint64_t contentHash(const std::vector<uint8_t>& data)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const uint8_t b : data)
+    {
+        h ^= b;
+        h *= 0x100000001b3ULL;
+    }
+    return h == 0 ? 1 : h;  // 0 is reserved for "no map"
+}
+
+std::vector<uint8_t> compress(const std::vector<uint8_t>& in)
+{
+    std::vector<uint8_t> out;
+    mrpt::io::zip::compress_gz_data_block(in, out, ARCHIVE_GZ_COMPRESSION);
+    return out;
+}
+
+std::vector<uint8_t> decompress(const uint8_t* data, std::size_t len)
+{
+    const std::vector<uint8_t> in(data, data + len);
+    std::vector<uint8_t>       out;
+    const bool ok = mrpt::io::zip::decompress_gz_data_block(in, out);
+    ASSERTMSG_(ok, "Error decompressing log archive chunk (corrupted file?)");
+    return out;
+}
+
+void writeChunk(
+    mrpt::io::CStream& f, uint8_t type, const mrpt::io::CMemoryStream& payload)
+{
+    auto arch = mrpt::serialization::archiveFrom(f);
+    arch.WriteAs<uint8_t>(type);
+    arch.WriteAs<uint64_t>(payload.getTotalBytesCount());
+    f.Write(payload.getRawBufferData(), payload.getTotalBytesCount());
+}
+
+void writeInfo(
+    mrpt::serialization::CArchive& out, const LogArchiveRecordInfo& info)
+{
+    out.WriteAs<uint8_t>(RECORD_INFO_VERSION);
+    out.WriteAs<uint8_t>(static_cast<uint8_t>(info.terminationReason));
+    out << info.quality << info.nIterations << info.optimalPose;
+    out << info.globalId << info.localId << info.globalLabel
+        << info.localLabel;
+    out << info.globalMapHash << info.localMapHash;
+}
+
+void readInfo(mrpt::serialization::CArchive& in, LogArchiveRecordInfo& info)
+{
+    const auto version = in.ReadAs<uint8_t>();
+    switch (version)
+    {
+        case 0:
+        {
+            info.terminationReason =
+                static_cast<IterTermReason>(in.ReadAs<uint8_t>());
+            in >> info.quality >> info.nIterations >> info.optimalPose;
+            in >> info.globalId >> info.localId >> info.globalLabel >>
+                info.localLabel;
+            in >> info.globalMapHash >> info.localMapHash;
+        }
+        break;
+        default:
+            THROW_EXCEPTION_FMT(
+                "Unknown log archive record version: %u",
+                static_cast<unsigned int>(version));
+    };
+}
+
+}  // namespace
+
+// ----------------------------------------------------------------------------
+// LogArchiveWriter
+// ----------------------------------------------------------------------------
+
+void LogArchiveWriter::open(const std::string& fileName)
+{
+    MRPT_START
+
+    auto lck = mrpt::lockHelper(mtx_);
+
+    if (f_.is_open()) f_.close();
+    storedMaps_.clear();
+    recordCount_ = 0;
+
+    const bool exists = mrpt::system::fileExists(fileName) &&
+                        mrpt::system::getFileSize(fileName) > 0;
+
+    if (exists)
+    {
+        // Index the existing contents:
+        uint64_t validSize = 0;
+        {
+            LogArchiveReader reader;
+            reader.open(fileName);
+
+            for (const auto& r : reader.records())
+            {
+                // Maps are always stored before the first record using them:
+                if (r.globalMapHash) storedMaps_.insert(r.globalMapHash);
+                if (r.localMapHash) storedMaps_.insert(r.localMapHash);
+            }
+            recordCount_ = reader.size();
+            validSize    = reader.valid_size();
+        }
+
+        // Drop a trailing incomplete chunk:
+        if (validSize < mrpt::system::getFileSize(fileName))
+            std::filesystem::resize_file(fileName, validSize);
+
+        if (!f_.open(fileName, mrpt::io::OpenMode::APPEND))
+            THROW_EXCEPTION_FMT(
+                "Cannot open log archive for writing: '%s'", fileName.c_str());
+    }
+    else
+    {
+        if (!f_.open(fileName, mrpt::io::OpenMode::TRUNCATE))
+            THROW_EXCEPTION_FMT(
+                "Cannot create log archive: '%s'", fileName.c_str());
+
+        f_.Write(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+        auto arch = mrpt::serialization::archiveFrom(f_);
+        arch.WriteAs<uint32_t>(ARCHIVE_VERSION);
+    }
+
+    MRPT_END
+}
+
+void LogArchiveWriter::close()
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    if (f_.is_open()) f_.close();
+}
+
+uint64_t LogArchiveWriter::store_map(const metric_map_t& m)
+{
+    const auto     data = serializeObject(m);
+    const uint64_t hash = contentHash(data);
+
+    if (storedMaps_.count(hash) != 0) return hash;  // Already there
+
+    mrpt::io::CMemoryStream payload;
+    auto                    arch = mrpt::serialization::archiveFrom(payload);
+    arch.WriteAs<uint64_t>(hash);
+
+    const auto gz = compress(data);
+    payload.Write(gz.data(), gz.size());
+
+    writeChunk(f_, CHUNK_MAP, payload);
+    storedMaps_.insert(hash);
+
+    return hash;
+}
+
+void LogArchiveWriter::append(const LogRecord& record)
+{
+    MRPT_START
+
+    auto lck = mrpt::lockHelper(mtx_);
+
+    ASSERTMSG_(f_.is_open(), "open() must be called first");
+
+    LogArchiveRecordInfo info;
+    info.terminationReason = record.icpResult.terminationReason;
+    info.quality           = record.icpResult.quality;
+    info.nIterations       = record.icpResult.nIterations;
+    info.optimalPose       = record.icpResult.optimal_tf.mean.asTPose();
+
+    if (record.pcGlobal)
+    {
+        info.globalId      = record.pcGlobal->id;
+        info.globalLabel   = record.pcGlobal->label;
+        info.globalMapHash = store_map(*record.pcGlobal);
+    }
+    if (record.pcLocal)
+    {
+        info.localId      = record.pcLocal->id;
+        info.localLabel   = record.pcLocal->label;
+        info.localMapHash = store_map(*record.pcLocal);
+    }
+
+    // The record itself, without the maps (a shallow copy):
+    LogRecord body = record;
+    body.pcGlobal.reset();
+    body.pcLocal.reset();
+
+    mrpt::io::CMemoryStream infoBuf;
+    {
+        auto arch = mrpt::serialization::archiveFrom(infoBuf);
+        writeInfo(arch, info);
+    }
+
+    mrpt::io::CMemoryStream payload;
+    auto                    arch = mrpt::serialization::archiveFrom(payload);
+    arch.WriteAs<uint32_t>(static_cast<uint32_t>(infoBuf.getTotalBytesCount()));
+    payload.Write(infoBuf.getRawBufferData(), infoBuf.getTotalBytesCount());
+
+    const auto gz = compress(serializeObject(body));
+    payload.Write(gz.data(), gz.size());
+
+    writeChunk(f_, CHUNK_RECORD, payload);
+    recordCount_++;
+
+    MRPT_END
+}
+
+// ----------------------------------------------------------------------------
+// LogArchiveReader
+// ----------------------------------------------------------------------------
+
+void LogArchiveReader::open(const std::string& fileName)
+{
+    MRPT_START
+
+    auto lck = mrpt::lockHelper(mtx_);
+
+    records_.clear();
+    mapOffsets_.clear();
+    mapCache_.clear();
+    validSize_ = 0;
+
+    if (f_.is_open()) f_.close();
+    if (!f_.open(fileName))
+        THROW_EXCEPTION_FMT(
+            "Cannot open log archive for reading: '%s'", fileName.c_str());
+
+    const uint64_t fileSize = f_.getTotalBytesCount();
+
+    char magic[sizeof(ARCHIVE_MAGIC)];
+    if (f_.Read(magic, sizeof(magic)) != sizeof(magic) ||
+        !std::equal(magic, magic + sizeof(magic), ARCHIVE_MAGIC))
+        THROW_EXCEPTION_FMT(
+            "Not a mp2p_icp log archive: '%s'", fileName.c_str());
+
+    auto arch = mrpt::serialization::archiveFrom(f_);
+
+    const auto version = arch.ReadAs<uint32_t>();
+    ASSERT_EQUAL_(version, ARCHIVE_VERSION);
+
+    uint64_t pos = f_.getPosition();
+    validSize_   = pos;
+
+    // Read chunk headers, skipping their (compressed) contents:
+    while (pos + CHUNK_HEADER_SIZE <= fileSize)
+    {
+        const auto type       = arch.ReadAs<uint8_t>();
+        const auto payloadLen = arch.ReadAs<uint64_t>();
+
+        const uint64_t chunkEnd = pos + CHUNK_HEADER_SIZE + payloadLen;
+        if (chunkEnd > fileSize) break;  // Incomplete chunk
+
+        if (type == CHUNK_MAP)
+        {
+            const auto hash  = arch.ReadAs<uint64_t>();
+            mapOffsets_[hash] = pos;
+        }
+        else if (type == CHUNK_RECORD)
+        {
+            const auto infoLen = arch.ReadAs<uint32_t>();
+
+            std::vector<uint8_t> infoData(infoLen);
+            if (f_.Read(infoData.data(), infoLen) != infoLen) break;
+
+            mrpt::io::CMemoryStream infoBuf;
+            infoBuf.assignMemoryNotOwn(infoData.data(), infoData.size());
+            auto infoArch = mrpt::serialization::archiveFrom(infoBuf);
+
+            auto& info = records_.emplace_back();
+            readInfo(infoArch, info);
+            info.fileOffset = pos;
+        }
+        else
+        {
+            THROW_EXCEPTION_FMT(
+                "Unknown chunk type %u at offset %lu in log archive '%s'",
+                static_cast<unsigned int>(type),
+                static_cast<unsigned long>(pos), fileName.c_str());
+        }
+
+        pos = chunkEnd;
+        f_.Seek(static_cast<int64_t>(pos));
+        validSize_ = pos;
+    }
+
+    MRPT_END
+}
+
+std::vector<std::size_t> LogArchiveReader::filter(
+    const std::function<bool(const LogArchiveRecordInfo&)>& predicate) const
+{
+    std::vector<std::size_t> idxs;
+    for (std::size_t i = 0; i < records_.size(); i++)
+        if (predicate(records_[i])) idxs.push_back(i);
+    return idxs;
+}
+
+std::vector<uint8_t> LogArchiveReader::read_chunk_payload(
+    uint64_t fileOffset, uint8_t expectedType) const
+{
+    f_.Seek(static_cast<int64_t>(fileOffset));
+
+    auto       arch       = mrpt::serialization::archiveFrom(f_);
+    const auto type       = arch.ReadAs<uint8_t>();
+    const auto payloadLen = arch.ReadAs<uint64_t>();
+    ASSERT_EQUAL_(type, expectedType);
+
+    std::vector<uint8_t> payload(payloadLen);
+    ASSERT_EQUAL_(f_.Read(payload.data(), payload.size()), payload.size());
+
+    return payload;
+}
+
+LogRecord LogArchiveReader::load(std::size_t index, bool loadMaps) const
+{
+    MRPT_START
+
+    auto lck = mrpt::lockHelper(mtx_);
+
+    ASSERT_LT_(index, records_.size());
+    const auto& info = records_[index];
+
+    const auto payload = read_chunk_payload(info.fileOffset, CHUNK_RECORD);
+
+    // Skip the info header:
+    ASSERT_GE_(payload.size(), 4U);
+    mrpt::io::CMemoryStream hdrBuf;
+    hdrBuf.assignMemoryNotOwn(payload.data(), payload.size());
+    const auto infoLen =
+        mrpt::serialization::archiveFrom(hdrBuf).ReadAs<uint32_t>();
+    const std::size_t bodyStart = 4 + infoLen;
+    ASSERT_LE_(bodyStart, payload.size());
+
+    const auto body =
+        decompress(payload.data() + bodyStart, payload.size() - bodyStart);
+
+    LogRecord               lr;
+    mrpt::io::CMemoryStream bodyBuf;
+    bodyBuf.assignMemoryNotOwn(body.data(), body.size());
+    mrpt::serialization::archiveFrom(bodyBuf) >> lr;
+
+    if (loadMaps)
+    {
+        if (info.globalMapHash)
+            lr.pcGlobal = load_map_already_locked(info.globalMapHash);
+        if (info.localMapHash)
+            lr.pcLocal = load_map_already_locked(info.localMapHash);
+    }
+
+    return lr;
+
+    MRPT_END
+}
+
+metric_map_t::ConstPtr LogArchiveReader::load_map(uint64_t hash) const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    return load_map_already_locked(hash);
+}
+
+metric_map_t::ConstPtr LogArchiveReader::load_map_already_locked(
+    uint64_t hash) const
+{
+    MRPT_START
+
+    // In the cache?
+    for (auto it = mapCache_.begin(); it != mapCache_.end(); ++it)
+    {
+        if (it->first != hash) continue;
+
+        // Move to the front (most recently used):
+        auto entry = *it;
+        mapCache_.erase(it);
+        mapCache_.push_front(entry);
+        return entry.second;
+    }
+
+    const auto itOff = mapOffsets_.find(hash);
+    if (itOff == mapOffsets_.end())
+        THROW_EXCEPTION_FMT(
+            "Map with hash %016lx not found in log archive",
+            static_cast<unsigned long>(hash));
+
+    const auto payload = read_chunk_payload(itOff->second, CHUNK_MAP);
+    ASSERT_GE_(payload.size(), 8U);
+
+    const auto data = decompress(payload.data() + 8, payload.size() - 8);
+
+    auto                    m = metric_map_t::Create();
+    mrpt::io::CMemoryStream buf;
+    buf.assignMemoryNotOwn(data.data(), data.size());
+    mrpt::serialization::archiveFrom(buf) >> *m;
+
+    mapCache_.emplace_front(hash, m);
+    while (mapCache_.size() > std::max<std::size_t>(1, mapCacheSize))
+        mapCache_.pop_back();
+
+    return m;
+
+    MRPT_END
+}
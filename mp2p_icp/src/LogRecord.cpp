@@ -4,9 +4,9 @@
  * See LICENSE for license information.
  * ------------------------------------------------------------------------- */
 
+#include <mp2p_icp/BlockGZOutputStream.h>
 #include <mp2p_icp/LogRecord.h>
 #include <mrpt/io/CFileGZInputStream.h>
-#include <mrpt/io/CFileGZOutputStream.h>
 #include <mrpt/serialization/CArchive.h>
 #include <mrpt/serialization/optional_serialization.h>
 #include <mrpt/serialization/stl_serialization.h>
@@ -76,11 +76,12 @@ bool LogRecord::save_to_file(const std::string& fileName) const
 {
     try
     {
-        auto f = mrpt::io::CFileGZOutputStream(fileName);
-        if (!f.is_open()) return false;
+        BlockGZOutputStream f;
+        if (!f.open(fileName)) return false;
 
         auto arch = mrpt::serialization::archiveFrom(f);
         arch << *this;
+        f.close();
 
         return true;
     }
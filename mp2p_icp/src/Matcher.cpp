@@ -69,7 +69,7 @@ Pairings mp2p_icp::run_matchers(
         bool     hasRun =
             matcher->match(pcGlobal, pcLocal, local_wrt_global, mc, *ms, pc);
         anyRun = anyRun || hasRun;
-        pairings.push_back(pc);
+        pairings.push_back(std::move(pc));
     }
 
     if (!anyRun)
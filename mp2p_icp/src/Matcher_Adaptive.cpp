@@ -52,22 +52,24 @@ void Matcher_Adaptive::initialize(const mrpt::containers::yaml& params)
 void Matcher_Adaptive::implMatchOneLayer(
     const mrpt::maps::CMetricMap& pcGlobalMap,
     const mrpt::maps::CPointsMap& pcLocal,
-    const mrpt::poses::CPose3D& localPose, MatchState& ms,
-    const layer_name_t& globalName, const layer_name_t& localName,
-    Pairings& out) const
+    const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+    MatchState& ms, const layer_name_t& globalName,
+    const layer_name_t& localName, Pairings& out) const
 {
     MRPT_START
 
     const mrpt::maps::NearestNeighborsCapable& nnGlobal =
         *mp2p_icp::MapToNN(pcGlobalMap, true /*throw if cannot convert*/);
 
-    out.potential_pairings += pcLocal.size() * maxPt2PtCorrespondences;
+    out.potential_pairings +=
+        sampledLocalPointCount(pcLocal, mc) * maxPt2PtCorrespondences;
 
     // Empty maps?  Nothing to do
     if (pcGlobalMap.isEmpty() || pcLocal.empty()) return;
 
     const TransformedLocalPointCloud tl = transform_local_to_global(
-        pcLocal, localPose, maxLocalPointsPerLayer_, localPointsSampleSeed_);
+        pcLocal, localPose, effectiveMaxLocalPointsPerLayer(mc),
+        localPointsSampleSeed_);
 
     // Try to do matching only if the bounding boxes have some overlap:
     if (!pcGlobalMap.boundingBox().intersection(
@@ -261,9 +263,7 @@ void Matcher_Adaptive::implMatchOneLayer(
                     // OK, all conditions pass: add the new pairing:
                     auto& p    = out.paired_pt2pl.emplace_back();
                     p.pt_local = {lxs[localIdx], lys[localIdx], lzs[localIdx]};
-                    p.pl_global.centroid = planeCentroid;
-
-                    p.pl_global.plane = thePlane;
+                    p.set_plane(thePlane);
 
                     // Mark local point as already paired:
                     ms.localPairedBitField.point_layers[localName].mark_as_set(
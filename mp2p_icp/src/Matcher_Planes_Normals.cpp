@@ -5,97 +5,267 @@
  * ------------------------------------------------------------------------- */
 /**
  * @file   Matcher_Planes_Normals.cpp
- * @brief  Pointcloud matcher: similar planes
+ * @brief  Plane matcher: similar planes (centroid distance + normals)
  * @author Jose Luis Blanco Claraco
  * @date   June 25, 2020
  */
 
-// TODO
-
-// Parameter:
-/** Maximum angle (radians) between potential matching plane normals to be
- * accepted as a pairing. */
-// TODO: Move to a new plane-to-plane matcher
-// double thresholdPlane2PlaneNormalAng{mrpt::DEG2RAD(5.0)};
+#include <mp2p_icp/Matcher_Planes_Normals.h>
+#include <mrpt/core/exceptions.h>
 
-#if 0
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <optional>
 
-#include <mp2p_icp/Matcher_Planes_Normals.h>
+#if defined(MP2P_HAS_TBB)
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
 
-IMPLEMENTS_MRPT_OBJECT(Matcher_Points_DistanceThreshold, Matcher, mp2p_icp);
+IMPLEMENTS_MRPT_OBJECT(Matcher_Planes_Normals, Matcher, mp2p_icp)
 
 using namespace mp2p_icp;
 
-void f()
+namespace
+{
+uint8_t dominantAxis(const mrpt::math::TVector3D& n)
 {
-    // Plane-to-plane correspondence:
+    const double ax = std::abs(n.x), ay = std::abs(n.y), az = std::abs(n.z);
+    if (ax >= ay && ax >= az) return 0;
+    return ay >= az ? 1 : 2;
+}
+
+int32_t toCell(double v, double cellSize)
+{
+    return static_cast<int32_t>(std::floor(v / cellSize));
+}
 
-    // We have pairs of planes whose centroids are quite close.
-    // Check their normals too:
-    for (const auto& pair : mpl)
+// FNV-1a hash of the geometry of all planes. Much cheaper than rebuilding the
+// index, and detects any change, even for a modified map at the same address.
+uint64_t planesFingerprint(const metric_map_t& m)
+{
+    uint64_t   h          = 0xcbf29ce484222325ULL;
+    const auto lambdaHash = [&h](double v)
     {
-        // 1) Check fo pairing sanity:
-        ASSERTDEB_(pair.this_idx < pcs1.planes.size());
-        ASSERTDEB_(pair.other_idx < pcs2.planes.size());
+        uint64_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(bits));
+        for (int i = 0; i < 8; i++, bits >>= 8)
+            h = (h ^ (bits & 0xff)) * 0x100000001b3ULL;
+    };
 
-        const auto& p1 = s.pc1.planes[pair.this_idx];
-        const auto& p2 = s.pc2.planes[pair.other_idx];
+    for (const auto& p : m.planes)
+    {
+        lambdaHash(p.centroid.x);
+        lambdaHash(p.centroid.y);
+        lambdaHash(p.centroid.z);
+        for (const double c : p.plane.coefs) lambdaHash(c);
+    }
+    return h;
+}
+}  // namespace
 
-        const mrpt::math::TVector3D n1 = p1.plane.getNormalVector();
-        const mrpt::math::TVector3D n2 = p2.plane.getNormalVector();
+Matcher_Planes_Normals::Matcher_Planes_Normals()
+{
+    mrpt::system::COutputLogger::setLoggerName("Matcher_Planes_Normals");
+}
 
-        // dot product to find the angle between normals:
-        const double dp      = n1.x * n2.x + n1.y * n2.y + n1.z * n2.z;
-        const double n2n_ang = std::acos(dp);
+void Matcher_Planes_Normals::initialize(const mrpt::containers::yaml& params)
+{
+    Matcher::initialize(params);
 
-        // 2) append to list of plane pairs:
-        if (n2n_ang < p.thresholdPlane2PlaneNormalAng)
-        {
-            // Accept pairing:
-            pairings.paired_pl2pl.emplace_back(p1, p2);
-        }
+    DECLARE_PARAMETER_REQ(params, distanceThreshold);
+    DECLARE_PARAMETER_OPT(params, planeDistanceThreshold);
+    DECLARE_PARAMETER_OPT(params, normalsAngleThresholdDeg);
+
+    MCP_LOAD_OPT(params, emitPlaneToPlane);
+    MCP_LOAD_OPT(params, emitPointToPlane);
+    MCP_LOAD_OPT(params, allowMatchAlreadyMatchedPlanes);
+}
+
+uint64_t Matcher_Planes_Normals::PlaneIndex::key(
+    int32_t cx, int32_t cy, int32_t cz, uint8_t axis)
+{
+    return (static_cast<uint64_t>(cx & 0xfffff) << 42) |
+           (static_cast<uint64_t>(cy & 0xfffff) << 22) |
+           (static_cast<uint64_t>(cz & 0xfffff) << 2) |
+           static_cast<uint64_t>(axis & 0x3);
+}
+
+void Matcher_Planes_Normals::build_index(
+    const metric_map_t& pcGlobal, uint64_t fingerprint) const
+{
+    index_.fingerprint = fingerprint;
+    index_.nPlanes     = pcGlobal.planes.size();
+    index_.cellSize    = distanceThreshold;
+    index_.cells.clear();
+
+    for (std::size_t i = 0; i < pcGlobal.planes.size(); i++)
+    {
+        const auto& p = pcGlobal.planes[i];
+        const auto  k = PlaneIndex::key(
+             toCell(p.centroid.x, index_.cellSize),
+             toCell(p.centroid.y, index_.cellSize),
+             toCell(p.centroid.z, index_.cellSize),
+             dominantAxis(p.plane.getUnitaryNormalVector()));
+        index_.cells[k].push_back(static_cast<uint32_t>(i));
     }
 }
 
-void f2()
+bool Matcher_Planes_Normals::impl_match(
+    const metric_map_t& pcGlobal, const metric_map_t& pcLocal,
+    const mrpt::poses::CPose3D&          localPose,
+    [[maybe_unused]] const MatchContext& mc, MatchState& ms,
+    Pairings& out) const
 {
-    // point-to-planes
-    if (!p.pt2pl_layer.empty())
+    MRPT_START
+
+    checkAllParametersAreRealized();
+
+    ASSERT_GT_(distanceThreshold, .0);
+    ASSERT_GE_(planeDistanceThreshold, .0);
+    ASSERT_GE_(normalsAngleThresholdDeg, .0);
+
+    out = Pairings();
+
+    const std::size_t nLocal = pcLocal.planes.size();
+    out.potential_pairings += nLocal;
+
+    if (nLocal == 0 || pcGlobal.planes.empty()) return true;
+
+    // (Re)build the index only if the global planes or the cell size changed:
+    const uint64_t fingerprint = planesFingerprint(pcGlobal);
+    if (index_.fingerprint != fingerprint ||
+        index_.nPlanes != pcGlobal.planes.size() ||
+        index_.cellSize != distanceThreshold)
+    {
+        build_index(pcGlobal, fingerprint);
+    }
+
+    const double angTh  = mrpt::DEG2RAD(normalsAngleThresholdDeg);
+    const double cosTh  = std::cos(angTh);
+    const double cellSz = index_.cellSize;
+    const auto&  R      = localPose.getRotationMatrix();
+
+    struct Match
+    {
+        uint32_t globalIdx = 0;
+        bool     flip      = false;
+    };
+    std::vector<std::optional<Match>> matches(nLocal);
+
+    const auto lambdaMatchPlane = [&](std::size_t j)
     {
-        const auto &m1 = s.pc1.point_layers.at("plane_centroids"),
-                   &m2 = s.pc2.point_layers.at(p.pt2pl_layer);
-        ASSERT_(m1);
-        ASSERT_(m2);
-
-        auto& mp = s.mps.at(p.pt2pl_layer);
-        // Measure angle distances from the current estimate:
-        mp.angularDistPivotPoint =
-            mrpt::math::TPoint3D(s.currentSolutionasTPose());
-
-        // Find closest pairings
-        mrpt::tfest::TMatchingPairList mpl;
-        m1->determineMatching3D(
-            m2.get(), s.currentSolution mpl, mp, s.mres[p.pt2pl_layer]);
-        // Plane-to-plane correspondence:
-
-        // We have pairs of planes whose centroids are quite close.
-        // Check their normals too:
-        for (const auto& pair : mpl)
+        if (!allowMatchAlreadyMatchedPlanes && ms.localPairedBitField.planes[j])
+            return;
+
+        const auto& lp = pcLocal.planes[j];
+
+        // Local plane, in the global frame:
+        const mrpt::math::TPoint3D  c  = localPose.composePoint(lp.centroid);
+        const mrpt::math::TVector3D ln = lp.plane.getUnitaryNormalVector();
+        const mrpt::math::TVector3D n(
+            R(0, 0) * ln.x + R(0, 1) * ln.y + R(0, 2) * ln.z,
+            R(1, 0) * ln.x + R(1, 1) * ln.y + R(1, 2) * ln.z,
+            R(2, 0) * ln.x + R(2, 1) * ln.y + R(2, 2) * ln.z);
+
+        // Dominant axes a global normal within tolerance may have: each
+        // component can differ at most by ~angTh (up to sign).
+        const double comps[3] = {std::abs(n.x), std::abs(n.y), std::abs(n.z)};
+        const double maxComp  = std::max({comps[0], comps[1], comps[2]});
+
+        const int32_t cx = toCell(c.x, cellSz), cy = toCell(c.y, cellSz),
+                      cz = toCell(c.z, cellSz);
+
+        std::optional<Match> best;
+        double               bestDist = distanceThreshold;
+
+        for (uint8_t axis = 0; axis < 3; axis++)
         {
-            // 1) Check fo pairing sanity:
-            ASSERTDEB_(pair.this_idx < pcs1.planes.size());
-            ASSERTDEB_(pair.other_idx < m2->size());
+            if (comps[axis] + 2 * angTh < maxComp) continue;
+
+            for (int32_t dx = -1; dx <= 1; dx++)
+                for (int32_t dy = -1; dy <= 1; dy++)
+                    for (int32_t dz = -1; dz <= 1; dz++)
+                    {
+                        const auto it = index_.cells.find(
+                            PlaneIndex::key(cx + dx, cy + dy, cz + dz, axis));
+                        if (it == index_.cells.end()) continue;
+
+                        for (const uint32_t gi : it->second)
+                        {
+                            // Skip if already paired, in another matcher up
+                            // the pipeline, for example:
+                            if (!allowMatchAlreadyMatchedPlanes &&
+                                ms.globalPairedBitField.planes[gi])
+                                continue;
 
-            const auto&           pl_this = s.pc1.planes[pair.this_idx];
-            mrpt::math::TPoint3Df pt_other;
-            m2->getPoint(pair.other_idx, pt_other.x, pt_other.y, pt_other.z);
+                            const auto& gp = pcGlobal.planes[gi];
 
-            // 2) append to list of plane pairs:
-            // Accept pairing:
-            pairings.paired_pt2pl.emplace_back(pl_this, pt_other);
+                            const auto   gn  = gp.plane.getUnitaryNormalVector();
+                            const double dot = gn.x * n.x + gn.y * n.y +
+                                               gn.z * n.z;
+                            if (std::abs(dot) < cosTh) continue;
+
+                            const double d = (gp.centroid - c).norm();
+                            if (d > bestDist) continue;
+
+                            if (gp.plane.distance(c) > planeDistanceThreshold)
+                                continue;
+
+                            bestDist = d;
+                            best     = Match{gi, dot < 0};
+                        }
+                    }
         }
-    }
-    out.potential_pairings += pcLocal.size() * maxPt2PtCorrespondences;
-}
 
+        matches[j] = best;
+    };
+
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, nLocal),
+        [&](const tbb::blocked_range<std::size_t>& r)
+        {
+            for (std::size_t j = r.begin(); j < r.end(); j++)
+                lambdaMatchPlane(j);
+        });
+#else
+    for (std::size_t j = 0; j < nLocal; j++) lambdaMatchPlane(j);
 #endif
+
+    // Ordered, single-threaded merge. Global planes paired more than once are
+    // only kept for the first local plane:
+    for (std::size_t j = 0; j < nLocal; j++)
+    {
+        if (!matches[j]) continue;
+
+        const uint32_t gi = matches[j]->globalIdx;
+        if (!allowMatchAlreadyMatchedPlanes &&
+            ms.globalPairedBitField.planes[gi])
+            continue;
+
+        const auto& gp = pcGlobal.planes[gi];
+        auto        lp = pcLocal.planes[j];
+
+        if (matches[j]->flip)
+        {
+            // Same plane, opposite normal:
+            for (auto& coef : lp.plane.coefs) coef = -coef;
+        }
+
+        if (emitPlaneToPlane) out.paired_pl2pl.emplace_back(gp, lp);
+        if (emitPointToPlane)
+        {
+            out.paired_pt2pl.emplace_back(
+                gp, mrpt::math::TPoint3Df(
+                        lp.centroid.x, lp.centroid.y, lp.centroid.z));
+        }
+
+        ms.localPairedBitField.planes[j]   = true;
+        ms.globalPairedBitField.planes[gi] = true;
+    }
+
+    return true;
+    MRPT_END
+}
@@ -16,6 +16,12 @@
 #include <mrpt/core/round.h>
 #include <mrpt/version.h>
 
+#if defined(MP2P_HAS_TBB)
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_reduce.h>
+#endif
+
 IMPLEMENTS_MRPT_OBJECT(Matcher_Point2Line, Matcher, mp2p_icp)
 
 using namespace mp2p_icp;
@@ -39,8 +45,8 @@ void Matcher_Point2Line::initialize(const mrpt::containers::yaml& params)
 void Matcher_Point2Line::implMatchOneLayer(
     const mrpt::maps::CMetricMap& pcGlobalMap,
     const mrpt::maps::CPointsMap& pcLocal,
-    const mrpt::poses::CPose3D& localPose, MatchState& ms,
-    [[maybe_unused]] const layer_name_t& globalName,
+    const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+    MatchState& ms, [[maybe_unused]] const layer_name_t& globalName,
     const layer_name_t& localName, Pairings& out) const
 {
     MRPT_START
@@ -48,13 +54,14 @@ void Matcher_Point2Line::implMatchOneLayer(
     const mrpt::maps::NearestNeighborsCapable& nnGlobal =
         *mp2p_icp::MapToNN(pcGlobalMap, true /*throw if cannot convert*/);
 
-    out.potential_pairings += pcLocal.size();
+    out.potential_pairings += sampledLocalPointCount(pcLocal, mc);
 
     // Empty maps?  Nothing to do
     if (pcGlobalMap.isEmpty() || pcLocal.empty()) return;
 
     const TransformedLocalPointCloud tl = transform_local_to_global(
-        pcLocal, localPose, maxLocalPointsPerLayer_, localPointsSampleSeed_);
+        pcLocal, localPose, effectiveMaxLocalPointsPerLayer(mc),
+        localPointsSampleSeed_);
 
     // Try to do matching only if the bounding boxes have some overlap:
     if (!pcGlobalMap.boundingBox().intersection(
@@ -62,9 +69,6 @@ void Matcher_Point2Line::implMatchOneLayer(
             distanceThreshold + bounding_box_intersection_check_epsilon_))
         return;
 
-    // Prepare output: no correspondences initially:
-    out.paired_pt2pl.reserve(out.paired_pt2pl.size() + pcLocal.size() / 10);
-
     // Loop for each point in local map:
     // --------------------------------------------------
     const float maxDistForCorrespondenceSquared =
@@ -74,18 +78,37 @@ void Matcher_Point2Line::implMatchOneLayer(
     const auto& lys = pcLocal.getPointsBufferRef_y();
     const auto& lzs = pcLocal.getPointsBufferRef_z();
 
-    std::vector<float>                 kddSqrDist;
-    std::vector<uint64_t>              kddIdxs;
-    std::vector<mrpt::math::TPoint3Df> kddPts;
-    std::vector<float>                 kddXs, kddYs, kddZs;
+    const size_t nLocalPts = tl.x_locals.size();
+
+    // Make sure the 3D kd-trees (if used internally) are up to date, from this
+    // single-thread call before entering into parallelization:
+    nnGlobal.nn_prepare_for_3d_queries();
 
-    for (size_t i = 0; i < tl.x_locals.size(); i++)
+    // Per-thread buffers, reused for all points:
+    struct Scratch
+    {
+        std::vector<float>                 kddSqrDist;
+        std::vector<uint64_t>              kddIdxs;
+        std::vector<mrpt::math::TPoint3Df> kddPts;
+        std::vector<float>                 kddXs, kddYs, kddZs;
+    };
+
+    // Pairings, and the local point index of each one:
+    struct Result
+    {
+        MatchedPointLineList pairs;
+        std::vector<size_t>  localIdxs;
+    };
+
+    // Note: ms is only *read* here. Local points are marked as paired below,
+    // in a single thread, so there are no data races on the bit field.
+    const auto lambdaMatchPoint = [&](const size_t i, Scratch& sc, Result& res)
     {
         const size_t localIdx = tl.idxs.has_value() ? (*tl.idxs)[i] : i;
 
         if (!allowMatchAlreadyMatchedPoints_ &&
             ms.localPairedBitField.point_layers.at(localName)[localIdx])
-            continue;  // skip, already paired.
+            return;  // skip, already paired.
 
         // Don't discard **global** map points if already used by another
         // matcher, since the assumption of "line" features implies that
@@ -100,52 +123,46 @@ void Matcher_Point2Line::implMatchOneLayer(
         // (x_local, y_local, z_local) in the global map.
         nnGlobal.nn_multiple_search(
             {lx, ly, lz},  // Look closest to this guy
-            knn, kddPts, kddSqrDist, kddIdxs);
+            knn, sc.kddPts, sc.kddSqrDist, sc.kddIdxs);
 
         // Filter the list of neighbors by maximum distance threshold:
 
         // Faster common case: all points are valid:
-        if (!kddSqrDist.empty() &&
-            kddSqrDist.back() < maxDistForCorrespondenceSquared)
+        if (!sc.kddSqrDist.empty() &&
+            sc.kddSqrDist.back() < maxDistForCorrespondenceSquared)
         {
             // Nothing to do: all knn points are within the range.
         }
         else
         {
-            for (size_t j = 0; j < kddSqrDist.size(); j++)
+            for (size_t j = 0; j < sc.kddSqrDist.size(); j++)
             {
-                if (kddSqrDist[j] > maxDistForCorrespondenceSquared)
+                if (sc.kddSqrDist[j] > maxDistForCorrespondenceSquared)
                 {
-                    kddIdxs.resize(j);
-                    kddSqrDist.resize(j);
+                    sc.kddIdxs.resize(j);
+                    sc.kddSqrDist.resize(j);
+                    sc.kddPts.resize(j);
                     break;
                 }
             }
         }
 
         // minimum: 2 points to be able to fit a line
-        if (kddIdxs.size() < minimumLinePoints) continue;
+        if (sc.kddIdxs.size() < minimumLinePoints) return;
 
-        mp2p_icp::vector_of_points_to_xyz(kddPts, kddXs, kddYs, kddZs);
+        mp2p_icp::vector_of_points_to_xyz(
+            sc.kddPts, sc.kddXs, sc.kddYs, sc.kddZs);
 
         const PointCloudEigen& eig = mp2p_icp::estimate_points_eigen(
-            kddXs.data(), kddYs.data(), kddZs.data(), std::nullopt,
-            kddPts.size());
+            sc.kddXs.data(), sc.kddYs.data(), sc.kddZs.data(), std::nullopt,
+            sc.kddPts.size());
 
         // Do these points look like a line?
-#if 0
-        std::cout << "eig values: " << eig.eigVals[0] << " " << eig.eigVals[1]
-                  << " " << eig.eigVals[2]
-                  << " eigvec0: " << eig.eigVectors[0].asString() << "\n"
-                  << " eigvec1: " << eig.eigVectors[1].asString() << "\n"
-                  << " eigvec2: " << eig.eigVectors[2].asString() << "\n";
-#endif
-
         // e0/e{1,2} must be < lineEigenThreshold:
-        if (eig.eigVals[0] > lineEigenThreshold * eig.eigVals[2]) continue;
-        if (eig.eigVals[1] > lineEigenThreshold * eig.eigVals[2]) continue;
+        if (eig.eigVals[0] > lineEigenThreshold * eig.eigVals[2]) return;
+        if (eig.eigVals[1] > lineEigenThreshold * eig.eigVals[2]) return;
 
-        auto& p    = out.paired_pt2ln.emplace_back();
+        auto& p    = res.pairs.emplace_back();
         p.pt_local = {lxs[localIdx], lys[localIdx], lzs[localIdx]};
 
         const auto& normal = eig.eigVectors[2];
@@ -153,10 +170,44 @@ void Matcher_Point2Line::implMatchOneLayer(
              eig.meanCov.mean.x(), eig.meanCov.mean.y(), eig.meanCov.mean.z()};
         p.ln_global.director = normal.unitarize();
 
-        // Mark local point as already paired:
-        ms.localPairedBitField.point_layers[localName].mark_as_set(localIdx);
+        res.localIdxs.push_back(localIdx);
+    };
+
+#if defined(MP2P_HAS_TBB)
+    tbb::enumerable_thread_specific<Scratch> scratchPerThread;
+
+    // Chunks are joined left to right, so the output order is the same as in
+    // the single-threaded version:
+    const Result res = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>{0, nLocalPts}, Result(),
+        [&](const tbb::blocked_range<size_t>& r, Result acc) -> Result
+        {
+            Scratch& sc = scratchPerThread.local();
+            for (size_t i = r.begin(); i < r.end(); i++)
+                lambdaMatchPoint(i, sc, acc);
+            return acc;
+        },
+        [](Result a, const Result& b) -> Result
+        {
+            a.pairs.insert(a.pairs.end(), b.pairs.begin(), b.pairs.end());
+            a.localIdxs.insert(
+                a.localIdxs.end(), b.localIdxs.begin(), b.localIdxs.end());
+            return a;
+        });
+#else
+    Scratch sc;
+    Result  res;
+    res.pairs.reserve(nLocalPts / 10);
+    for (size_t i = 0; i < nLocalPts; i++) lambdaMatchPoint(i, sc, res);
+#endif
+
+    out.paired_pt2ln.insert(
+        out.paired_pt2ln.end(), std::make_move_iterator(res.pairs.begin()),
+        std::make_move_iterator(res.pairs.end()));
 
-    }  // For each local point
+    // Mark local points as already paired:
+    auto& localBits = ms.localPairedBitField.point_layers[localName];
+    for (const size_t localIdx : res.localIdxs) localBits.mark_as_set(localIdx);
 
     MRPT_END
 }
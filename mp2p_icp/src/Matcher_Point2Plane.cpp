@@ -16,6 +16,11 @@
 #include <mrpt/core/round.h>
 #include <mrpt/version.h>
 
+#if defined(MP2P_HAS_TBB)
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#endif
+
 IMPLEMENTS_MRPT_OBJECT(Matcher_Point2Plane, Matcher, mp2p_icp)
 
 using namespace mp2p_icp;
@@ -34,8 +39,8 @@ void Matcher_Point2Plane::initialize(const mrpt::containers::yaml& params)
 void Matcher_Point2Plane::implMatchOneLayer(
     const mrpt::maps::CMetricMap& pcGlobalMap,
     const mrpt::maps::CPointsMap& pcLocal,
-    const mrpt::poses::CPose3D& localPose, MatchState& ms,
-    [[maybe_unused]] const layer_name_t& globalName,
+    const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+    MatchState& ms, [[maybe_unused]] const layer_name_t& globalName,
     const layer_name_t& localName, Pairings& out) const
 {
     MRPT_START
@@ -45,13 +50,14 @@ void Matcher_Point2Plane::implMatchOneLayer(
     const mp2p_icp::NearestPlaneCapable& nnGlobal =
         *mp2p_icp::MapToNP(pcGlobalMap, true /*throw if cannot convert*/);
 
-    out.potential_pairings += pcLocal.size();
+    out.potential_pairings += sampledLocalPointCount(pcLocal, mc);
 
     // Empty maps?  Nothing to do
     if (pcGlobalMap.isEmpty() || pcLocal.empty()) return;
 
     const TransformedLocalPointCloud tl = transform_local_to_global(
-        pcLocal, localPose, maxLocalPointsPerLayer_, localPointsSampleSeed_);
+        pcLocal, localPose, effectiveMaxLocalPointsPerLayer(mc),
+        localPointsSampleSeed_);
 
     // Try to do matching only if the bounding boxes have some overlap:
     if (!pcGlobalMap.boundingBox().intersection(
@@ -59,24 +65,30 @@ void Matcher_Point2Plane::implMatchOneLayer(
             distanceThreshold + bounding_box_intersection_check_epsilon_))
         return;
 
-    // Prepare output: no correspondences initially:
-    out.paired_pt2pl.reserve(out.paired_pt2pl.size() + pcLocal.size() / 10);
-
     // Loop for each point in local map:
     // --------------------------------------------------
-    // searchRadius
-
     const auto& lxs = pcLocal.getPointsBufferRef_x();
     const auto& lys = pcLocal.getPointsBufferRef_y();
     const auto& lzs = pcLocal.getPointsBufferRef_z();
 
-    for (size_t i = 0; i < tl.x_locals.size(); i++)
+    const size_t nLocalPts = tl.x_locals.size();
+
+    // Pairings, and the local point index of each one:
+    struct Result
+    {
+        MatchedPointPlaneList pairs;
+        std::vector<size_t>   localIdxs;
+    };
+
+    // Note: ms is only *read* here. Local points are marked as paired below,
+    // in a single thread, so there are no data races on the bit field.
+    const auto lambdaMatchPoint = [&](const size_t i, Result& res)
     {
         const size_t localIdx = tl.idxs.has_value() ? (*tl.idxs)[i] : i;
 
         if (!allowMatchAlreadyMatchedPoints_ &&
             ms.localPairedBitField.point_layers.at(localName)[localIdx])
-            continue;  // skip, already paired.
+            return;  // skip, already paired.
 
         // Don't discard **global** map points if already used by another
         // matcher, since the assumption of "plane" features implies that
@@ -87,23 +99,52 @@ void Matcher_Point2Plane::implMatchOneLayer(
         const float lx = tl.x_locals[i], ly = tl.y_locals[i],
                     lz = tl.z_locals[i];
 
-        // Use a KD-tree to look for the nearnest neighbor(s) of
-        // (x_local, y_local, z_local) in the global map.
+        // Look for the nearest plane to (x_local, y_local, z_local) in the
+        // global map.
         const NearestPlaneCapable::NearestPlaneResult np =
             nnGlobal.nn_search_pt2pl({lx, ly, lz}, distanceThreshold);
 
-        if (!np.pairing) continue;
-        if (np.distance > distanceThreshold) continue;  // plane is too distant
+        if (!np.pairing) return;
+        if (np.distance > distanceThreshold) return;  // plane is too distant
 
         // OK, all conditions pass: add the new pairing:
-        auto& p     = out.paired_pt2pl.emplace_back();
-        p.pt_local  = {lxs[localIdx], lys[localIdx], lzs[localIdx]};
-        p.pl_global = np.pairing->pl_global;
-
-        // Mark local point as already paired:
-        ms.localPairedBitField.point_layers[localName].mark_as_set(localIdx);
-
-    }  // For each local point
+        auto& p    = res.pairs.emplace_back(*np.pairing);
+        p.pt_local = {lxs[localIdx], lys[localIdx], lzs[localIdx]};
+
+        res.localIdxs.push_back(localIdx);
+    };
+
+#if defined(MP2P_HAS_TBB)
+    // Chunks are joined left to right, so the output order is the same as in
+    // the single-threaded version. NP maps must support concurrent queries.
+    const Result res = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>{0, nLocalPts}, Result(),
+        [&](const tbb::blocked_range<size_t>& r, Result acc) -> Result
+        {
+            for (size_t i = r.begin(); i < r.end(); i++)
+                lambdaMatchPoint(i, acc);
+            return acc;
+        },
+        [](Result a, const Result& b) -> Result
+        {
+            a.pairs.insert(a.pairs.end(), b.pairs.begin(), b.pairs.end());
+            a.localIdxs.insert(
+                a.localIdxs.end(), b.localIdxs.begin(), b.localIdxs.end());
+            return a;
+        });
+#else
+    Result res;
+    res.pairs.reserve(nLocalPts / 10);
+    for (size_t i = 0; i < nLocalPts; i++) lambdaMatchPoint(i, res);
+#endif
+
+    out.paired_pt2pl.insert(
+        out.paired_pt2pl.end(), std::make_move_iterator(res.pairs.begin()),
+        std::make_move_iterator(res.pairs.end()));
+
+    // Mark local points as already paired:
+    auto& localBits = ms.localPairedBitField.point_layers[localName];
+    for (const size_t localIdx : res.localIdxs) localBits.mark_as_set(localIdx);
 
     MRPT_END
 }
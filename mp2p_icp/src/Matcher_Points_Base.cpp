@@ -11,19 +11,18 @@
  */
 
 #include <mp2p_icp/Matcher_Points_Base.h>
-#include <mrpt/random/random_shuffle.h>
 
+#include <algorithm>
 #include <chrono>
-#include <numeric>  // iota
 #include <random>
+#include <unordered_set>
 
 using namespace mp2p_icp;
 
 bool Matcher_Points_Base::impl_match(
     const metric_map_t& pcGlobal, const metric_map_t& pcLocal,
     const mrpt::poses::CPose3D&          localPose,
-    [[maybe_unused]] const MatchContext& mc, MatchState& ms,
-    Pairings& out) const
+    const MatchContext& mc, MatchState& ms, Pairings& out) const
 {
     MRPT_START
 
@@ -85,24 +84,16 @@ bool Matcher_Points_Base::impl_match(
 
             const size_t nBefore = out.paired_pt2pt.size();
 
-            // Ensure we have the KD-tree parameters desired by the user:
-            if (kdtree_leaf_max_points_.has_value())
-            {
-                if (auto glLayerPts = mp2p_icp::MapToPointsMap(*glLayer);
-                    glLayerPts &&
-                    glLayerPts->kdtree_search_params.leaf_max_size !=
-                        *kdtree_leaf_max_points_)
-                {
-                    glLayerPts->kdtree_search_params.leaf_max_size =
-                        *kdtree_leaf_max_points_;
-                    glLayerPts->mark_as_modified();  // rebuild kd-tree index
-                }
-            }
+            // Use a (cached) NN index with the KD-tree parameters desired by
+            // the user, without touching the global layer itself:
+            const mrpt::maps::CMetricMap& glLayerNN =
+                pcGlobal.layer_for_nn_queries(
+                    glLayerName, kdtree_leaf_max_points_);
 
             // matcher implementation:
             implMatchOneLayer(
-                *glLayer, *lcLayer, localPose, ms, glLayerName, localLayerName,
-                out);
+                glLayerNN, *lcLayer, localPose, mc, ms, glLayerName,
+                localLayerName, out);
 
             const size_t nAfter = out.paired_pt2pt.size();
 
@@ -170,6 +161,25 @@ void Matcher_Points_Base::initialize(const mrpt::containers::yaml& params)
         bounding_box_intersection_check_epsilon_);
 }
 
+uint64_t Matcher_Points_Base::effectiveMaxLocalPointsPerLayer(
+    const MatchContext& mc) const
+{
+    const uint64_t ctxLimit = mc.maxLocalPointsPerLayer;
+
+    if (ctxLimit == 0) return maxLocalPointsPerLayer_;
+    if (maxLocalPointsPerLayer_ == 0) return ctxLimit;
+    return std::min(maxLocalPointsPerLayer_, ctxLimit);
+}
+
+std::size_t Matcher_Points_Base::sampledLocalPointCount(
+    const mrpt::maps::CPointsMap& pcLocal, const MatchContext& mc) const
+{
+    const uint64_t maxPts = effectiveMaxLocalPointsPerLayer(mc);
+
+    if (maxPts == 0) return pcLocal.size();
+    return std::min<std::size_t>(pcLocal.size(), maxPts);
+}
+
 Matcher_Points_Base::TransformedLocalPointCloud
     Matcher_Points_Base::transform_local_to_global(
         const mrpt::maps::CPointsMap& pcLocal,
@@ -212,18 +222,26 @@ Matcher_Points_Base::TransformedLocalPointCloud
     }
     else
     {
-        // random subset:
-        r.idxs.emplace(maxLocalPoints);
-        std::iota(r.idxs->begin(), r.idxs->end(), 0);
-
+        // random subset (of the whole cloud), with Floyd's algorithm, in
+        // O(maxLocalPoints) instead of O(nLocalPoints):
         const unsigned int seed =
             localPointsSampleSeed != 0
                 ? localPointsSampleSeed
                 : std::chrono::system_clock::now().time_since_epoch().count();
 
-        mrpt::random::partial_shuffle(
-            r.idxs->begin(), r.idxs->end(), std::default_random_engine(seed),
-            maxLocalPoints);
+        std::default_random_engine rng(seed);
+
+        std::unordered_set<std::size_t> chosen;
+        chosen.reserve(maxLocalPoints);
+        for (size_t j = nLocalPoints - maxLocalPoints; j < nLocalPoints; j++)
+        {
+            const size_t t = std::uniform_int_distribution<size_t>(0, j)(rng);
+            if (!chosen.insert(t).second) chosen.insert(j);
+        }
+
+        // Sorted, for memory locality and deterministic pairing order:
+        r.idxs.emplace(chosen.begin(), chosen.end());
+        std::sort(r.idxs->begin(), r.idxs->end());
 
         r.x_locals.resize(maxLocalPoints);
         r.y_locals.resize(maxLocalPoints);
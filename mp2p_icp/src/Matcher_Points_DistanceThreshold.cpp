@@ -15,6 +15,9 @@
 #include <mrpt/core/round.h>
 #include <mrpt/version.h>
 
+#include <algorithm>
+#include <cmath>
+
 #if defined(MP2P_HAS_TBB)
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_reduce.h>
@@ -38,14 +41,29 @@ void Matcher_Points_DistanceThreshold::initialize(
     DECLARE_PARAMETER_REQ(params, threshold);
     DECLARE_PARAMETER_REQ(params, thresholdAngularDeg);
     DECLARE_PARAMETER_OPT(params, pairingsPerPoint);
+
+    DECLARE_PARAMETER_OPT(params, correspondenceReuseFraction);
+    DECLARE_PARAMETER_OPT(params, correspondenceReuseCandidates);
+}
+
+void Matcher_Points_DistanceThreshold::ReuseCache::reset(
+    std::size_t nLocal, uint32_t newK)
+{
+    K = newK;
+    valid.assign(nLocal, 0);
+    query.resize(nLocal);
+    radius.resize(nLocal);
+    count.resize(nLocal);
+    candIdx.resize(nLocal * K);
+    candPts.resize(nLocal * K);
 }
 
 void Matcher_Points_DistanceThreshold::implMatchOneLayer(
     const mrpt::maps::CMetricMap& pcGlobalMap,
     const mrpt::maps::CPointsMap& pcLocal,
-    const mrpt::poses::CPose3D& localPose, MatchState& ms,
-    const layer_name_t& globalName, const layer_name_t& localName,
-    Pairings& out) const
+    const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+    MatchState& ms, const layer_name_t& globalName,
+    const layer_name_t& localName, Pairings& out) const
 {
     MRPT_START
 
@@ -58,13 +76,15 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
     const mrpt::maps::NearestNeighborsCapable& nnGlobal =
         *mp2p_icp::MapToNN(pcGlobalMap, true /*throw if cannot convert*/);
 
-    out.potential_pairings += pcLocal.size() * pairingsPerPoint;
+    out.potential_pairings +=
+        sampledLocalPointCount(pcLocal, mc) * pairingsPerPoint;
 
     // Empty maps?  Nothing to do
     if (pcGlobalMap.isEmpty() || pcLocal.empty()) return;
 
     const TransformedLocalPointCloud tl = transform_local_to_global(
-        pcLocal, localPose, maxLocalPointsPerLayer_, localPointsSampleSeed_);
+        pcLocal, localPose, effectiveMaxLocalPointsPerLayer(mc),
+        localPointsSampleSeed_);
 
     // Try to do matching only if the bounding boxes have some overlap:
     if (!pcGlobalMap.boundingBox().intersection(
@@ -90,8 +110,10 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
     // single-thread call before entering into parallelization:
     nnGlobal.nn_prepare_for_3d_queries();
 
+    // Note: this may be called from parallel threads, so it must not modify
+    // the match state. That is done afterwards, in lambdaCommitPairs.
     const auto lambdaAddPair =
-        [this, &ms, &globalName, &localName, &lxs, &lys, &lzs](
+        [this, &ms, &globalName, &lxs, &lys, &lzs](
             mrpt::tfest::TMatchingPairList& outPairs, const size_t localIdx,
             const mrpt::math::TPoint3Df& globalPt, const uint64_t globalIdxOrID,
             const float errSqr)
@@ -111,17 +133,197 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
         p.local     = {lxs[localIdx], lys[localIdx], lzs[localIdx]};
 
         p.errorSquareAfterTransformation = errSqr;
+    };
+
+    // Moves the new pairings to the output, marking local & global points as
+    // already paired. Global points paired more than once are only kept for
+    // the first local point, in local point order.
+    const auto lambdaCommitPairs =
+        [this, &ms, &globalName, &localName,
+         &out](mrpt::tfest::TMatchingPairList& newPairs)
+    {
+        out.paired_pt2pt.reserve(out.paired_pt2pt.size() + newPairs.size());
 
-        // Mark local & global points as already paired:
-        if (!allowMatchAlreadyMatchedGlobalPoints_)
+        if (allowMatchAlreadyMatchedGlobalPoints_)
         {
-            ms.localPairedBitField.point_layers[localName].mark_as_set(
-                localIdx);
-            ms.globalPairedBitField.point_layers[globalName].mark_as_set(
-                globalIdxOrID);
+            out.paired_pt2pt.insert(
+                out.paired_pt2pt.end(),
+                std::make_move_iterator(newPairs.begin()),
+                std::make_move_iterator(newPairs.end()));
+            return;
+        }
+
+        auto& localBits  = ms.localPairedBitField.point_layers[localName];
+        auto& globalBits = ms.globalPairedBitField.point_layers[globalName];
+
+        for (auto& p : newPairs)
+        {
+            if (globalBits[p.globalIdx]) continue;
+
+            localBits.mark_as_set(p.localIdx);
+            globalBits.mark_as_set(p.globalIdx);
+            out.paired_pt2pt.push_back(std::move(p));
         }
     };
 
+    // Correspondence reuse between ICP iterations?
+    // --------------------------------------------------
+    if (correspondenceReuseFraction > 0)
+    {
+        ASSERT_LT_(correspondenceReuseFraction, 1.0);
+
+        const uint32_t K =
+            std::max(correspondenceReuseCandidates, pairingsPerPoint);
+
+        const auto*       glPts  = mp2p_icp::MapToPointsMap(pcGlobalMap);
+        const std::size_t glSize = glPts ? glPts->size() : 0;
+
+        ReuseCache& cache = reuseCache_[{globalName, localName}];
+        if (mc.icpIteration == 0 ||
+            cache.global != &pcGlobalMap || cache.globalSize != glSize ||
+            cache.K != K || cache.valid.size() != pcLocal.size())
+        {
+            cache.reset(pcLocal.size(), K);
+            cache.global     = &pcGlobalMap;
+            cache.globalSize = glSize;
+        }
+
+        const float maxMove = correspondenceReuseFraction * threshold;
+
+        struct ReuseResult
+        {
+            mrpt::tfest::TMatchingPairList pairs;
+            std::size_t                    reused = 0;
+        };
+
+        const auto lambdaMatchRange =
+            [&](std::size_t i0, std::size_t i1, ReuseResult& res)
+        {
+            std::vector<uint64_t>              nnIndices;
+            std::vector<float>                 nnSqrDists;
+            std::vector<mrpt::math::TPoint3Df> nnPts;
+            std::vector<std::pair<float, uint32_t>> ranked;
+
+            for (std::size_t i = i0; i < i1; i++)
+            {
+                const size_t localIdx = tl.idxs.has_value() ? (*tl.idxs)[i] : i;
+
+                if (!allowMatchAlreadyMatchedPoints_ &&
+                    ms.localPairedBitField.point_layers.at(localName)[localIdx])
+                    continue;  // skip, already paired.
+
+                const mrpt::math::TPoint3Df q(
+                    tl.x_locals[i], tl.y_locals[i], tl.z_locals[i]);
+
+                const float finalThresSqr =
+                    maxDistForCorrespondenceSquared +
+                    angularThresholdFactorSquared * q.sqrNorm();
+
+                const std::size_t base = localIdx * K;
+
+                // 1) Try to reuse the candidates from the last iteration:
+                if (cache.valid[localIdx])
+                {
+                    const float delta = (q - cache.query[localIdx]).norm();
+                    const float safeRadius = cache.radius[localIdx] - delta;
+
+                    if (delta <= maxMove && safeRadius > 0)
+                    {
+                        ranked.clear();
+                        for (uint32_t k = 0; k < cache.count[localIdx]; k++)
+                        {
+                            const float d2 =
+                                (cache.candPts[base + k] - q).sqrNorm();
+                            if (d2 < mrpt::square(safeRadius))
+                                ranked.emplace_back(d2, k);
+                        }
+                        std::sort(ranked.begin(), ranked.end());
+
+                        // These are guaranteed to be the actual NNs. Enough?
+                        if (ranked.size() >= pairingsPerPoint ||
+                            mrpt::square(safeRadius) >= finalThresSqr)
+                        {
+                            for (std::size_t k = 0;
+                                 k < ranked.size() && k < pairingsPerPoint; k++)
+                            {
+                                const auto [d2, idx] = ranked[k];
+                                if (d2 >= finalThresSqr) break;
+
+                                lambdaAddPair(
+                                    res.pairs, localIdx,
+                                    cache.candPts[base + idx],
+                                    cache.candIdx[base + idx], d2);
+                            }
+                            res.reused++;
+                            continue;
+                        }
+                    }
+                }
+
+                // 2) Regular KD-tree query, and cache the result:
+                const float searchRadius = std::sqrt(finalThresSqr) + maxMove;
+
+                nnGlobal.nn_radius_search(
+                    q, mrpt::square(searchRadius), nnPts, nnSqrDists,
+                    nnIndices, K);
+
+                ranked.clear();
+                for (std::size_t k = 0; k < nnIndices.size() && k < K; k++)
+                    ranked.emplace_back(nnSqrDists[k], static_cast<uint32_t>(k));
+                std::sort(ranked.begin(), ranked.end());
+
+                cache.valid[localIdx] = 1;
+                cache.query[localIdx] = q;
+                cache.count[localIdx] = static_cast<uint32_t>(ranked.size());
+                // If the result was truncated to K points, we only know about
+                // the points up to the K-th distance:
+                cache.radius[localIdx] =
+                    ranked.size() == K ? std::sqrt(ranked.back().first)
+                                       : searchRadius;
+
+                for (std::size_t k = 0; k < ranked.size(); k++)
+                {
+                    const auto [d2, idx]     = ranked[k];
+                    cache.candIdx[base + k] = nnIndices[idx];
+                    cache.candPts[base + k] = nnPts[idx];
+
+                    if (k < pairingsPerPoint && d2 < finalThresSqr)
+                    {
+                        lambdaAddPair(
+                            res.pairs, localIdx, nnPts[idx], nnIndices[idx],
+                            d2);
+                    }
+                }
+            }
+        };
+
+#if defined(MP2P_HAS_TBB)
+        ReuseResult rr = tbb::parallel_reduce(
+            tbb::blocked_range<size_t>{0, nLocalPts}, ReuseResult(),
+            [&](const tbb::blocked_range<size_t>& r, ReuseResult res)
+            {
+                lambdaMatchRange(r.begin(), r.end(), res);
+                return res;
+            },
+            [](ReuseResult a, const ReuseResult& b) -> ReuseResult
+            {
+                a.pairs.insert(a.pairs.end(), b.pairs.begin(), b.pairs.end());
+                a.reused += b.reused;
+                return a;
+            });
+#else
+        ReuseResult rr;
+        lambdaMatchRange(0, nLocalPts, rr);
+#endif
+
+        MRPT_LOG_DEBUG_FMT(
+            "Correspondence reuse: %zu/%zu local points ('%s'->'%s')",
+            rr.reused, nLocalPts, localName.c_str(), globalName.c_str());
+
+        lambdaCommitPairs(rr.pairs);
+        return;
+    }
+
 #if defined(MP2P_HAS_TBB)
     // For the TBB lambdas:
     // TBB call structure based on the beautiful implementation in KISS-ICP.
@@ -210,12 +412,11 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
             return a;
         });
 
-    out.paired_pt2pt.insert(
-        out.paired_pt2pt.end(), std::make_move_iterator(newPairs.begin()),
-        std::make_move_iterator(newPairs.end()));
+    lambdaCommitPairs(newPairs);
 #else
 
-    out.paired_pt2pt.reserve(nLocalPts);
+    mrpt::tfest::TMatchingPairList newPairs;
+    newPairs.reserve(nLocalPts);
 
     std::vector<uint64_t>              neighborIndices;
     std::vector<float>                 neighborSqrDists;
@@ -274,10 +475,12 @@ void Matcher_Points_DistanceThreshold::implMatchOneLayer(
                 break;  // skip this and the rest.
 
             lambdaAddPair(
-                out.paired_pt2pt, localIdx, neighborPts.at(k),
-                neighborIndices.at(k), tentativeErrSqr);
+                newPairs, localIdx, neighborPts.at(k), neighborIndices.at(k),
+                tentativeErrSqr);
         }
     }
+
+    lambdaCommitPairs(newPairs);
 #endif
 
     MRPT_END
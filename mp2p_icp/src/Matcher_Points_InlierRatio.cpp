@@ -35,8 +35,8 @@ void Matcher_Points_InlierRatio::initialize(
 void Matcher_Points_InlierRatio::implMatchOneLayer(
     const mrpt::maps::CMetricMap& pcGlobalMap,
     const mrpt::maps::CPointsMap& pcLocal,
-    const mrpt::poses::CPose3D& localPose, MatchState& ms,
-    [[maybe_unused]] const layer_name_t& globalName,
+    const mrpt::poses::CPose3D& localPose, const MatchContext& mc,
+    MatchState& ms, [[maybe_unused]] const layer_name_t& globalName,
     const layer_name_t& localName, Pairings& out) const
 {
     MRPT_START
@@ -47,13 +47,14 @@ void Matcher_Points_InlierRatio::implMatchOneLayer(
     const mrpt::maps::NearestNeighborsCapable& nnGlobal =
         *mp2p_icp::MapToNN(pcGlobalMap, true /*throw if cannot convert*/);
 
-    out.potential_pairings += pcLocal.size();
+    out.potential_pairings += sampledLocalPointCount(pcLocal, mc);
 
     // Empty maps?  Nothing to do
     if (pcGlobalMap.isEmpty() || pcLocal.empty()) return;
 
     const TransformedLocalPointCloud tl = transform_local_to_global(
-        pcLocal, localPose, maxLocalPointsPerLayer_, localPointsSampleSeed_);
+        pcLocal, localPose, effectiveMaxLocalPointsPerLayer(mc),
+        localPointsSampleSeed_);
 
     // Try to do matching only if the bounding boxes have some overlap:
     if (!pcGlobalMap.boundingBox().intersection(
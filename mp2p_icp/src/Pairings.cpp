@@ -113,6 +113,11 @@ static void push_back_copy(const T& o, T& me)
 template <typename T>
 static void push_back_move(T&& o, T& me)
 {
+    if (me.empty())
+    {
+        me = std::move(o);
+        return;
+    }
     me.insert(
         me.end(), std::make_move_iterator(o.begin()),
         std::make_move_iterator(o.end()));
@@ -135,7 +140,7 @@ void Pairings::push_back(Pairings&& o)
     push_back_move(std::move(o.paired_pt2pl), paired_pt2pl);
     push_back_move(std::move(o.paired_ln2ln), paired_ln2ln);
     push_back_move(std::move(o.paired_pl2pl), paired_pl2pl);
-    potential_pairings = o.potential_pairings;
+    potential_pairings += o.potential_pairings;
 }
 
 size_t Pairings::size() const
@@ -220,13 +225,18 @@ void Pairings::get_visualization_pt2pl(
 
     for (const auto& pair : paired_pt2pl)
     {
-        const auto globalPlanePose =
-            mrpt::poses::CPose3D(pair.pl_global.plane.getAsPose3DForcingOrigin(
-                pair.pl_global.centroid));
-
         const auto ptLocal   = pair.pt_local;
         const auto ptLocalTf = localWrtGlobal.composePoint(ptLocal);
 
+        // Draw the plane patch centered at the projection of the point:
+        const double               d = pair.distance(ptLocalTf);
+        const mrpt::math::TPoint3D ptOnPlane(
+            ptLocalTf.x - pair.normal.x * d, ptLocalTf.y - pair.normal.y * d,
+            ptLocalTf.z - pair.normal.z * d);
+
+        const auto globalPlanePose = mrpt::poses::CPose3D(
+            pair.plane().getAsPose3DForcingOrigin(ptOnPlane));
+
         // line segment:
         lns->appendLine(ptLocalTf, globalPlanePose.translation());
 
@@ -298,16 +308,33 @@ CArchive& operator>>(CArchive& in, mp2p_icp::point_line_pair_t& obj)
 
 CArchive& operator<<(CArchive& out, const mp2p_icp::point_plane_pair_t& obj)
 {
-    out.WriteAs<uint8_t>(0);
-    out << obj.pl_global.centroid << obj.pl_global.plane << obj.pt_local;
+    out.WriteAs<uint8_t>(1);
+    out << obj.normal.x << obj.normal.y << obj.normal.z << obj.offset
+        << obj.pt_local;
     return out;
 }
 
 CArchive& operator>>(CArchive& in, mp2p_icp::point_plane_pair_t& obj)
 {
-    in.ReadAs<uint8_t>();
-
-    in >> obj.pl_global.centroid >> obj.pl_global.plane >> obj.pt_local;
+    const auto ver = in.ReadAs<uint8_t>();
+    switch (ver)
+    {
+        case 0:
+        {
+            // Old format: a plane patch (centroid + plane), and the point:
+            mrpt::math::TPoint3D centroid;
+            mrpt::math::TPlane   plane;
+            in >> centroid >> plane >> obj.pt_local;
+            obj.set_plane(plane);
+        }
+        break;
+        case 1:
+            in >> obj.normal.x >> obj.normal.y >> obj.normal.z >> obj.offset >>
+                obj.pt_local;
+            break;
+        default:
+            MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(ver);
+    };
     return in;
 }
 
@@ -20,7 +20,7 @@ const bool MP2P_ICP_GENERATE_DEBUG_FILES =
     mrpt::get_env<bool>("MP2P_ICP_GENERATE_DEBUG_FILES", false);
 
 // Implementation of the CSerializable virtual interface:
-uint8_t Parameters::serializeGetVersion() const { return 2; }
+uint8_t Parameters::serializeGetVersion() const { return 4; }
 void    Parameters::serializeTo(mrpt::serialization::CArchive& out) const
 {
     out << maxIterations << minAbsStep_trans << minAbsStep_rot;
@@ -28,6 +28,10 @@ void    Parameters::serializeTo(mrpt::serialization::CArchive& out) const
     out << debugPrintIterationProgress;
     out << decimationDebugFiles;
     out << saveIterationDetails << decimationIterationDetails;  // v2
+    out << debugArchiveFile;  // v3
+    out << maxTimeSeconds << deadlineSafetyFactor
+        << deadlineAdaptPointsMinIterations
+        << deadlineMinLocalPointsPerLayer;  // v4
 }
 void Parameters::serializeFrom(
     mrpt::serialization::CArchive& in, uint8_t version)
@@ -39,6 +43,8 @@ void Parameters::serializeFrom(
         case 0:
         case 1:
         case 2:
+        case 3:
+        case 4:
         {
             in >> maxIterations >> minAbsStep_trans >> minAbsStep_rot;
             in >> generateDebugFiles >> debugFileNameFormat;
@@ -46,6 +52,11 @@ void Parameters::serializeFrom(
             if (version >= 1) in >> decimationDebugFiles;
             if (version >= 2)
                 in >> saveIterationDetails >> decimationIterationDetails;
+            if (version >= 3) in >> debugArchiveFile;
+            if (version >= 4)
+                in >> maxTimeSeconds >> deadlineSafetyFactor >>
+                    deadlineAdaptPointsMinIterations >>
+                    deadlineMinLocalPointsPerLayer;
         }
         break;
         default:
@@ -60,8 +71,13 @@ void Parameters::load_from(const mrpt::containers::yaml& p)
     MCP_LOAD_REQ(p, maxIterations);
     MCP_LOAD_OPT(p, minAbsStep_trans);
     MCP_LOAD_OPT(p, minAbsStep_rot);
+    MCP_LOAD_OPT(p, maxTimeSeconds);
+    MCP_LOAD_OPT(p, deadlineSafetyFactor);
+    MCP_LOAD_OPT(p, deadlineAdaptPointsMinIterations);
+    MCP_LOAD_OPT(p, deadlineMinLocalPointsPerLayer);
     MCP_LOAD_OPT(p, generateDebugFiles);
     MCP_LOAD_OPT(p, debugFileNameFormat);
+    MCP_LOAD_OPT(p, debugArchiveFile);
     MCP_LOAD_OPT(p, debugPrintIterationProgress);
     MCP_LOAD_OPT(p, decimationDebugFiles);
     MCP_LOAD_OPT(p, saveIterationDetails);
@@ -105,8 +121,13 @@ void Parameters::save_to(mrpt::containers::yaml& p) const
     MCP_SAVE(p, maxIterations);
     MCP_SAVE(p, minAbsStep_trans);
     MCP_SAVE(p, minAbsStep_rot);
+    MCP_SAVE(p, maxTimeSeconds);
+    MCP_SAVE(p, deadlineSafetyFactor);
+    MCP_SAVE(p, deadlineAdaptPointsMinIterations);
+    MCP_SAVE(p, deadlineMinLocalPointsPerLayer);
     MCP_SAVE(p, generateDebugFiles);
     MCP_SAVE(p, debugFileNameFormat);
+    MCP_SAVE(p, debugArchiveFile);
     MCP_SAVE(p, debugPrintIterationProgress);
     MCP_SAVE(p, decimationDebugFiles);
     MCP_SAVE(p, saveIterationDetails);
@@ -12,6 +12,8 @@
 
 #include <mp2p_icp/QualityEvaluator_PairedRatio.h>
 
+#include <cmath>
+
 IMPLEMENTS_MRPT_OBJECT(QualityEvaluator_PairedRatio, QualityEvaluator, mp2p_icp)
 
 using namespace mp2p_icp;
@@ -21,6 +23,7 @@ void QualityEvaluator_PairedRatio::initialize(
 {
     MCP_LOAD_OPT(params, reuse_icp_pairings);
     MCP_LOAD_OPT(params, absolute_minimum_pairing_ratio);
+    MCP_LOAD_OPT(params, maxLocalPointsToEvaluate);
 
     if (!reuse_icp_pairings)
     {
@@ -31,6 +34,10 @@ void QualityEvaluator_PairedRatio::initialize(
         if (!p.has("allowMatchAlreadyMatchedGlobalPoints"))
             p["allowMatchAlreadyMatchedGlobalPoints"] = true;
 
+        // Repeatable quality values, even if evaluated on random subsets:
+        if (maxLocalPointsToEvaluate != 0 && !p.has("localPointsSampleSeed"))
+            p["localPointsSampleSeed"] = 1;
+
         matcher_.initialize(p);
     }
 }
@@ -50,8 +57,16 @@ QualityEvaluator::Result QualityEvaluator_PairedRatio::evaluate(
     }
     else
     {
-        MatchState ms(pcGlobal, pcLocal);
-        matcher_.match(pcGlobal, pcLocal, localPose, {}, ms, newPairings);
+        MatchContext mc;
+        mc.maxLocalPointsPerLayer = maxLocalPointsToEvaluate;
+
+        if (matchState_)
+            matchState_->initialize(pcGlobal, pcLocal);
+        else
+            matchState_.emplace(pcGlobal, pcLocal);
+
+        matcher_.match(
+            pcGlobal, pcLocal, localPose, mc, *matchState_, newPairings);
 
         pairings = &newPairings;
     }
@@ -63,7 +78,18 @@ QualityEvaluator::Result QualityEvaluator_PairedRatio::evaluate(
                     ? pairings->size() / double(nEffectiveLocalPoints)
                     : .0;
 
-    r.hard_discard = r.quality < absolute_minimum_pairing_ratio;
+    // On random subsets, only discard if the ratio is below the threshold
+    // beyond the ~95% confidence interval of the estimate:
+    double margin = 0;
+    if (!reuse_icp_pairings && maxLocalPointsToEvaluate != 0 &&
+        nEffectiveLocalPoints != 0)
+    {
+        margin = 2.0 * std::sqrt(
+                           r.quality * (1.0 - r.quality) /
+                           static_cast<double>(nEffectiveLocalPoints));
+    }
+
+    r.hard_discard = r.quality + margin < absolute_minimum_pairing_ratio;
 
     return r;
 }
@@ -11,7 +11,7 @@
 
 using namespace mp2p_icp;
 
-static const uint8_t SERIALIZATION_VERSION = 0;
+static const uint8_t SERIALIZATION_VERSION = 1;
 
 void Results::serializeTo(mrpt::serialization::CArchive& out) const
 {
@@ -20,17 +20,28 @@ void Results::serializeTo(mrpt::serialization::CArchive& out) const
     out << static_cast<uint8_t>(terminationReason);
     out << quality;
     finalPairings.serializeTo(out);
+    // v1:
+    out << observability.has_value();
+    if (observability)
+        for (int i = 0; i < 6; i++) out << (*observability)[i];
 }
 void Results::serializeFrom(mrpt::serialization::CArchive& in)
 {
     const auto readVersion = in.ReadAs<uint8_t>();
 
-    ASSERT_EQUAL_(readVersion, SERIALIZATION_VERSION);
+    ASSERT_LE_(readVersion, SERIALIZATION_VERSION);
 
     in >> optimal_tf >> optimalScale >> nIterations;
     terminationReason = static_cast<IterTermReason>(in.ReadAs<uint8_t>());
     in >> quality;
     finalPairings.serializeFrom(in);
+
+    observability.reset();
+    if (readVersion >= 1 && in.ReadAs<bool>())
+    {
+        auto& o = observability.emplace();
+        for (int i = 0; i < 6; i++) in >> o[i];
+    }
 }
 
 mrpt::serialization::CArchive& mp2p_icp::operator<<(
@@ -62,4 +73,7 @@ void Results::print(std::ostream& o) const
              terminationReason)
       << "\n"
       << "- finalPairings: " << finalPairings.contents_summary() << "\n";
+    if (observability)
+        o << "- observability: " << observability->asEigen().transpose()
+          << "\n";
 }
@@ -25,6 +25,10 @@ void Solver_GaussNewton::initialize(const mrpt::containers::yaml& params)
     MCP_LOAD_REQ(params, maxIterations);
     MCP_LOAD_OPT(params, innerLoopVerbose);
     MCP_LOAD_OPT(params, robustKernel);
+    MCP_LOAD_OPT(params, stepControl);
+    MCP_LOAD_OPT(params, lmInitialLambda);
+    MCP_LOAD_OPT(params, degeneracyThreshold);
+    MCP_LOAD_OPT(params, singlePrecision);
 
     DECLARE_PARAMETER_OPT(params, robustKernelParam);
 
@@ -48,6 +52,10 @@ bool Solver_GaussNewton::impl_optimal_pose(
     gnParams.kernel                 = robustKernel;
     gnParams.kernelParam            = robustKernelParam;
     gnParams.prior                  = sc.prior;
+    gnParams.stepControl            = stepControl;
+    gnParams.lmInitialLambda        = lmInitialLambda;
+    gnParams.degeneracyThreshold    = degeneracyThreshold;
+    gnParams.singlePrecision        = singlePrecision;
 
     ASSERT_(sc.guessRelativePose.has_value());
     gnParams.linearizationPoint =
@@ -113,40 +113,26 @@ mrpt::math::CVectorFixedDouble<3> mp2p_icp::error_point2plane(
 {
     MRPT_START
     mrpt::math::CVectorFixedDouble<3> error;
-    const auto&                       p      = pairing.pt_local;
-    const auto&                       pl_aux = pairing.pl_global.plane;
-    const mrpt::math::TPoint3D        l      = TPoint3D(p.x, p.y, p.z);
+    const auto&                       p = pairing.pt_local;
+    const auto&                       n = pairing.normal;
+    const mrpt::math::TPoint3D        l = TPoint3D(p.x, p.y, p.z);
     mrpt::math::TPoint3D              g;
     relativePose.composePoint(l, g);
-    double mod_n = mrpt::square(pl_aux.coefs[0]) +
-                   mrpt::square(pl_aux.coefs[1]) +
-                   mrpt::square(pl_aux.coefs[2]);
-
-    error[0] = -(pl_aux.coefs[0] / mod_n) *
-               (pl_aux.coefs[0] * g.x + pl_aux.coefs[1] * g.y +
-                pl_aux.coefs[2] * g.z + pl_aux.coefs[3]);
-    error[1] = -(pl_aux.coefs[1] / mod_n) *
-               (pl_aux.coefs[0] * g.x + pl_aux.coefs[1] * g.y +
-                pl_aux.coefs[2] * g.z + pl_aux.coefs[3]);
-    error[2] = -(pl_aux.coefs[2] / mod_n) *
-               (pl_aux.coefs[0] * g.x + pl_aux.coefs[1] * g.y +
-                pl_aux.coefs[2] * g.z + pl_aux.coefs[3]);
+
+    // The normal is already unit: error = -n * dist
+    const double dist = pairing.distance(g);
+
+    error[0] = -n.x * dist;
+    error[1] = -n.y * dist;
+    error[2] = -n.z * dist;
+
     if (jacobian)
     {
         // Eval Jacobian:
-        // J1
-        const Eigen::Matrix<double, 3, 3> J1 =
-            (Eigen::Matrix<double, 3, 3>()
-                 << -mrpt::square(pl_aux.coefs[0]) / mod_n,
-             -pl_aux.coefs[0] * pl_aux.coefs[1] / mod_n,
-             -pl_aux.coefs[0] * pl_aux.coefs[2] / mod_n,
-             -pl_aux.coefs[1] * pl_aux.coefs[0] / mod_n,
-             -mrpt::square(pl_aux.coefs[1]) / mod_n,
-             -pl_aux.coefs[1] * pl_aux.coefs[2] / mod_n,
-             -pl_aux.coefs[2] * pl_aux.coefs[0] / mod_n,
-             -pl_aux.coefs[2] * pl_aux.coefs[1] / mod_n,
-             -mrpt::square(pl_aux.coefs[2]) / mod_n)
-                .finished();
+        // J1 = -n * n^T
+        const Eigen::Vector3d             ne(n.x, n.y, n.z);
+        const Eigen::Matrix<double, 3, 3> J1 = -ne * ne.transpose();
+
         // J2
         // clang-format off
         const Eigen::Matrix<double, 3, 12> J2 =
@@ -371,3 +357,78 @@ mrpt::math::CVectorFixedDouble<3> mp2p_icp::error_plane2plane(
     return error;
     MRPT_END
 }
+
+// Closed-form tangent-space Jacobians:
+// d(T*exp(eps)*l)/d(eps) = [R | -R*[l]x]
+static Eigen::Matrix<double, 3, 6> jacob_point_se3(
+    const mrpt::poses::CPose3D& pose, const mrpt::math::TPoint3D& l)
+{
+    const auto& R = pose.getRotationMatrix().asEigen();
+
+    Eigen::Matrix<double, 3, 6> J;
+    J.block<3, 3>(0, 0) = R;
+    // -R*[l]x, column by column: -R*(l x e_i) = R*(e_i x l)
+    J.col(3) = R.col(2) * l.y - R.col(1) * l.z;
+    J.col(4) = R.col(0) * l.z - R.col(2) * l.x;
+    J.col(5) = R.col(1) * l.x - R.col(0) * l.y;
+    return J;
+}
+
+mrpt::math::CVectorFixedDouble<3> mp2p_icp::error_point2point(
+    const mrpt::tfest::TMatchingPair&       pairing,
+    const mrpt::poses::CPose3D&             relativePose,
+    mrpt::math::CMatrixFixed<double, 3, 6>& jacobian)
+{
+    const mrpt::math::TPoint3D l = pairing.local;
+
+    jacobian = jacob_point_se3(relativePose, l);
+
+    return error_point2point(pairing, relativePose);
+}
+
+mrpt::math::CVectorFixedDouble<3> mp2p_icp::error_point2line(
+    const mp2p_icp::point_line_pair_t&      pairing,
+    const mrpt::poses::CPose3D&             relativePose,
+    mrpt::math::CMatrixFixed<double, 3, 6>& jacobian)
+{
+    const auto& u = pairing.ln_global.director;
+    const Eigen::Vector3d uu(u.x, u.y, u.z);
+
+    // (I - u*u^T) * J:
+    const Eigen::Matrix<double, 3, 6> Jp =
+        jacob_point_se3(relativePose, pairing.pt_local);
+
+    jacobian.asEigen() = Jp - uu * (uu.transpose() * Jp);
+
+    return error_point2line(pairing, relativePose);
+}
+
+double mp2p_icp::error_point2plane(
+    const mp2p_icp::point_plane_pair_t&     pairing,
+    const mrpt::poses::CPose3D&             relativePose,
+    mrpt::math::CMatrixFixed<double, 1, 6>& jacobian)
+{
+    const auto&                p = pairing.pt_local;
+    const mrpt::math::TPoint3D l(p.x, p.y, p.z);
+    const auto&                n = pairing.normal;
+
+    // J = n^T * [R | -R*[l]x]
+    jacobian.asEigen() = Eigen::Vector3d(n.x, n.y, n.z).transpose() *
+                         jacob_point_se3(relativePose, l);
+
+    return pairing.distance(relativePose.composePoint(l));
+}
+
+mrpt::math::CVectorFixedDouble<3> mp2p_icp::error_plane2plane(
+    const mp2p_icp::matched_plane_t&        pairing,
+    const mrpt::poses::CPose3D&             relativePose,
+    mrpt::math::CMatrixFixed<double, 3, 6>& jacobian)
+{
+    // Only the normal is rotated: J = [0 | -R*[nl]x]
+    const auto nl = pairing.p_local.plane.getNormalVector();
+
+    jacobian.asEigen() = jacob_point_se3(relativePose, nl);
+    jacobian.asEigen().block<3, 3>(0, 0).setZero();
+
+    return error_plane2plane(pairing, relativePose);
+}
@@ -0,0 +1,626 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   global_registration.cpp
+ * @brief  Coarse, initial-guess-free registration (FPFH features + RANSAC)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/estimate_points_eigen.h>
+#include <mp2p_icp/global_registration.h>
+#include <mp2p_icp/optimal_tf_horn.h>
+#include <mrpt/core/bits_math.h>  // M_PIf, square()
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <nanoflann.hpp>  // shipped with MRPT
+#include <unordered_set>
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#endif
+
+using namespace mp2p_icp;
+
+void GlobalRegistrationParameters::load_from(const mrpt::containers::yaml& p)
+{
+    MCP_LOAD_OPT(p, local_layer);
+    MCP_LOAD_OPT(p, global_layer);
+    MCP_LOAD_OPT(p, keypoint_voxel_size);
+    MCP_LOAD_OPT(p, normal_radius);
+    MCP_LOAD_OPT(p, feature_radius);
+    MCP_LOAD_OPT(p, max_neighbors);
+    MCP_LOAD_OPT(p, mutual_filter);
+    MCP_LOAD_OPT(p, ransac_iterations);
+    MCP_LOAD_OPT(p, inlier_threshold);
+    MCP_LOAD_OPT(p, edge_length_similarity);
+    MCP_LOAD_OPT(p, min_inliers);
+    MCP_LOAD_OPT(p, seed);
+}
+
+namespace
+{
+template <typename F>
+void for_each_index(std::size_t n, F&& f)
+{
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, n),
+        [&](const tbb::blocked_range<std::size_t>& r)
+        {
+            for (std::size_t i = r.begin(); i < r.end(); i++) f(i);
+        });
+#else
+    for (std::size_t i = 0; i < n; i++) f(i);
+#endif
+}
+
+// Cheap, high-quality 64bit pseudorandom generator: advances `state` and
+// returns the next number. Each RANSAC iteration seeds its own state from
+// (seed, iteration index), so samples do not depend on thread scheduling.
+uint64_t splitmix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z          = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+using vec3f = std::array<float, 3>;
+
+vec3f operator-(const mrpt::math::TPoint3Df& a, const mrpt::math::TPoint3Df& b)
+{
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+}
+float dot(const vec3f& a, const vec3f& b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+vec3f cross(const vec3f& a, const vec3f& b)
+{
+    return {
+        a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2],
+        a[0] * b[1] - a[1] * b[0]};
+}
+
+constexpr std::size_t FPFH_BINS = FPFH_LENGTH / 3;
+
+std::size_t toBin(float v, float vMin, float vMax)
+{
+    const auto b = static_cast<int>(
+        std::floor(FPFH_BINS * (v - vMin) / (vMax - vMin)));
+    return static_cast<std::size_t>(
+        std::clamp<int>(b, 0, static_cast<int>(FPFH_BINS) - 1));
+}
+
+/** Darboux frame angular features, as in PCL computePairFeatures().
+ *
+ * Normals are not oriented (there is no single sensor viewpoint for a map
+ * built from many scans), so both are first flipped to point along p2-p1.
+ * This makes the features invariant to the sign of either normal.
+ */
+bool pairFeatures(
+    const mrpt::math::TPoint3Df& p1, vec3f n1, const mrpt::math::TPoint3Df& p2,
+    vec3f n2, float& f1, float& f2, float& f3)
+{
+    vec3f       dp   = p2 - p1;
+    const float dist = std::sqrt(dot(dp, dp));
+    if (dist == 0) return false;
+
+    if (dot(n1, dp) < 0)
+        for (auto& c : n1) c = -c;
+    if (dot(n2, dp) < 0)
+        for (auto& c : n2) c = -c;
+
+    const float angle1 = dot(n1, dp) / dist;
+    const float angle2 = dot(n2, dp) / dist;
+
+    vec3f u = n1, nt = n2;
+    if (std::acos(std::abs(angle1)) > std::acos(std::abs(angle2)))
+    {
+        u  = n2;
+        nt = n1;
+        dp = {-dp[0], -dp[1], -dp[2]};
+        f3 = -angle2;
+    }
+    else
+    {
+        f3 = angle1;
+    }
+
+    vec3f       v     = cross(dp, u);
+    const float vNorm = std::sqrt(dot(v, v));
+    if (vNorm == 0) return false;
+    for (auto& c : v) c /= vNorm;
+
+    const vec3f w = cross(u, v);
+
+    f2 = dot(v, nt);
+    f1 = std::atan2(dot(w, nt), dot(u, nt));
+    return true;
+}
+
+std::optional<mrpt::poses::CPose3D> solveHorn(
+    const PointFeatures& local, const PointFeatures& global,
+    const FeatureCorrespondences& corrs, const std::vector<std::size_t>& idxs)
+{
+    Pairings in;
+    in.paired_pt2pt.reserve(idxs.size());
+    for (const auto i : idxs)
+    {
+        const auto& [li, gi] = corrs[i];
+
+        mrpt::tfest::TMatchingPair mp;
+        mp.localIdx  = li;
+        mp.globalIdx = gi;
+        mp.local     = local.points[li];
+        mp.global    = global.points[gi];
+        in.paired_pt2pt.push_back(mp);
+    }
+
+    OptimalTF_Result res;
+    if (!optimal_tf_horn(in, WeightParameters(), res)) return {};
+    return res.optimalPose;
+}
+
+bool isInlier(
+    const PointFeatures& local, const PointFeatures& global,
+    const std::pair<uint32_t, uint32_t>& corr, const mrpt::poses::CPose3D& pose,
+    double inlierThresholdSqr)
+{
+    const auto& l = local.points[corr.first];
+    const auto& g = global.points[corr.second];
+
+    double gx, gy, gz;
+    pose.composePoint(l.x, l.y, l.z, gx, gy, gz);
+    const double errSqr = mrpt::square(gx - g.x) + mrpt::square(gy - g.y) +
+                          mrpt::square(gz - g.z);
+    return errSqr < inlierThresholdSqr;
+}
+
+// Used to score each RANSAC hypothesis: no memory allocations.
+std::size_t countInliers(
+    const PointFeatures& local, const PointFeatures& global,
+    const FeatureCorrespondences& corrs, const mrpt::poses::CPose3D& pose,
+    double inlierThresholdSqr)
+{
+    std::size_t n = 0;
+    for (const auto& corr : corrs)
+        if (isInlier(local, global, corr, pose, inlierThresholdSqr)) n++;
+    return n;
+}
+
+// Fills `inliers` with the indices of inlier correspondences. The buffer is
+// reused by the caller.
+void findInliers(
+    const PointFeatures& local, const PointFeatures& global,
+    const FeatureCorrespondences& corrs, const mrpt::poses::CPose3D& pose,
+    double inlierThresholdSqr, std::vector<std::size_t>& inliers)
+{
+    inliers.clear();
+    for (std::size_t i = 0; i < corrs.size(); i++)
+        if (isInlier(local, global, corrs[i], pose, inlierThresholdSqr))
+            inliers.push_back(i);
+}
+
+// nanoflann adaptor for the descriptors of a PointFeatures:
+struct DescriptorsAdaptor
+{
+    const PointFeatures& feats;
+
+    std::size_t kdtree_get_point_count() const { return feats.size(); }
+
+    float kdtree_get_pt(std::size_t idx, std::size_t dim) const
+    {
+        return feats.descriptors[idx][dim];
+    }
+
+    template <class BBOX>
+    bool kdtree_get_bbox(BBOX&) const
+    {
+        return false;
+    }
+};
+
+using descriptors_kdtree_t = nanoflann::KDTreeSingleIndexAdaptor<
+    nanoflann::L2_Simple_Adaptor<float, DescriptorsAdaptor>,
+    DescriptorsAdaptor, static_cast<int>(FPFH_LENGTH), uint32_t>;
+
+}  // namespace
+
+PointFeatures mp2p_icp::compute_fpfh_features(
+    const mrpt::maps::CPointsMap& pts, const GlobalRegistrationParameters& p)
+{
+    MRPT_START
+
+    ASSERT_GT_(p.keypoint_voxel_size, 0);
+    ASSERT_GT_(p.normal_radius, 0);
+    ASSERT_GT_(p.feature_radius, 0);
+
+    const auto& xs = pts.getPointsBufferRef_x();
+    const auto& ys = pts.getPointsBufferRef_y();
+    const auto& zs = pts.getPointsBufferRef_z();
+
+    // 1) Keypoints: first point in each voxel, in input order:
+    std::vector<std::size_t> kpIdxs;
+    {
+        const double                 invVoxel = 1.0 / p.keypoint_voxel_size;
+        std::unordered_set<uint64_t> occupied;
+        for (std::size_t i = 0; i < xs.size(); i++)
+        {
+            const auto ix = static_cast<int32_t>(std::floor(xs[i] * invVoxel));
+            const auto iy = static_cast<int32_t>(std::floor(ys[i] * invVoxel));
+            const auto iz = static_cast<int32_t>(std::floor(zs[i] * invVoxel));
+
+            const uint64_t key =
+                (static_cast<uint64_t>(ix & 0x1fffff) << 42) |
+                (static_cast<uint64_t>(iy & 0x1fffff) << 21) |
+                static_cast<uint64_t>(iz & 0x1fffff);
+
+            if (occupied.insert(key).second) kpIdxs.push_back(i);
+        }
+    }
+    const std::size_t nKps = kpIdxs.size();
+
+    // 2) Normals, from the full-density cloud:
+    pts.nn_prepare_for_3d_queries();
+
+    std::vector<vec3f>   normals(nKps);
+    std::vector<uint8_t> validNormal(nKps, 0);
+
+    const float normalRadiusSqr = mrpt::square(p.normal_radius);
+
+    for_each_index(
+        nKps,
+        [&](std::size_t k)
+        {
+            const std::size_t                  i = kpIdxs[k];
+            const mrpt::math::TPoint3Df        pt(xs[i], ys[i], zs[i]);
+            std::vector<mrpt::math::TPoint3Df> nnPts;
+            std::vector<float>                 nnDistsSqr;
+            std::vector<uint64_t>              nnIdxs;
+            pts.nn_radius_search(
+                pt, normalRadiusSqr, nnPts, nnDistsSqr, nnIdxs,
+                p.max_neighbors);
+            if (nnIdxs.size() < 5) return;
+
+            const std::vector<size_t> idxs(nnIdxs.begin(), nnIdxs.end());
+            const auto eig = estimate_points_eigen(
+                xs.data(), ys.data(), zs.data(), idxs);
+
+            // Reject points on lines or without clear normal:
+            if (eig.eigVals[1] < 2 * eig.eigVals[0]) return;
+
+            // Unoriented normal, see pairFeatures():
+            const auto& ev = eig.eigVectors[0];
+            normals[k]     = {
+                static_cast<float>(ev.x), static_cast<float>(ev.y),
+                static_cast<float>(ev.z)};
+            validNormal[k] = 1;
+        });
+
+    // 3) Keypoint neighborhoods and SPFH:
+    mrpt::maps::CSimplePointsMap kps;
+    kps.reserve(nKps);
+    for (const auto i : kpIdxs) kps.insertPointFast(xs[i], ys[i], zs[i]);
+    kps.mark_as_modified();
+    kps.nn_prepare_for_3d_queries();
+
+    const float featRadiusSqr = mrpt::square(p.feature_radius);
+
+    std::vector<std::vector<uint64_t>>  neighbors(nKps);
+    std::vector<std::vector<float>>     neighborDists(nKps);
+    std::vector<std::array<float, FPFH_LENGTH>> spfh(nKps);
+
+    for_each_index(
+        nKps,
+        [&](std::size_t k)
+        {
+            auto& h = spfh[k];
+            h.fill(0);
+            if (!validNormal[k]) return;
+
+            const std::size_t                  i = kpIdxs[k];
+            const mrpt::math::TPoint3Df        pt(xs[i], ys[i], zs[i]);
+            std::vector<mrpt::math::TPoint3Df> nnPts;
+            kps.nn_radius_search(
+                pt, featRadiusSqr, nnPts, neighborDists[k], neighbors[k],
+                p.max_neighbors);
+
+            std::size_t count = 0;
+            for (std::size_t j = 0; j < neighbors[k].size(); j++)
+            {
+                const auto nk = neighbors[k][j];
+                if (nk == k || !validNormal[nk]) continue;
+
+                float f1, f2, f3;
+                if (!pairFeatures(
+                        pt, normals[k], nnPts[j], normals[nk], f1, f2, f3))
+                    continue;
+
+                h[toBin(f1, -M_PIf, M_PIf)] += 1;
+                h[FPFH_BINS + toBin(f2, -1.0f, 1.0f)] += 1;
+                h[2 * FPFH_BINS + toBin(f3, -1.0f, 1.0f)] += 1;
+                count++;
+            }
+            if (count == 0) return;
+
+            const float scale = 100.0f / count;
+            for (auto& v : h) v *= scale;
+        });
+
+    // 4) FPFH = own SPFH + distance-weighted SPFH of neighbors:
+    std::vector<std::array<float, FPFH_LENGTH>> fpfh(nKps);
+
+    for_each_index(
+        nKps,
+        [&](std::size_t k)
+        {
+            auto& f = fpfh[k];
+            f       = spfh[k];
+            if (!validNormal[k]) return;
+
+            std::array<float, FPFH_LENGTH> acc;
+            acc.fill(0);
+            std::size_t count = 0;
+            for (std::size_t j = 0; j < neighbors[k].size(); j++)
+            {
+                const auto nk = neighbors[k][j];
+                if (nk == k || !validNormal[nk]) continue;
+                const float d = std::sqrt(neighborDists[k][j]);
+                if (d <= 0) continue;
+
+                const float w = 1.0f / d;
+                for (std::size_t b = 0; b < FPFH_LENGTH; b++)
+                    acc[b] += w * spfh[nk][b];
+                count++;
+            }
+            if (count == 0) return;
+            for (std::size_t b = 0; b < FPFH_LENGTH; b++)
+                f[b] += acc[b] / count;
+        });
+
+    // 5) Output, only for valid keypoints:
+    PointFeatures out;
+    for (std::size_t k = 0; k < nKps; k++)
+    {
+        if (!validNormal[k]) continue;
+        const std::size_t i = kpIdxs[k];
+        out.points.emplace_back(xs[i], ys[i], zs[i]);
+        out.descriptors.push_back(fpfh[k]);
+    }
+    return out;
+
+    MRPT_END
+}
+
+FeatureCorrespondences mp2p_icp::match_features(
+    const PointFeatures& local, const PointFeatures& global, bool mutualFilter)
+{
+    MRPT_START
+
+    constexpr auto NO_MATCH = std::numeric_limits<uint32_t>::max();
+
+    FeatureCorrespondences corrs;
+    if (local.size() == 0 || global.size() == 0) return corrs;
+
+    // KD-trees in descriptor space. Queries are const, hence thread-safe.
+    const DescriptorsAdaptor   localAdaptor{local}, globalAdaptor{global};
+    const descriptors_kdtree_t localTree(
+        static_cast<int>(FPFH_LENGTH), localAdaptor);
+    const descriptors_kdtree_t globalTree(
+        static_cast<int>(FPFH_LENGTH), globalAdaptor);
+
+    const auto lambdaNearest = [&](const std::array<float, FPFH_LENGTH>& d,
+                                   const descriptors_kdtree_t&           tree)
+    {
+        uint32_t best     = NO_MATCH;
+        float    bestDist = 0;
+        if (tree.knnSearch(d.data(), 1, &best, &bestDist) == 0)
+            return NO_MATCH;
+        return best;
+    };
+
+    std::vector<uint32_t> local2global(local.size());
+    for_each_index(
+        local.size(),
+        [&](std::size_t i)
+        { local2global[i] = lambdaNearest(local.descriptors[i], globalTree); });
+
+    std::vector<uint32_t> global2local;
+    if (mutualFilter)
+    {
+        global2local.resize(global.size());
+        for_each_index(
+            global.size(),
+            [&](std::size_t j)
+            {
+                global2local[j] =
+                    lambdaNearest(global.descriptors[j], localTree);
+            });
+    }
+
+    for (std::size_t i = 0; i < local.size(); i++)
+    {
+        const uint32_t j = local2global[i];
+        if (j == NO_MATCH) continue;
+        if (mutualFilter && global2local[j] != i) continue;
+        corrs.emplace_back(static_cast<uint32_t>(i), j);
+    }
+    return corrs;
+
+    MRPT_END
+}
+
+GlobalRegistrationResult mp2p_icp::ransac_registration(
+    const PointFeatures& local, const PointFeatures& global,
+    const FeatureCorrespondences& corrs, const GlobalRegistrationParameters& p)
+{
+    MRPT_START
+
+    GlobalRegistrationResult r;
+    r.localKeypoints  = local.size();
+    r.globalKeypoints = global.size();
+    r.correspondences = corrs.size();
+
+    if (corrs.size() < 3) return r;
+
+    const double inlierThresSqr = mrpt::square(p.inlier_threshold);
+    const auto   nCorrs         = corrs.size();
+
+    struct Hypothesis
+    {
+        std::size_t          inliers   = 0;
+        uint64_t             iteration = std::numeric_limits<uint64_t>::max();
+        mrpt::poses::CPose3D pose;
+
+        // Deterministic choice, regardless of the evaluation order:
+        bool better_than(const Hypothesis& o) const
+        {
+            return inliers > o.inliers ||
+                   (inliers == o.inliers && iteration < o.iteration);
+        }
+    };
+
+    const auto lambdaEdgesConsistent = [&](const std::vector<std::size_t>& s)
+    {
+        for (std::size_t a = 0; a < s.size(); a++)
+        {
+            for (std::size_t b = a + 1; b < s.size(); b++)
+            {
+                const auto dl = local.points[corrs[s[a]].first] -
+                                local.points[corrs[s[b]].first];
+                const auto dg = global.points[corrs[s[a]].second] -
+                                global.points[corrs[s[b]].second];
+                const float ll = std::sqrt(dot(dl, dl));
+                const float lg = std::sqrt(dot(dg, dg));
+                if (std::min(ll, lg) <
+                    p.edge_length_similarity * std::max(ll, lg))
+                    return false;
+            }
+        }
+        return true;
+    };
+
+    const auto lambdaRunIterations = [&](uint64_t itBegin, uint64_t itEnd,
+                                         Hypothesis best) -> Hypothesis
+    {
+        std::vector<std::size_t> sample(3);
+        for (uint64_t it = itBegin; it < itEnd; it++)
+        {
+            uint64_t state = p.seed ^ (it * 0xD1B54A32D192ED03ULL);
+            for (auto& s : sample) s = splitmix64(state) % nCorrs;
+            if (sample[0] == sample[1] || sample[0] == sample[2] ||
+                sample[1] == sample[2])
+                continue;
+
+            if (!lambdaEdgesConsistent(sample)) continue;
+
+            const auto pose = solveHorn(local, global, corrs, sample);
+            if (!pose) continue;
+
+            Hypothesis h;
+            h.inliers =
+                countInliers(local, global, corrs, *pose, inlierThresSqr);
+            h.iteration = it;
+            h.pose      = *pose;
+
+            if (h.better_than(best)) best = h;
+        }
+        return best;
+    };
+
+#if defined(MP2P_HAS_TBB)
+    const Hypothesis best = tbb::parallel_reduce(
+        tbb::blocked_range<uint64_t>{0, p.ransac_iterations}, Hypothesis(),
+        [&](const tbb::blocked_range<uint64_t>& rng, Hypothesis res)
+        { return lambdaRunIterations(rng.begin(), rng.end(), res); },
+        [](const Hypothesis& a, const Hypothesis& b)
+        { return a.better_than(b) ? a : b; });
+#else
+    const Hypothesis best =
+        lambdaRunIterations(0, p.ransac_iterations, Hypothesis());
+#endif
+
+    if (best.inliers < 3) return r;
+
+    // Least-squares refinement over all inliers:
+    r.optimalPose = best.pose;
+    std::vector<std::size_t> inliers, newInliers;
+    findInliers(local, global, corrs, best.pose, inlierThresSqr, inliers);
+    for (int refineIter = 0; refineIter < 3; refineIter++)
+    {
+        const auto refined = solveHorn(local, global, corrs, inliers);
+        if (!refined) break;
+
+        findInliers(
+            local, global, corrs, *refined, inlierThresSqr, newInliers);
+        if (newInliers.size() < inliers.size()) break;
+
+        r.optimalPose = *refined;
+        inliers.swap(newInliers);
+    }
+
+    r.inliers = inliers.size();
+    r.success = r.inliers >= p.min_inliers;
+
+    return r;
+
+    MRPT_END
+}
+
+GlobalRegistrationResult mp2p_icp::global_registration(
+    const metric_map_t& pcLocal, const metric_map_t& pcGlobal,
+    const GlobalRegistrationParameters& p)
+{
+    MRPT_START
+
+    const auto localPts  = pcLocal.point_layer(p.local_layer);
+    const auto globalPts = pcGlobal.point_layer(p.global_layer);
+    ASSERTMSG_(
+        localPts && globalPts,
+        "global_registration: empty local or global point layer");
+
+    const PointFeatures localFeats  = compute_fpfh_features(*localPts, p);
+    const PointFeatures globalFeats = compute_fpfh_features(*globalPts, p);
+
+    const auto corrs = match_features(localFeats, globalFeats, p.mutual_filter);
+
+    return ransac_registration(localFeats, globalFeats, corrs, p);
+
+    MRPT_END
+}
+
+GlobalRegistrationResult mp2p_icp::align_with_global_registration(
+    ICP& icp, const metric_map_t& pcLocal, const metric_map_t& pcGlobal,
+    const GlobalRegistrationParameters& grp, const Parameters& icpParams,
+    Results&                                  result,
+    const std::optional<mrpt::math::TPose3D>& fallbackInitialGuess)
+{
+    MRPT_START
+
+    const auto gr = global_registration(pcLocal, pcGlobal, grp);
+
+    std::optional<mrpt::math::TPose3D> initGuess;
+    if (gr.success)
+        initGuess = gr.optimalPose.asTPose();
+    else
+        initGuess = fallbackInitialGuess;
+
+    result = Results();
+    if (initGuess)
+        icp.align(pcLocal, pcGlobal, *initGuess, icpParams, result);
+
+    return gr;
+
+    MRPT_END
+}
@@ -13,10 +13,14 @@
 #include <mp2p_icp/errorTerms.h>
 #include <mp2p_icp/optimal_tf_gauss_newton.h>
 #include <mp2p_icp/robust_kernels.h>
+#include <mrpt/core/bits_math.h>
 #include <mrpt/poses/Lie/SE.h>
 
 #include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <type_traits>
 
 #if defined(MP2P_HAS_TBB)
 #include <tbb/blocked_range.h>
@@ -25,6 +29,155 @@
 
 using namespace mp2p_icp;
 
+namespace
+{
+/** g += w * J^T * err, and H += w * J^T * J, updating only the upper
+ * triangle of H. */
+template <typename Scalar, typename DerivedJ, typename DerivedE>
+void accumulate_upper(
+    Eigen::Matrix<Scalar, 6, 6>& H, Eigen::Matrix<Scalar, 6, 1>& g,
+    const Eigen::MatrixBase<DerivedJ>& J,
+    const Eigen::MatrixBase<DerivedE>& err, const Scalar w)
+{
+    for (int c = 0; c < 6; c++)
+    {
+        const auto wJc = (w * J.col(c)).eval();
+        g[c] += wJc.dot(err);
+        for (int r = 0; r <= c; r++) H(r, c) += wJc.dot(J.col(r));
+    }
+}
+
+/** The linearization point, in the precision used to evaluate the terms of
+ * point-to-point and point-to-plane pairings. */
+template <typename T>
+struct LinearizationPoint
+{
+    using Scalar = T;
+
+    explicit LinearizationPoint(const mrpt::poses::CPose3D& p)
+        : R(p.getRotationMatrix().asEigen().template cast<T>()),
+          t(p.x(), p.y(), p.z())
+    {
+    }
+
+    Eigen::Matrix<T, 3, 3>      R;
+    Eigen::Matrix<double, 3, 1> t;  //!< Kept in double, see below
+};
+
+/** Jacobian of R*l+t wrt an SE(3) increment: [R | -R*[l]x] */
+template <typename T>
+Eigen::Matrix<T, 3, 6> jacob_point_se3(
+    const Eigen::Matrix<T, 3, 3>& R, const Eigen::Matrix<T, 3, 1>& l)
+{
+    Eigen::Matrix<T, 3, 6> J;
+    J.template block<3, 3>(0, 0) = R;
+    J.col(3)                     = R.col(2) * l.y() - R.col(1) * l.z();
+    J.col(4)                     = R.col(0) * l.z() - R.col(2) * l.x();
+    J.col(5)                     = R.col(1) * l.x() - R.col(0) * l.y();
+    return J;
+}
+
+/** Projector onto the span of the eigenvectors of H whose eigenvalues are, at
+ * least, `relThreshold` times the largest one. */
+Eigen::Matrix<double, 6, 6> well_constrained_projector(
+    const Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 6, 6>>& es,
+    const double relThreshold)
+{
+    // Eigenvalues are in ascending order:
+    const auto&  lambdas = es.eigenvalues();
+    const auto&  V       = es.eigenvectors();
+    const double minEig  = relThreshold * lambdas[5];
+
+    Eigen::Matrix<double, 6, 6> P = Eigen::Matrix<double, 6, 6>::Zero();
+    for (int i = 0; i < 6; i++)
+    {
+        if (lambdas[i] < minEig) continue;
+        P.noalias() += V.col(i) * V.col(i).transpose();
+    }
+    return P;
+}
+
+// Partial sums of the linear system, in double precision.
+// For the TBB lambdas:
+// TBB call structure based on the beautiful implementation in KISS-ICP.
+struct Result
+{
+    Result()
+    {
+        H.setZero();
+        g.setZero();
+    }
+
+    Result operator+(const Result& other)
+    {
+        H += other.H;
+        g += other.g;
+        errNormSqr += other.errNormSqr;
+        return *this;
+    }
+
+    Eigen::Matrix<double, 6, 6> H;
+    Eigen::Matrix<double, 6, 1> g;
+    double                      errNormSqr = 0;
+};
+
+/** Evaluates `kernel(i, H, g, errNormSqr)` for all pairings i=[0,n), in
+ * parallel if built with TBB, in the precision `Scalar`.
+ *
+ * Terms are summed in `Scalar` over short blocks of pairings only, then each
+ * block sum is added to the double precision result. With `Scalar=float`,
+ * this keeps the accumulated rounding error independent of the number of
+ * pairings, while the costly per-pairing operations run in single precision.
+ */
+template <typename Scalar, class KERNEL>
+Result accumulate_pairings(const std::size_t n, const KERNEL& kernel)
+{
+    const auto lambdaRange =
+        [&kernel](const std::size_t i0, const std::size_t i1, Result& res)
+    {
+        constexpr std::size_t BLOCK_LENGTH = 64;
+
+        Eigen::Matrix<Scalar, 6, 6> Hb;
+        Eigen::Matrix<Scalar, 6, 1> gb;
+        Scalar                      eb;
+
+        for (std::size_t b0 = i0; b0 < i1; b0 += BLOCK_LENGTH)
+        {
+            Hb.setZero();
+            gb.setZero();
+            eb = 0;
+
+            const std::size_t b1 = std::min(i1, b0 + BLOCK_LENGTH);
+            for (std::size_t i = b0; i < b1; i++) kernel(i, Hb, gb, eb);
+
+            res.H += Hb.template cast<double>();
+            res.g += gb.template cast<double>();
+            res.errNormSqr += eb;
+        }
+    };
+
+#if defined(MP2P_HAS_TBB)
+    return tbb::parallel_reduce(
+        // Range
+        tbb::blocked_range<std::size_t>{0, n},
+        // Identity
+        Result(),
+        // 1st lambda: Parallel computation
+        [&](const tbb::blocked_range<std::size_t>& r, Result res) -> Result
+        {
+            lambdaRange(r.begin(), r.end(), res);
+            return res;
+        },
+        // 2nd lambda: Parallel reduction
+        [](Result a, const Result& b) -> Result { return a + b; });
+#else
+    Result res;
+    lambdaRange(0, n, res);
+    return res;
+#endif
+}
+}  // namespace
+
 bool mp2p_icp::optimal_tf_gauss_newton(
     const Pairings& in, OptimalTF_Result& result,
     const OptimalTF_GN_Parameters& gnParams)
@@ -50,278 +203,204 @@ bool mp2p_icp::optimal_tf_gauss_newton(
     const auto nPl2Pl = in.paired_pl2pl.size();
     const auto nLn2Ln = in.paired_ln2ln.size();
 
-    // Note: Using Matrix<N,1> instead of Vector<N> for compatibility
-    //       with Eigen<=3.4 in ROS Noetic.
-    Eigen::Matrix<double, 6, 1> g = Eigen::Matrix<double, 6, 1>::Zero();
-    Eigen::Matrix<double, 6, 6> H = Eigen::Matrix<double, 6, 6>::Zero();
-
-    auto w = gnParams.pairWeights;
+    const auto& w = gnParams.pairWeights;
 
-    const bool  has_per_pt_weight       = !in.point_weights.empty();
-    auto        cur_point_block_weights = in.point_weights.begin();
-    std::size_t cur_point_block_start   = 0;
-
-    for (size_t iter = 0; iter < gnParams.maxInnerLoopIterations; iter++)
+    // Per-point weights: end index of each block in in.point_weights, so
+    // the weight of any point can be looked up from parallel threads:
+    std::vector<std::size_t> pointWeightBlockEnds;
+    pointWeightBlockEnds.reserve(in.point_weights.size());
+    for (const auto& [count, _] : in.point_weights)
     {
-        // (12x6 Jacobian)
-        const auto dDexpe_de =
-            mrpt::poses::Lie::SE<3>::jacob_dDexpe_de(result.optimalPose);
+        pointWeightBlockEnds.push_back(
+            (pointWeightBlockEnds.empty() ? 0 : pointWeightBlockEnds.back()) +
+            count);
+    }
 
+    const auto lambdaPt2PtWeight = [&](const std::size_t idx_pt) -> double
+    {
+        if (pointWeightBlockEnds.empty()) return w.pt2pt;
+
+        const auto it = std::upper_bound(
+            pointWeightBlockEnds.begin(), pointWeightBlockEnds.end(), idx_pt);
+        ASSERT_(it != pointWeightBlockEnds.end());
+        return in.point_weights[it - pointWeightBlockEnds.begin()].second;
+    };
+
+    // Builds the linear system (H,g) at the given pose, and returns the
+    // cost (weighted sum of squared errors) there:
+    const auto lambdaLinearize = [&](const mrpt::poses::CPose3D& pose,
+                                     Eigen::Matrix<double, 6, 6>& H,
+                                     Eigen::Matrix<double, 6, 1>& g) -> double
+    {
+        H.setZero();
+        g.setZero();
         double errNormSqr = 0;
 
-#if defined(MP2P_HAS_TBB)
-        // For the TBB lambdas:
-        // TBB call structure based on the beautiful implementation in KISS-ICP.
-        struct Result
+        const LinearizationPoint<double> lpD(pose);
+        const LinearizationPoint<float>  lpF(pose);
+
+        // Kernels for point-to-point and point-to-plane pairings, evaluated
+        // in the precision of the given linearization point.
+        // Translations are handled in double precision, and only the small
+        // differences are converted to `Scalar`, so the single precision
+        // path keeps its accuracy in maps with large coordinates.
+        const auto lambdaPt2PtKernel = [&](const auto& lp)
         {
-            Result()
-            {
-                H.setZero();
-                g.setZero();
-            }
+            using Scalar = typename std::decay_t<decltype(lp)>::Scalar;
+            using Vec3   = Eigen::Matrix<Scalar, 3, 1>;
 
-            Result operator+(const Result& other)
+            return [&](const std::size_t idx_pt,
+                       Eigen::Matrix<Scalar, 6, 6>& Hb,
+                       Eigen::Matrix<Scalar, 6, 1>& gb, Scalar& errSqrSum)
             {
-                H += other.H;
-                g += other.g;
-                return *this;
-            }
-
-            Eigen::Matrix<double, 6, 6> H;
-            Eigen::Matrix<double, 6, 1> g;
+                const auto& p = in.paired_pt2pt[idx_pt];
+
+                const Vec3 l(p.local.x, p.local.y, p.local.z);
+                const Vec3 gRel(
+                    p.global.x - lp.t.x(), p.global.y - lp.t.y(),
+                    p.global.z - lp.t.z());
+
+                // Error and Jacobian:
+                const Vec3 ret = lp.R * l - gRel;
+                const auto Ji  = jacob_point_se3(lp.R, l);
+
+                // Apply robust kernel?
+                const Scalar retSqrNorm = ret.squaredNorm();
+                double       weight     = lambdaPt2PtWeight(idx_pt);
+                if (robustSqrtWeightFunc)
+                    weight *= robustSqrtWeightFunc(retSqrNorm);
+
+                errSqrSum += static_cast<Scalar>(weight) * retSqrNorm;
+                accumulate_upper(Hb, gb, Ji, ret, static_cast<Scalar>(weight));
+            };
         };
 
-        const auto& [H_tbb_pt2pt, g_tbb_pt2pt] = tbb::parallel_reduce(
-            // Range
-            tbb::blocked_range<size_t>{0, nPt2Pt},
-            // Identity
-            Result(),
-            // 1st lambda: Parallel computation
-            [&](const tbb::blocked_range<size_t>& r, Result res) -> Result
-            {
-                auto& [H_local, g_local] = res;
-                for (size_t idx_pt = r.begin(); idx_pt < r.end(); idx_pt++)
-                {
-                    // Error:
-                    const auto& p = in.paired_pt2pt[idx_pt];
-                    mrpt::math::CMatrixFixed<double, 3, 12> J1;
-                    mrpt::math::CVectorFixedDouble<3>       ret =
-                        mp2p_icp::error_point2point(p, result.optimalPose, J1);
-
-                    // Get point weight:
-                    if (has_per_pt_weight)
-                    {
-                        if (idx_pt >= cur_point_block_start +
-                                          cur_point_block_weights->first)
-                        {
-                            ASSERT_(
-                                cur_point_block_weights !=
-                                in.point_weights.end());
-                            ++cur_point_block_weights;  // move to next block
-                            cur_point_block_start = idx_pt;
-                        }
-                        w.pt2pt = cur_point_block_weights->second;
-                    }
-
-                    // Apply robust kernel?
-                    double weight     = w.pt2pt,
-                           retSqrNorm = ret.asEigen().squaredNorm();
-                    if (robustSqrtWeightFunc)
-                        weight *= robustSqrtWeightFunc(retSqrNorm);
-
-                    // Error and Jacobian:
-                    const Eigen::Vector3d err_i = ret.asEigen();
-                    errNormSqr += weight * retSqrNorm;
-
-                    const Eigen::Matrix<double, 3, 6> Ji =
-                        J1.asEigen() * dDexpe_de.asEigen();
-                    g_local.noalias() += weight * Ji.transpose() * err_i;
-                    H_local.noalias() += weight * Ji.transpose() * Ji;
-                }
-                return res;
-            },
-            // 2nd lambda: Parallel reduction
-            [](Result a, const Result& b) -> Result { return a + b; });
-
-        H = std::move(H_tbb_pt2pt);
-        g = std::move(g_tbb_pt2pt);
-#else
-        // Point-to-point:
-        for (size_t idx_pt = 0; idx_pt < nPt2Pt; idx_pt++)
+        const auto lambdaPt2PlKernel = [&](const auto& lp)
         {
-            // Error:
-            const auto&                             p = in.paired_pt2pt[idx_pt];
-            mrpt::math::CMatrixFixed<double, 3, 12> J1;
-            mrpt::math::CVectorFixedDouble<3>       ret =
-                mp2p_icp::error_point2point(p, result.optimalPose, J1);
-
-            // Get point weight:
-            if (has_per_pt_weight)
+            using Scalar = typename std::decay_t<decltype(lp)>::Scalar;
+            using Vec3   = Eigen::Matrix<Scalar, 3, 1>;
+
+            return [&](const std::size_t idx_pl,
+                       Eigen::Matrix<Scalar, 6, 6>& Hb,
+                       Eigen::Matrix<Scalar, 6, 1>& gb, Scalar& errSqrSum)
             {
-                if (idx_pt >=
-                    cur_point_block_start + cur_point_block_weights->first)
-                {
-                    ASSERT_(cur_point_block_weights != in.point_weights.end());
-                    ++cur_point_block_weights;  // move to next block
-                    cur_point_block_start = idx_pt;
-                }
-                w.pt2pt = cur_point_block_weights->second;
-            }
+                // (Scalar point-to-plane distance)
+                const auto& p = in.paired_pt2pl[idx_pl];
 
-            // Apply robust kernel?
-            double weight = w.pt2pt, retSqrNorm = ret.asEigen().squaredNorm();
-            if (robustSqrtWeightFunc)
-                weight *= robustSqrtWeightFunc(retSqrNorm);
+                const Vec3 l(p.pt_local.x, p.pt_local.y, p.pt_local.z);
+                const Vec3 n(p.normal.x, p.normal.y, p.normal.z);
 
-            // Error and Jacobian:
-            const Eigen::Vector3d err_i = ret.asEigen();
-            errNormSqr += weight * retSqrNorm;
+                // Plane offset, once translated by the pose:
+                const double offsetRel = p.normal.x * lp.t.x() +
+                                         p.normal.y * lp.t.y() +
+                                         p.normal.z * lp.t.z() + p.offset;
 
-            const Eigen::Matrix<double, 3, 6> Ji =
-                J1.asEigen() * dDexpe_de.asEigen();
-            g.noalias() += weight * Ji.transpose() * err_i;
-            H.noalias() += weight * Ji.transpose() * Ji;
-        }
-#endif
+                // Error and Jacobian:
+                Eigen::Matrix<Scalar, 1, 1> ret;
+                ret[0] = n.dot(lp.R * l) + static_cast<Scalar>(offsetRel);
+
+                const Eigen::Matrix<Scalar, 1, 6> Ji =
+                    n.transpose() * jacob_point_se3(lp.R, l);
+
+                // Apply robust kernel?
+                const Scalar retSqrNorm = ret[0] * ret[0];
+                double       weight     = w.pt2pl;
+                if (robustSqrtWeightFunc)
+                    weight *= robustSqrtWeightFunc(retSqrNorm);
+
+                errSqrSum += static_cast<Scalar>(weight) * retSqrNorm;
+                accumulate_upper(Hb, gb, Ji, ret, static_cast<Scalar>(weight));
+            };
+        };
+
+        // Point-to-point:
+        const Result res_pt2pt =
+            gnParams.singlePrecision
+                ? accumulate_pairings<float>(nPt2Pt, lambdaPt2PtKernel(lpF))
+                : accumulate_pairings<double>(nPt2Pt, lambdaPt2PtKernel(lpD));
+
+        H += res_pt2pt.H;
+        g += res_pt2pt.g;
+        errNormSqr += res_pt2pt.errNormSqr;
 
         // Point-to-line
         for (size_t idx_pt = 0; idx_pt < nPt2Ln; idx_pt++)
         {
-            // Error
-            const auto&                             p = in.paired_pt2ln[idx_pt];
-            mrpt::math::CMatrixFixed<double, 3, 12> J1;
-            mrpt::math::CVectorFixedDouble<3>       ret =
-                mp2p_icp::error_point2line(p, result.optimalPose, J1);
+            // Error and Jacobian:
+            const auto&                            p = in.paired_pt2ln[idx_pt];
+            mrpt::math::CMatrixFixed<double, 3, 6> Ji;
+            mrpt::math::CVectorFixedDouble<3>      ret =
+                mp2p_icp::error_point2line(p, pose, Ji);
 
             // Apply robust kernel?
             double weight = w.pt2ln, retSqrNorm = ret.asEigen().squaredNorm();
             if (robustSqrtWeightFunc)
                 weight *= robustSqrtWeightFunc(retSqrNorm);
 
-            // Error and Jacobian:
-            const Eigen::Vector3d err_i = ret.asEigen();
-            errNormSqr += weight * weight * retSqrNorm;
-
-            const Eigen::Matrix<double, 3, 6> Ji =
-                J1.asEigen() * dDexpe_de.asEigen();
-            g.noalias() += weight * Ji.transpose() * err_i;
-            H.noalias() += weight * Ji.transpose() * Ji;
+            errNormSqr += weight * retSqrNorm;
+            accumulate_upper(H, g, Ji.asEigen(), ret.asEigen(), weight);
         }
 
         // Line-to-Line
         // Minimum angle to approach zero
-        for (size_t idx_ln = 0; idx_ln < nLn2Ln; idx_ln++)
+        if (nLn2Ln != 0)
         {
-            const auto&                             p = in.paired_ln2ln[idx_ln];
-            mrpt::math::CMatrixFixed<double, 4, 12> J1;
-            mrpt::math::CVectorFixedDouble<4>       ret =
-                mp2p_icp::error_line2line(p, result.optimalPose, J1);
+            // (12x6 Jacobian)
+            const auto dDexpe_de =
+                mrpt::poses::Lie::SE<3>::jacob_dDexpe_de(pose);
 
-            // Apply robust kernel?
-            double weight = w.ln2ln, retSqrNorm = ret.asEigen().squaredNorm();
-            if (robustSqrtWeightFunc)
-                weight *= robustSqrtWeightFunc(retSqrNorm);
-
-            // Error and Jacobian:
-            const Eigen::Vector4d err_i = ret.asEigen();
-            errNormSqr += weight * weight * retSqrNorm;
-
-            const Eigen::Matrix<double, 4, 6> Ji =
-                J1.asEigen() * dDexpe_de.asEigen();
-            g.noalias() += weight * Ji.transpose() * err_i;
-            H.noalias() += weight * Ji.transpose() * Ji;
+            for (size_t idx_ln = 0; idx_ln < nLn2Ln; idx_ln++)
+            {
+                const auto& p = in.paired_ln2ln[idx_ln];
+                mrpt::math::CMatrixFixed<double, 4, 12> J1;
+                mrpt::math::CVectorFixedDouble<4>       ret =
+                    mp2p_icp::error_line2line(p, pose, J1);
+
+                // Apply robust kernel?
+                double weight     = w.ln2ln,
+                       retSqrNorm = ret.asEigen().squaredNorm();
+                if (robustSqrtWeightFunc)
+                    weight *= robustSqrtWeightFunc(retSqrNorm);
+
+                errNormSqr += weight * retSqrNorm;
+
+                const mrpt::math::CMatrixFixed<double, 4, 6> Ji(
+                    J1.asEigen() * dDexpe_de.asEigen());
+                accumulate_upper(H, g, Ji.asEigen(), ret.asEigen(), weight);
+            }
         }
 
-#if defined(MP2P_HAS_TBB)
         // Point-to-plane:
-        const auto& [H_tbb_pt2pl, g_tbb_pt2pl] = tbb::parallel_reduce(
-            // Range
-            tbb::blocked_range<size_t>{0, nPt2Pl},
-            // Identity
-            Result(),
-            // 1st lambda: Parallel computation
-            [&](const tbb::blocked_range<size_t>& r, Result res) -> Result
-            {
-                auto& [H_local, g_local] = res;
-                for (size_t idx_pl = r.begin(); idx_pl < r.end(); idx_pl++)
-                {
-                    // Error:
-                    const auto& p = in.paired_pt2pl[idx_pl];
-                    mrpt::math::CMatrixFixed<double, 3, 12> J1;
-                    mrpt::math::CVectorFixedDouble<3>       ret =
-                        mp2p_icp::error_point2plane(p, result.optimalPose, J1);
-
-                    // Apply robust kernel?
-                    double weight     = w.pt2pl,
-                           retSqrNorm = ret.asEigen().squaredNorm();
-                    if (robustSqrtWeightFunc)
-                        weight *= robustSqrtWeightFunc(retSqrNorm);
-
-                    // Error and Jacobian:
-                    const Eigen::Vector3d err_i = ret.asEigen();
-                    errNormSqr += weight * retSqrNorm;
-
-                    const Eigen::Matrix<double, 3, 6> Ji =
-                        J1.asEigen() * dDexpe_de.asEigen();
-                    g_local.noalias() += weight * Ji.transpose() * err_i;
-                    H_local.noalias() += weight * Ji.transpose() * Ji;
-                }
-                return res;
-            },
-            // 2nd lambda: Parallel reduction
-            [](Result a, const Result& b) -> Result { return a + b; });
-
-        H += H_tbb_pt2pl;
-        g += g_tbb_pt2pl;
-#else
-        // Point-to-plane:
-        for (size_t idx_pl = 0; idx_pl < nPt2Pl; idx_pl++)
-        {
-            // Error:
-            const auto&                             p = in.paired_pt2pl[idx_pl];
-            mrpt::math::CMatrixFixed<double, 3, 12> J1;
-            mrpt::math::CVectorFixedDouble<3>       ret =
-                mp2p_icp::error_point2plane(p, result.optimalPose, J1);
+        const Result res_pt2pl =
+            gnParams.singlePrecision
+                ? accumulate_pairings<float>(nPt2Pl, lambdaPt2PlKernel(lpF))
+                : accumulate_pairings<double>(nPt2Pl, lambdaPt2PlKernel(lpD));
 
-            // Apply robust kernel?
-            double weight = w.pt2pl, retSqrNorm = ret.asEigen().squaredNorm();
-            if (robustSqrtWeightFunc)
-                weight *= robustSqrtWeightFunc(retSqrNorm);
-
-            // Error and Jacobian:
-            const Eigen::Vector3d err_i = ret.asEigen();
-            errNormSqr += weight * weight * retSqrNorm;
-
-            const Eigen::Matrix<double, 3, 6> Ji =
-                J1.asEigen() * dDexpe_de.asEigen();
-            g.noalias() += weight * Ji.transpose() * err_i;
-            H.noalias() += weight * Ji.transpose() * Ji;
-        }
-#endif
+        H += res_pt2pl.H;
+        g += res_pt2pl.g;
+        errNormSqr += res_pt2pl.errNormSqr;
 
         // Plane-to-plane (only direction of normal vectors):
         for (size_t idx_pl = 0; idx_pl < nPl2Pl; idx_pl++)
         {
-            // Error term:
-            const auto&                             p = in.paired_pl2pl[idx_pl];
-            mrpt::math::CMatrixFixed<double, 3, 12> J1;
-            mrpt::math::CVectorFixedDouble<3>       ret =
-                mp2p_icp::error_plane2plane(p, result.optimalPose, J1);
+            // Error term and Jacobian:
+            const auto&                            p = in.paired_pl2pl[idx_pl];
+            mrpt::math::CMatrixFixed<double, 3, 6> Ji;
+            mrpt::math::CVectorFixedDouble<3>      ret =
+                mp2p_icp::error_plane2plane(p, pose, Ji);
 
             // Apply robust kernel?
             double weight = w.pl2pl, retSqrNorm = ret.asEigen().squaredNorm();
             if (robustSqrtWeightFunc)
                 weight *= robustSqrtWeightFunc(retSqrNorm);
 
-            const Eigen::Vector3d err_i = ret.asEigen();
-            errNormSqr += weight * weight * retSqrNorm;
-
-            const Eigen::Matrix<double, 3, 6> Ji =
-                J1.asEigen() * dDexpe_de.asEigen();
-            g.noalias() += weight * Ji.transpose() * err_i;
-            H.noalias() += weight * Ji.transpose() * Ji;
+            errNormSqr += weight * retSqrNorm;
+            accumulate_upper(H, g, Ji.asEigen(), ret.asEigen(), weight);
         }
 
+        // Only the upper triangle has been accumulated so far:
+        H.triangularView<Eigen::StrictlyLower>() = H.transpose();
+
         // Prior guess term:
         if (gnParams.prior.has_value())
         {
@@ -333,7 +412,7 @@ bool mp2p_icp::optimal_tf_gauss_newton(
             // SE(3) error = inv(P_prior) * P_current
             //             = (P_current \ominus P_prior)
 
-            const mrpt::poses::CPose3D P1invP2 = result.optimalPose - priorMean;
+            const mrpt::poses::CPose3D P1invP2 = pose - priorMean;
             const auto err_i = mrpt::poses::Lie::SE<3>::log(P1invP2);
 
             mrpt::math::CMatrixDouble66 df_de2;
@@ -344,12 +423,15 @@ bool mp2p_icp::optimal_tf_gauss_newton(
                 // P1:
                 priorMean,
                 // P2:
-                result.optimalPose,
+                pose,
                 // df_de1
                 std::nullopt,
                 // df_de2
                 df_de2);
 
+            errNormSqr +=
+                err_i.asEigen().dot(priorInf.asEigen() * err_i.asEigen());
+
             g.noalias() +=
                 (df_de2.transpose() * priorInf.asEigen()) * err_i.asEigen();
 
@@ -357,33 +439,128 @@ bool mp2p_icp::optimal_tf_gauss_newton(
                 (df_de2.transpose() * priorInf.asEigen()) * df_de2.asEigen();
         }
 
-        // Target error?
-        const double errNorm = std::sqrt(errNormSqr);
+        return errNormSqr;
+    };
 
-        if (errNorm <= gnParams.maxCost) break;
+    // Note: Using Matrix<N,1> instead of Vector<N> for compatibility
+    //       with Eigen<=3.4 in ROS Noetic.
+    Eigen::Matrix<double, 6, 1> g = Eigen::Matrix<double, 6, 1>::Zero();
+    Eigen::Matrix<double, 6, 6> H = Eigen::Matrix<double, 6, 6>::Zero();
+
+    const bool useLM =
+        gnParams.stepControl == GNStepControl::LevenbergMarquardt;
 
-        // 3) Solve Gauss-Newton:
+    double cost = lambdaLinearize(result.optimalPose, H, g);
+
+    // LM damping, and its increase factor upon rejected steps:
+    double lambda = useLM ? gnParams.lmInitialLambda * H.diagonal().maxCoeff()
+                          : 0.0;
+    double nu     = 2.0;
+
+    for (size_t iter = 0; iter < gnParams.maxInnerLoopIterations; iter++)
+    {
+        // Target error?
+        if (std::sqrt(cost) <= gnParams.maxCost) break;
+
+        // Solve the (damped) normal equations:
         // g = J.transpose() * err;
         // H = J.transpose() * J;
-        const Eigen::Matrix<double, 6, 1> delta = -H.ldlt().solve(g);
+        Eigen::Matrix<double, 6, 6> A = H;
+        A.diagonal().array() += lambda;
+
+        Eigen::Matrix<double, 6, 1> delta = -A.ldlt().solve(g);
+
+        // Solution remapping: drop the components of the step along
+        // degenerate directions:
+        if (gnParams.degeneracyThreshold > 0)
+        {
+            const Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 6, 6>>
+                es(H);
+            delta = well_constrained_projector(
+                        es, gnParams.degeneracyThreshold) *
+                    delta;
+        }
+
+        const double deltaNorm = delta.norm();
+
+        auto& info    = result.iterations.emplace_back();
+        info.cost     = cost;
+        info.stepNorm = deltaNorm;
+        info.lambda   = lambda;
 
-        // 4) add SE(3) increment:
+        // Add SE(3) increment:
         const auto dE = mrpt::poses::Lie::SE<3>::exp(
             mrpt::math::CVectorFixed<double, 6>(delta));
 
-        result.optimalPose = result.optimalPose + dE;
+        const mrpt::poses::CPose3D newPose = result.optimalPose + dE;
+
+        const bool isLastIter = (iter + 1 == gnParams.maxInnerLoopIterations);
+
+        if (!useLM)
+        {
+            result.optimalPose = newPose;
+            if (!isLastIter && deltaNorm >= gnParams.minDelta)
+                cost = lambdaLinearize(result.optimalPose, H, g);
+        }
+        else
+        {
+            // Gain ratio: actual vs predicted (by the quadratic model) cost
+            // reduction:
+            Eigen::Matrix<double, 6, 6> newH;
+            Eigen::Matrix<double, 6, 1> newG;
+            const double newCost = lambdaLinearize(newPose, newH, newG);
+
+            const double predicted =
+                -(2 * g.dot(delta) + delta.dot(H * delta));
+            const double rho =
+                predicted > 0 ? (cost - newCost) / predicted : -1.0;
+
+            if (rho > 0)
+            {
+                result.optimalPose = newPose;
+                H                  = newH;
+                g                  = newG;
+                cost               = newCost;
+                lambda *= std::max(1.0 / 3, 1 - std::pow(2 * rho - 1, 3));
+                nu = 2.0;
+            }
+            else
+            {
+                info.accepted = false;
+                lambda *= nu;
+                nu *= 2;
+            }
+        }
 
         if (gnParams.verbose)
         {
-            std::cout << "[P2P GN] iter:" << iter << " err:" << errNorm
+            std::cout << "[P2P GN] iter:" << iter << " err:" << std::sqrt(cost)
+                      << " lambda:" << info.lambda
+                      << " accepted:" << info.accepted
                       << " delta:" << delta.transpose() << "\n";
         }
 
         // Simple convergence test:
-        if (delta.norm() < gnParams.minDelta) break;
+        if (deltaNorm < gnParams.minDelta) break;
 
     }  // for each iteration
 
+    // Degeneracy telemetry:
+    {
+        const bool withProjector = gnParams.degeneracyThreshold > 0;
+
+        const Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 6, 6>> es(
+            H, withProjector ? Eigen::ComputeEigenvectors
+                             : Eigen::EigenvaluesOnly);
+        result.hessianEigenvalues.emplace(es.eigenvalues());
+
+        if (withProjector)
+        {
+            result.wellConstrainedProjector.emplace(
+                well_constrained_projector(es, gnParams.degeneracyThreshold));
+        }
+    }
+
     return true;
 
     MRPT_END
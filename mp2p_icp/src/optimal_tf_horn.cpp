@@ -15,6 +15,8 @@
 #include <mrpt/math/CQuaternion.h>
 #include <mrpt/math/CVectorFixed.h>
 
+#include <Eigen/Dense>
+
 #include "visit_correspondences.h"
 
 using namespace mp2p_icp;
@@ -90,26 +92,28 @@ static bool se3_l2_internal(
     // Horn method needs at least 3 references
     if (nAllMatches < 3) return false;
 
-    auto S = mrpt::math::CMatrixDouble33::Zero();
+    Eigen::Matrix3d S = Eigen::Matrix3d::Zero();
 
     // Lambda: process each pairing:
-    auto lambda_each_pair = [&](const mrpt::math::TVector3D& bi,
-                                const mrpt::math::TVector3D& ri,
-                                const double                 wi) {
+    // (Called from parallel threads, each one with its own "acc")
+    auto lambda_each_pair = [](Eigen::Matrix3d&             acc,
+                               const mrpt::math::TVector3D& bi,
+                               const mrpt::math::TVector3D& ri,
+                               const double                 wi) {
         // These vectors are already direction vectors, or the
         // centroids-centered relative positions of points. Compute the S matrix
         // of cross products.
-        S(0, 0) += wi * ri.x * bi.x;
-        S(0, 1) += wi * ri.x * bi.y;
-        S(0, 2) += wi * ri.x * bi.z;
+        acc(0, 0) += wi * ri.x * bi.x;
+        acc(0, 1) += wi * ri.x * bi.y;
+        acc(0, 2) += wi * ri.x * bi.z;
 
-        S(1, 0) += wi * ri.y * bi.x;
-        S(1, 1) += wi * ri.y * bi.y;
-        S(1, 2) += wi * ri.y * bi.z;
+        acc(1, 0) += wi * ri.y * bi.x;
+        acc(1, 1) += wi * ri.y * bi.y;
+        acc(1, 2) += wi * ri.y * bi.z;
 
-        S(2, 0) += wi * ri.z * bi.x;
-        S(2, 1) += wi * ri.z * bi.y;
-        S(2, 2) += wi * ri.z * bi.z;
+        acc(2, 0) += wi * ri.z * bi.x;
+        acc(2, 1) += wi * ri.z * bi.y;
+        acc(2, 2) += wi * ri.z * bi.z;
     };
 
     auto lambda_final = [&](const double w_sum) {
@@ -118,7 +122,7 @@ static bool se3_l2_internal(
     };
 
     visit_correspondences(
-        in, wp, ct_local, ct_global, in_out_outliers /*in/out*/,
+        in, wp, ct_local, ct_global, in_out_outliers /*in/out*/, S,
         // Operations to run on pairs:
         lambda_each_pair, lambda_final,
         false /* do not make unit point vectors for Horn */);
@@ -73,10 +73,12 @@ static OLAE_LinearSystems olae_build_linear_system(
     // Attitude profile matrix:
     res.B = Eigen::Matrix3d::Zero();
 
-    // Lambda: process each pairing:
-    auto lambda_each_pair = [&](const mrpt::math::TVector3D& bi,
-                                const mrpt::math::TVector3D& ri,
-                                const double                 wi) {
+    // Lambda: process each pairing, accumulating the attitude profile matrix
+    // (Called from parallel threads, each one with its own "B")
+    auto lambda_each_pair = [](Eigen::Matrix3d&             B,
+                               const mrpt::math::TVector3D& bi,
+                               const mrpt::math::TVector3D& ri,
+                               const double                 wi) {
 // We will evaluate M from an alternative expression below from the
 // attitude profile matrix B instead, since it seems to be slightly more
 // stable, numerically. The original code for M is left here for
@@ -116,36 +118,23 @@ static OLAE_LinearSystems olae_build_linear_system(
     // The missing (1/2) from the formulas above:
     res.M *= 0.5;
 #endif
-        /* v-= weight *  [b_i]_{x}  r_i
-         *  Each term is:
-         *  ⎡by⋅rz - bz⋅ry ⎤   ⎡ B23 - B32 ⎤
-         *  ⎢              ⎥   |           ⎥
-         *  ⎢-bx⋅rz + bz⋅rx⎥ = | B31 - B13 ⎥
-         *  ⎢              ⎥   |           ⎥
-         *  ⎣bx⋅ry - by⋅rx ⎦   ⎣ B12 - B21 ⎦
-         *
-         * B (attitude profile matrix):
+        /* B (attitude profile matrix):
          *
          * B+= weight * (b_i * r_i')
          *
+         * Note that "v" is evaluated from B afterwards.
          */
+        B(0, 0) += wi * bi.x * ri.x;
+        B(0, 1) += wi * bi.x * ri.y;
+        B(0, 2) += wi * bi.x * ri.z;
 
-        // clang-format off
-    const auto dV = (Eigen::Vector3d() <<
-       (bi.y * ri.z - bi.z * ri.y),
-       (-bi.x * ri.z + bi.z * ri.x),
-       (bi.x * ri.y - bi.y * ri.x) ).finished();
-        // clang-format on
-
-        res.v -= wi * dV;
+        B(1, 0) += wi * bi.y * ri.x;
+        B(1, 1) += wi * bi.y * ri.y;
+        B(1, 2) += wi * bi.y * ri.z;
 
-        // clang-format off
-    const auto dB = (Eigen::Matrix3d() <<
-       bi.x * ri.x, bi.x * ri.y, bi.x * ri.z,
-       bi.y * ri.x, bi.y * ri.y, bi.y * ri.z,
-       bi.z * ri.x, bi.z * ri.y, bi.z * ri.z).finished();
-        // clang-format on
-        res.B += wi * dB;
+        B(2, 0) += wi * bi.z * ri.x;
+        B(2, 1) += wi * bi.z * ri.y;
+        B(2, 2) += wi * bi.z * ri.z;
     };  // end lambda for visit_correspondences()
 
     // Lambda for the final stage after visiting all corres:
@@ -155,7 +144,6 @@ static OLAE_LinearSystems olae_build_linear_system(
         {
             const auto f = (1.0 / w_sum);
             // res.M *= f;
-            res.v *= f;
             res.B *= f;
         }
         else
@@ -166,9 +154,21 @@ static OLAE_LinearSystems olae_build_linear_system(
     };
 
     visit_correspondences(
-        in, wp, ct_local, ct_global, in_out_outliers, lambda_each_pair,
+        in, wp, ct_local, ct_global, in_out_outliers, res.B, lambda_each_pair,
         lambda_final, true /* DO make unit point vectors for OLAE */);
 
+    /* v = - sum weight *  [b_i]_{x}  r_i
+     *  Each term is:
+     *  ⎡by⋅rz - bz⋅ry ⎤   ⎡ B23 - B32 ⎤
+     *  ⎢              ⎥   |           ⎥
+     *  ⎢-bx⋅rz + bz⋅rx⎥ = | B31 - B13 ⎥
+     *  ⎢              ⎥   |           ⎥
+     *  ⎣bx⋅ry - by⋅rx ⎦   ⎣ B12 - B21 ⎦
+     */
+    res.v = -(Eigen::Vector3d() << res.B(1, 2) - res.B(2, 1),
+              res.B(2, 0) - res.B(0, 2), res.B(0, 1) - res.B(1, 0))
+                 .finished();
+
     // Now, compute the other three sets of linear systems, corresponding
     // to the "sequential rotation method" [shuster1981attitude], so we can
     // later keep the best one (i.e. the one with the largest |M|).
@@ -52,17 +52,13 @@ Pairings mp2p_icp::pt2ln_pl_to_pt2pt(
     // ===========================================================
     for (const auto& p : in.paired_pt2pl)
     {
-        const auto  pt_g = relPose.composePoint(p.pt_local);
-        const auto& pl   = p.pl_global.plane;
-
-        const auto plNormal = pl.getNormalVector();
-
-        ASSERT_NEAR_(plNormal.norm(), 1.0, 1e-4);
+        const auto pt_g = relPose.composePoint(p.pt_local);
 
-        // project
-        const double d = pl.evaluatePoint(pt_g);
+        // project (the normal is already unit)
+        const double d = p.distance(pt_g);
 
-        const mrpt::math::TPoint3D c = pt_g - (plNormal * d);
+        const mrpt::math::TVector3D n(p.normal.x, p.normal.y, p.normal.z);
+        const mrpt::math::TPoint3D  c = pt_g - n * d;
 
         mrpt::tfest::TMatchingPair new_p;
 
@@ -15,6 +15,7 @@
 #include <mp2p_icp/LogRecord.h>
 #include <mp2p_icp/Matcher_Adaptive.h>
 #include <mp2p_icp/Matcher_Point2Line.h>
+#include <mp2p_icp/Matcher_Planes_Normals.h>
 #include <mp2p_icp/Matcher_Point2Plane.h>
 #include <mp2p_icp/Matcher_Points_DistanceThreshold.h>
 #include <mp2p_icp/Matcher_Points_InlierRatio.h>
@@ -50,6 +51,7 @@ MRPT_INITIALIZER(register_mp2p_icp)
     registerClass(CLASS_ID(mp2p_icp::Matcher_Point2Line));
     registerClass(CLASS_ID(mp2p_icp::Matcher_Point2Plane));
     registerClass(CLASS_ID(mp2p_icp::Matcher_Adaptive));
+    registerClass(CLASS_ID(mp2p_icp::Matcher_Planes_Normals));
 
     registerClass(CLASS_ID(mp2p_icp::QualityEvaluator));
     registerClass(CLASS_ID(mp2p_icp::QualityEvaluator_PairedRatio));
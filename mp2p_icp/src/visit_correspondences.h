@@ -16,6 +16,14 @@
 #include <mrpt/core/optional_ref.h>
 #include <mrpt/math/TPoint3D.h>
 
+#include <algorithm>
+#include <vector>
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#endif
+
 namespace mp2p_icp
 {
 /** \addtogroup  mp2p_icp_grp
@@ -26,12 +34,21 @@ struct VisitCorrespondencesStats
     uint32_t num_pairings_discarded_scale_outliers = 0;
 };
 
-/** Visit each correspondence */
-template <class LAMBDA, class LAMBDA2>
+/** Visit each correspondence, accumulating terms into `acc`.
+ *
+ * Pairings are visited in parallel chunks (if built with TBB), each one with
+ * its own copy of the accumulator, initialized from the input `acc`, so
+ * `ACCUM` must be copyable and provide `operator+=` to reduce them.
+ * `lambda_each_pair(ACCUM&, bi, ri, wi)` is invoked for each non-outlier
+ * pairing, possibly from several threads, each with its own accumulator.
+ * `lambda_final(w_sum)` is invoked once at the end, after `acc` holds the
+ * reduced result.
+ */
+template <class ACCUM, class LAMBDA, class LAMBDA2>
 void visit_correspondences(
     const Pairings& in, const WeightParameters& wp,
     const mrpt::math::TPoint3D& ct_local, const mrpt::math::TPoint3D& ct_global,
-    OutlierIndices& in_out_outliers, LAMBDA lambda_each_pair,
+    OutlierIndices& in_out_outliers, ACCUM& acc, LAMBDA lambda_each_pair,
     LAMBDA2 lambda_final, bool normalize_relative_point_vectors,
     const mrpt::optional_ref<VisitCorrespondencesStats>& outStats =
         std::nullopt)
@@ -52,18 +69,27 @@ void visit_correspondences(
 
     const auto nAllMatches = nPt2Pt + nLn2Ln + nPl2Pl;
 
-    VisitCorrespondencesStats stats;
-
-    // weight of points, block by block:
-    auto point_weights = in.point_weights;
-    if (point_weights.empty())
+    // Weight of points, block by block, as the end index of each block and
+    // its weight, so each parallel chunk can find its first block:
+    std::vector<std::size_t> pointBlockEnds;
+    std::vector<double>      pointBlockWeights;
+    if (in.point_weights.empty())
     {
         // Default, equal weights:
-        point_weights.emplace_back(nPt2Pt, 1.0);
+        pointBlockEnds.push_back(nPt2Pt);
+        pointBlockWeights.push_back(1.0);
+    }
+    else
+    {
+        pointBlockEnds.reserve(in.point_weights.size());
+        pointBlockWeights.reserve(in.point_weights.size());
+        for (const auto& [count, w] : in.point_weights)
+        {
+            pointBlockEnds.push_back(
+                (pointBlockEnds.empty() ? 0 : pointBlockEnds.back()) + count);
+            pointBlockWeights.push_back(w);
+        }
     }
-
-    auto        cur_point_block_weights = point_weights.begin();
-    std::size_t cur_point_block_start   = 0;
 
     // Normalized weights for attitude "waXX":
     double waPoints, waLines, waPlanes;
@@ -81,141 +107,199 @@ void visit_correspondences(
         waPlanes     = wPl * k;
     }
 
-    // Accumulator of robust kernel terms (and other user-provided weights)
-    // to normalize the final linear equation at the end:
-    double w_sum = .0;
-
     const robust_sqrt_weight_func_t robustSqrtWeightFunc =
         mp2p_icp::create_robust_kernel(
             wp.robust_kernel, wp.robust_kernel_param);
 
-    OutlierIndices new_outliers;
-    new_outliers.point2point.reserve(in_out_outliers.point2point.size());
+    if (robustSqrtWeightFunc)
+    {
+        // If we are about to apply a robust kernel, we need a reference
+        // attitude wrt which apply such kernel, i.e. the "current SE(3)
+        // estimation" inside a caller ICP loop.
+        ASSERT_(wp.currentEstimateForRobust.has_value());
+    }
 
-    auto it_next_outlier = in_out_outliers.point2point.begin();
+    // Input outliers, sorted by index:
+    const auto& inOutliers = in_out_outliers.point2point;
 
-    // Terms contributed by points & vectors have now the uniform form of
-    // unit vectors:
-    for (std::size_t i = 0; i < nAllMatches; i++)
+    // Partial results of a range of pairings:
+    struct Partial
     {
-        // Skip outlier?
-        if (it_next_outlier != in_out_outliers.point2point.end() &&
-            i == *it_next_outlier)
-        {
-            ++it_next_outlier;
-            // also copy idx:
-            new_outliers.point2point.push_back(i);
-            continue;
-        }
+        ACCUM acc;
 
-        // Get "bi" (this/global) & "ri" (other/local) vectors:
-        TVector3D bi, ri;
-        double    wi = .0;
+        // Accumulator of robust kernel terms (and other user-provided
+        // weights) to normalize the final linear equation at the end:
+        double w_sum = .0;
 
-        // Points, lines, planes, are all stored in sequence:
-        if (i < nPt2Pt)
-        {
-            // point-to-point pairing:  normalize(point-centroid)
-            const auto& p = in.paired_pt2pt[i];
-            wi            = waPoints;
-
-            if (i >= cur_point_block_start + cur_point_block_weights->first)
-            {
-                ASSERT_(cur_point_block_weights != point_weights.end());
-                ++cur_point_block_weights;  // move to next block
-                cur_point_block_start = i;
-            }
-            wi *= cur_point_block_weights->second;
-            // (solution will be normalized via w_sum a the end)
+        // Pairings newly detected as outliers, in increasing order:
+        std::vector<std::size_t> newOutliers;
+    };
 
-            bi = p.global - ct_global;
-            ri = p.local - ct_local;
+    const auto lambdaVisitRange =
+        [&](const std::size_t iStart, const std::size_t iEnd, Partial& res)
+    {
+        auto itNextOutlier =
+            std::lower_bound(inOutliers.begin(), inOutliers.end(), iStart);
 
-            const auto bi_n = bi.norm(), ri_n = ri.norm();
+        std::size_t curBlock = std::upper_bound(
+                                   pointBlockEnds.begin(), pointBlockEnds.end(),
+                                   iStart) -
+                               pointBlockEnds.begin();
 
-            if (bi_n < 1e-4 || ri_n < 1e-4)
+        // Terms contributed by points & vectors have now the uniform form of
+        // unit vectors:
+        for (std::size_t i = iStart; i < iEnd; i++)
+        {
+            // Skip outlier?
+            if (itNextOutlier != inOutliers.end() && i == *itNextOutlier)
             {
-                // In the rare event of a point (almost) exactly on the
-                // centroid, just discard it:
+                ++itNextOutlier;
                 continue;
             }
 
-            // Horn requires regular relative vectors.
-            // OLAE requires unit vectors.
-            if (normalize_relative_point_vectors)
-            {
-                bi *= 1.0 / bi_n;
-                ri *= 1.0 / ri_n;
-            }
+            // Get "bi" (this/global) & "ri" (other/local) vectors:
+            TVector3D bi, ri;
+            double    wi = .0;
 
-            // Note: ideally, both norms should be equal if noiseless and a
-            // real pairing. Let's use this property to detect outliers:
-            if (wp.use_scale_outlier_detector)
+            // Points, lines, planes, are all stored in sequence:
+            if (i < nPt2Pt)
             {
-                const double scale_mismatch =
-                    std::max(bi_n, ri_n) / std::min(bi_n, ri_n);
-                if (scale_mismatch > wp.scale_outlier_threshold)
+                // point-to-point pairing:  normalize(point-centroid)
+                const auto& p = in.paired_pt2pt[i];
+
+                // move to next block?
+                while (curBlock < pointBlockEnds.size() &&
+                       i >= pointBlockEnds[curBlock])
+                    ++curBlock;
+                ASSERT_LT_(curBlock, pointBlockEnds.size());
+                // (solution will be normalized via w_sum a the end)
+                wi = waPoints * pointBlockWeights[curBlock];
+
+                bi = p.global - ct_global;
+                ri = p.local - ct_local;
+
+                const auto bi_n = bi.norm(), ri_n = ri.norm();
+
+                if (bi_n < 1e-4 || ri_n < 1e-4)
                 {
-                    // Discard this pairing:
-                    new_outliers.point2point.push_back(i);
-                    stats.num_pairings_discarded_scale_outliers++;
+                    // In the rare event of a point (almost) exactly on the
+                    // centroid, just discard it:
+                    continue;
+                }
 
-                    continue;  // Skip (same effect than: wi = 0)
+                // Horn requires regular relative vectors.
+                // OLAE requires unit vectors.
+                if (normalize_relative_point_vectors)
+                {
+                    bi *= 1.0 / bi_n;
+                    ri *= 1.0 / ri_n;
+                }
+
+                // Note: ideally, both norms should be equal if noiseless and a
+                // real pairing. Let's use this property to detect outliers:
+                if (wp.use_scale_outlier_detector)
+                {
+                    const double scale_mismatch =
+                        std::max(bi_n, ri_n) / std::min(bi_n, ri_n);
+                    if (scale_mismatch > wp.scale_outlier_threshold)
+                    {
+                        // Discard this pairing:
+                        res.newOutliers.push_back(i);
+                        continue;  // Skip (same effect than: wi = 0)
+                    }
                 }
             }
-        }
-        else if (i < nPt2Pt + nLn2Ln)
-        {
-            // line-to-line pairing:
-            wi = waLines;
+            else if (i < nPt2Pt + nLn2Ln)
+            {
+                // line-to-line pairing:
+                wi = waLines;
 
-            const auto idxLine = i - nPt2Pt;
+                const auto idxLine = i - nPt2Pt;
 
-            bi = in.paired_ln2ln[idxLine].ln_global.getDirectorVector();
-            ri = in.paired_ln2ln[idxLine].ln_local.getDirectorVector();
+                bi = in.paired_ln2ln[idxLine].ln_global.getDirectorVector();
+                ri = in.paired_ln2ln[idxLine].ln_local.getDirectorVector();
 
-            ASSERTDEB_LT_(std::abs(bi.norm() - 1.0), 0.01);
-            ASSERTDEB_LT_(std::abs(ri.norm() - 1.0), 0.01);
-        }
-        else
-        {
-            // plane-to-plane pairing:
-            wi = waPlanes;
+                ASSERTDEB_LT_(std::abs(bi.norm() - 1.0), 0.01);
+                ASSERTDEB_LT_(std::abs(ri.norm() - 1.0), 0.01);
+            }
+            else
+            {
+                // plane-to-plane pairing:
+                wi = waPlanes;
 
-            const auto idxPlane = i - (nPt2Pt + nLn2Ln);
-            bi = in.paired_pl2pl[idxPlane].p_global.plane.getNormalVector();
-            ri = in.paired_pl2pl[idxPlane].p_local.plane.getNormalVector();
+                const auto idxPlane = i - (nPt2Pt + nLn2Ln);
+                bi = in.paired_pl2pl[idxPlane].p_global.plane.getNormalVector();
+                ri = in.paired_pl2pl[idxPlane].p_local.plane.getNormalVector();
 
-            ASSERTDEB_LT_(std::abs(bi.norm() - 1.0), 0.01);
-            ASSERTDEB_LT_(std::abs(ri.norm() - 1.0), 0.01);
-        }
+                ASSERTDEB_LT_(std::abs(bi.norm() - 1.0), 0.01);
+                ASSERTDEB_LT_(std::abs(ri.norm() - 1.0), 0.01);
+            }
 
-        // If we are about to apply a robust kernel, we need a reference
-        // attitude wrt which apply such kernel, i.e. the "current SE(3)
-        // estimation" inside a caller ICP loop.
-        if (robustSqrtWeightFunc)
-        {
-            ASSERT_(wp.currentEstimateForRobust.has_value());
-            const TVector3D ri2 = wp.currentEstimateForRobust->composePoint(ri);
-
-            // mismatch between the two vectors:
-            const double errorSqr = mrpt::square(ri2.x - bi.x) +
-                                    mrpt::square(ri2.y - bi.y) +
-                                    mrpt::square(ri2.z - bi.z);
-            wi *= robustSqrtWeightFunc(errorSqr);
-        }
+            if (robustSqrtWeightFunc)
+            {
+                const TVector3D ri2 =
+                    wp.currentEstimateForRobust->composePoint(ri);
+
+                // mismatch between the two vectors:
+                const double errorSqr = mrpt::square(ri2.x - bi.x) +
+                                        mrpt::square(ri2.y - bi.y) +
+                                        mrpt::square(ri2.z - bi.z);
+                wi *= robustSqrtWeightFunc(errorSqr);
+            }
 
-        ASSERT_(wi > .0);
-        w_sum += wi;
+            ASSERT_(wi > .0);
+            res.w_sum += wi;
 
-        // Visit this pair:
-        lambda_each_pair(bi, ri, wi);
+            // Visit this pair:
+            lambda_each_pair(res.acc, bi, ri, wi);
 
-    }  // for each match
+        }  // for each match
+    };
 
-    in_out_outliers = std::move(new_outliers);
+#if defined(MP2P_HAS_TBB)
+    const Partial res = tbb::parallel_reduce(
+        // Range
+        tbb::blocked_range<std::size_t>(0, nAllMatches, 1024),
+        // Identity
+        Partial{acc, .0, {}},
+        // 1st lambda: Parallel computation
+        [&](const tbb::blocked_range<std::size_t>& r, Partial p) -> Partial
+        {
+            lambdaVisitRange(r.begin(), r.end(), p);
+            return p;
+        },
+        // 2nd lambda: Parallel reduction, in order
+        [](Partial a, const Partial& b) -> Partial
+        {
+            a.acc += b.acc;
+            a.w_sum += b.w_sum;
+            a.newOutliers.insert(
+                a.newOutliers.end(), b.newOutliers.begin(),
+                b.newOutliers.end());
+            return a;
+        });
+#else
+    Partial res{acc, .0, {}};
+    lambdaVisitRange(0, nAllMatches, res);
+#endif
+
+    acc = res.acc;
+
+    // Output outliers: the input ones, plus the new ones:
+    VisitCorrespondencesStats stats;
+    stats.num_pairings_discarded_scale_outliers =
+        static_cast<uint32_t>(res.newOutliers.size());
+
+    if (!res.newOutliers.empty())
+    {
+        auto& outl = in_out_outliers.point2point;
+        outl.insert(outl.end(), res.newOutliers.begin(), res.newOutliers.end());
+        std::sort(outl.begin(), outl.end());
+    }
+    in_out_outliers.line2line.clear();
+    in_out_outliers.plane2plane.clear();
 
-    lambda_final(w_sum);
+    lambda_final(res.w_sum);
 
     // send out optional stats
     if (outStats.has_value()) outStats.value().get() = stats;
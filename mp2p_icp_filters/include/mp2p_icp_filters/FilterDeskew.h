@@ -17,10 +17,34 @@
 #include <mp2p_icp_filters/PointCloudToVoxelGrid.h>
 #include <mp2p_icp_filters/PointCloudToVoxelGridSingle.h>
 #include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/TPose3D.h>
 #include <mrpt/math/TTwist3D.h>
+#include <mrpt/typemeta/TEnumType.h>
+
+#include <optional>
 
 namespace mp2p_icp_filters
 {
+/** Enum to select the numerical method used to evaluate the vehicle motion
+ *  for each point in FilterDeskew.
+ *
+ * \ingroup mp2p_icp_filters_grp
+ */
+enum class MotionCompensationMethod : uint8_t
+{
+    /** Evaluate the exact SE(3) pose (SO(3) exponential) for each point, in
+     * double precision. Slowest, but exact. */
+    Exact = 0,
+    /** First-order expansion of the rotation (R = I + [w*dt]x), evaluated in
+     * single precision for each point. Accurate for small rotations within
+     * one scan. */
+    FirstOrder,
+    /** Precompute a table of exact rotations and translations over
+     * `lookup_table_bins` time bins spanning the scan duration, then apply the
+     * transformation of the bin of each point in single precision. */
+    LookupTable
+};
+
 /** Builds a new layer with a deskewed (motion compensated) version of an
  *  input pointcloud from a moving LIDAR, where points are time-stamped.
  *
@@ -50,11 +74,27 @@ class FilterDeskew : public mp2p_icp_filters::FilterBase
      *   output_pointcloud_layer: 'deskewed'
      *   # silently_ignore_no_timestamps: false
      *   # skip_deskew: false  # Can be enabled to bypass deskew
+     *   # method: MotionCompensationMethod::Exact  # FirstOrder, LookupTable
+     *   # lookup_table_bins: 256   # Only for method=LookupTable
      *   # These (vx,...,wz) are variable names that must be defined via the
      *   # mp2p_icp::Parameterizable API to update them dynamically.
      *   twist: [vx,vy,vz,wx,wy,wz]
      * \endcode
      *
+     * Instead of a constant `twist`, the motion can be also given as two
+     * vehicle poses (relative to the vehicle frame at time=0) at two time
+     * instants, in which case the pose of each point is interpolated (SO(3)
+     * geodesic for rotation, linear for translation) between them:
+     *
+     * \code
+     *   interpolate_poses:
+     *     start_time: 0.0
+     *     end_time: 0.1
+     *     # [x,y,z,yaw,pitch,roll]. Each entry may be a formula as in `twist`
+     *     start_pose: [0, 0, 0, 0, 0, 0]
+     *     end_pose: [dx, dy, dz, dyaw, dpitch, droll]
+     * \endcode
+     *
      */
     void initialize(const mrpt::containers::yaml& c) override;
 
@@ -88,8 +128,35 @@ class FilterDeskew : public mp2p_icp_filters::FilterBase
      * to define it via dynamic variables.
      */
     mrpt::math::TTwist3D twist;
+
+    /** The numerical method to evaluate the motion of each point. */
+    MotionCompensationMethod method = MotionCompensationMethod::Exact;
+
+    /** Number of time bins for MotionCompensationMethod::LookupTable */
+    uint32_t lookup_table_bins = 256;
+
+    /** Alternative motion model to `twist`: interpolation between two poses.
+     */
+    struct InterpolatePoses
+    {
+        double              start_time = 0;
+        double              end_time   = 0;
+        mrpt::math::TPose3D start_pose;
+        mrpt::math::TPose3D end_pose;
+    };
+
+    /** If defined, used instead of `twist`, which must not be set in the
+     * YAML parameters then. See FilterDeskew::initialize */
+    std::optional<InterpolatePoses> interpolate_poses;
 };
 
 /** @} */
 
 }  // namespace mp2p_icp_filters
+
+MRPT_ENUM_TYPE_BEGIN_NAMESPACE(
+    mp2p_icp_filters, mp2p_icp_filters::MotionCompensationMethod)
+MRPT_FILL_ENUM(MotionCompensationMethod::Exact);
+MRPT_FILL_ENUM(MotionCompensationMethod::FirstOrder);
+MRPT_FILL_ENUM(MotionCompensationMethod::LookupTable);
+MRPT_ENUM_TYPE_END()
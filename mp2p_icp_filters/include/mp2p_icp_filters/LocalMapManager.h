@@ -0,0 +1,148 @@
+/* -------------------------------------------------------------------------
+ * A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   LocalMapManager.h
+ * @brief  Bounded-memory, sliding-window local map for odometry
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+#pragma once
+
+#include <mp2p_icp/metricmap.h>
+#include <mp2p_icp_filters/PointCloudToVoxelGrid.h>
+#include <mrpt/containers/yaml.h>
+#include <mrpt/core/pimpl.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/system/COutputLogger.h>
+
+#include <cstdint>
+#include <string>
+
+namespace mp2p_icp_filters
+{
+/** Maintains a bounded local map around the robot, for use as the `global`
+ *  map in ICP-based odometry.
+ *
+ * Points are stored in a hashed voxel grid, with at most
+ * `max_points_per_voxel` points per voxel. Each new scan is inserted
+ * incrementally (insertScan()), and then voxels are evicted if:
+ *  - they are farther than `max_distance` from the robot,
+ *  - they have not received new points during the last `max_age_scans`
+ *    scans, or
+ *  - there are more than `max_voxels` voxels: the least recently updated
+ *    ones are evicted first.
+ *
+ * Evictions cost O(evicted): voxels are kept in a least-recently-updated
+ * list, and distance culling works on coarse chunks of
+ * `chunk_size`^3 voxels, so only the (few) chunks are visited, never all
+ * voxels. As a consequence, voxels up to one chunk diagonal farther than
+ * `max_distance` may be kept.
+ *
+ * All points live in a single point cloud layer of localMap(), updated in
+ * place (removed points are swapped with the last one), so it can be
+ * passed directly as global map to mp2p_icp::ICP::align(). Only XYZ
+ * coordinates are kept.
+ *
+ * Example YAML configuration for initialize():
+ * \code
+ * layer_name: "local_map"
+ * voxel_size: 0.5
+ * max_points_per_voxel: 10
+ * max_distance: 60.0
+ * max_age_scans: 0      # 0=disabled
+ * max_voxels: 0         # 0=disabled
+ * chunk_size: 16
+ * \endcode
+ *
+ * Not thread-safe: do not insert scans while the map is being used in ICP.
+ *
+ * \ingroup mp2p_icp_filters_grp
+ */
+class LocalMapManager : public mrpt::system::COutputLogger
+{
+   public:
+    LocalMapManager();
+
+    struct Parameters
+    {
+        void load_from_yaml(const mrpt::containers::yaml& c);
+
+        /** Name of the output point layer in localMap() */
+        std::string layer_name = "local_map";
+
+        /** Size of each voxel edge [meters] */
+        double voxel_size = 0.5;
+
+        /** New points falling into a full voxel are discarded */
+        uint32_t max_points_per_voxel = 10;
+
+        /** Voxels farther than this from the robot are evicted [meters].
+         *  0 means disabled. */
+        double max_distance = 60.0;
+
+        /** Voxels not updated in the last N scans are evicted. 0=disabled. */
+        uint32_t max_age_scans = 0;
+
+        /** Maximum number of voxels. 0=disabled. */
+        uint32_t max_voxels = 0;
+
+        /** Edge length of chunks used for distance culling [in voxels] */
+        uint32_t chunk_size = 16;
+    };
+
+    /** Algorithm parameters */
+    Parameters params_;
+
+    /** Loads parameters from YAML, and clears the map. */
+    void initialize(const mrpt::containers::yaml& c);
+
+    /** Removes all points */
+    void clear();
+
+    struct UpdateStats
+    {
+        std::size_t insertedPoints = 0;
+        std::size_t evictedVoxels  = 0;
+        std::size_t evictedPoints  = 0;
+    };
+
+    /** Inserts a new scan, given in the robot frame, and then evicts old and
+     *  far voxels. */
+    UpdateStats insertScan(
+        const mrpt::maps::CPointsMap& scan,
+        const mrpt::poses::CPose3D&   robotPose);
+
+    /** The local map, with one point layer named `params_.layer_name` */
+    const mp2p_icp::metric_map_t& localMap() const { return localMap_; }
+
+    /** Number of occupied voxels */
+    std::size_t voxelCount() const;
+
+    /** Number of points in the local map */
+    std::size_t pointCount() const { return points_->size(); }
+
+   private:
+    using indices_t   = PointCloudToVoxelGrid::indices_t;
+    using IndicesHash = PointCloudToVoxelGrid::IndicesHash;
+
+    mp2p_icp::metric_map_t                 localMap_;
+    mrpt::maps::CSimplePointsMap::Ptr      points_;
+    uint64_t                               scanCount_ = 0;
+
+    /** Hash maps, hidden inside a PIMP as in PointCloudToVoxelGrid */
+    struct Impl;
+    mrpt::pimpl<Impl> impl_;
+
+    indices_t voxelIndex(float x, float y, float z) const;
+    indices_t chunkIndex(const indices_t& voxelIdx) const;
+
+    void evictVoxel(const indices_t& voxelIdx, UpdateStats& stats);
+    void removePoint(uint32_t ptIdx);
+};
+
+}  // namespace mp2p_icp_filters
@@ -15,6 +15,7 @@
 #include <mrpt/containers/yaml.h>
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/math/ops_containers.h>  // dotProduct
+#include <mrpt/poses/CPose3D.h>
 #include <mrpt/poses/Lie/SO.h>
 #include <mrpt/random/RandomGenerators.h>
 #include <mrpt/version.h>
@@ -23,7 +24,11 @@
 #include <mrpt/maps/CPointsMapXYZIRT.h>
 #endif
 
+#include <algorithm>
+#include <array>
+
 #if defined(MP2P_HAS_TBB)
+#include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
 #endif
 
@@ -47,8 +52,50 @@ void FilterDeskew::initialize(const mrpt::containers::yaml& c)
     MCP_LOAD_OPT(c, silently_ignore_no_timestamps);
     MCP_LOAD_OPT(c, output_layer_class);
     MCP_LOAD_OPT(c, skip_deskew);
+    MCP_LOAD_OPT(c, method);
+    MCP_LOAD_OPT(c, lookup_table_bins);
+
+    if (c.has("interpolate_poses"))
+    {
+        ASSERTMSG_(
+            !c.has("twist"),
+            "Only one of 'twist' or 'interpolate_poses' can be defined");
+
+        const auto& ci = c["interpolate_poses"];
+        ASSERT_(ci.isMap());
+
+        auto& ip = interpolate_poses.emplace();
+
+        ASSERT_(ci.has("start_time") && ci.has("end_time"));
+        Parameterizable::parseAndDeclareParameter(
+            ci["start_time"].as<std::string>(), ip.start_time);
+        Parameterizable::parseAndDeclareParameter(
+            ci["end_time"].as<std::string>(), ip.end_time);
+
+        const auto lambdaLoadPose =
+            [&](const char* poseName, mrpt::math::TPose3D& pose)
+        {
+            ASSERTMSG_(
+                ci.has(poseName) && ci[poseName].isSequence() &&
+                    ci[poseName].asSequence().size() == 6,
+                mrpt::format(
+                    "'interpolate_poses.%s' must be a sequence of 6 entries "
+                    "[x,y,z,yaw,pitch,roll]",
+                    poseName));
+
+            const auto yamlPose = ci[poseName].asSequence();
+            for (int i = 0; i < 6; i++)
+                Parameterizable::parseAndDeclareParameter(
+                    yamlPose.at(i).as<std::string>(), pose[i]);
+        };
+        lambdaLoadPose("start_pose", ip.start_pose);
+        lambdaLoadPose("end_pose", ip.end_pose);
+        return;
+    }
 
-    ASSERT_(c.has("twist") && c["twist"].isSequence());
+    ASSERTMSG_(
+        c.has("twist") && c["twist"].isSequence(),
+        "Either 'twist' or 'interpolate_poses' must be defined");
     ASSERT_EQUAL_(c["twist"].asSequence().size(), 6UL);
 
     const auto yamlTwist = c["twist"].asSequence();
@@ -58,6 +105,80 @@ void FilterDeskew::initialize(const mrpt::containers::yaml& c)
             yamlTwist.at(i).as<std::string>(), twist[i]);
 }
 
+namespace
+{
+/** Motion model shared by all deskew methods:
+ *  pose(t) = base (+) [exp(w*(t-t0)), v*(t-t0)]
+ */
+struct DeskewMotionModel
+{
+    mrpt::poses::CPose3D  base;
+    bool                  baseIsIdentity = true;
+    double                t0             = 0;
+    mrpt::math::TVector3D v, w;
+
+    mrpt::poses::CPose3D pose_at(double t) const
+    {
+        const double dt = t - t0;
+
+        const auto incr = mrpt::poses::CPose3D::FromRotationAndTranslation(
+            // Rotation: From Lie group SO(3) exponential:
+            mrpt::poses::Lie::SO<3>::exp(
+                mrpt::math::CVectorFixedDouble<3>(w * dt)),
+            // Translation: simple constant velocity model:
+            v * dt);
+
+        return baseIsIdentity ? incr : base + incr;
+    }
+};
+
+/** A rigid transformation in single precision, for the deskew kernels */
+struct RigidTransformF
+{
+    std::array<float, 9> R;  // row-major
+    std::array<float, 3> t;
+
+    static RigidTransformF From(const mrpt::poses::CPose3D& p)
+    {
+        RigidTransformF ret;
+        const auto&     M = p.getRotationMatrix();
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 3; c++)
+                ret.R[r * 3 + c] = static_cast<float>(M(r, c));
+
+        ret.t = {
+            static_cast<float>(p.x()), static_cast<float>(p.y()),
+            static_cast<float>(p.z())};
+        return ret;
+    }
+
+    mrpt::math::TPoint3Df apply(float x, float y, float z) const
+    {
+        return {
+            R[0] * x + R[1] * y + R[2] * z + t[0],
+            R[3] * x + R[4] * y + R[5] * z + t[1],
+            R[6] * x + R[7] * y + R[8] * z + t[2]};
+    }
+};
+
+/// Runs `f(i)` for all i in [0,n), in parallel if TBB is enabled.
+template <typename FUNCTOR>
+void for_each_point(const size_t n, FUNCTOR&& f)
+{
+#if defined(MP2P_HAS_TBB)
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, n),
+        [&](const tbb::blocked_range<size_t>& r)
+        {
+            for (size_t i = r.begin(); i < r.end(); i++) f(i);
+        });
+#else
+    for (size_t i = 0; i < n; i++) f(i);
+#endif
+}
+
+}  // namespace
+
 void FilterDeskew::filter(mp2p_icp::metric_map_t& inOut) const
 {
     MRPT_START
@@ -153,43 +274,143 @@ void FilterDeskew::filter(mp2p_icp::metric_map_t& inOut) const
         const size_t n0 = outPc->size();
         outPc->resize(n0 + n);
 
-        const auto v = mrpt::math::TVector3D(twist.vx, twist.vy, twist.vz);
-        const auto w = mrpt::math::TVector3D(twist.wx, twist.wy, twist.wz);
+        // Build the motion model:
+        DeskewMotionModel mm;
+        if (interpolate_poses.has_value())
+        {
+            if (twist != mrpt::math::TTwist3D())
+            {
+                MRPT_LOG_WARN_STREAM(
+                    "Both 'twist' and 'interpolate_poses' are set: 'twist' "
+                    "is ignored.");
+            }
 
-#if defined(MP2P_HAS_TBB)
-        tbb::parallel_for(
-            static_cast<size_t>(0), n,
-            [&](size_t i)
-#else
-        for (size_t i = 0; i < n; i++)
-#endif
+            const auto&  ip = *interpolate_poses;
+            const double Dt = ip.end_time - ip.start_time;
+            ASSERT_GT_(Dt, .0);
+
+            const auto P0 = mrpt::poses::CPose3D(ip.start_pose);
+            const auto P1 = mrpt::poses::CPose3D(ip.end_pose);
+            const auto dP = P1 - P0;  // P1 relative to P0
+
+            const auto logR =
+                mrpt::poses::Lie::SO<3>::log(dP.getRotationMatrix());
+
+            mm.base           = P0;
+            mm.baseIsIdentity = false;
+            mm.t0             = ip.start_time;
+            mm.v = mrpt::math::TVector3D(dP.x(), dP.y(), dP.z()) * (1.0 / Dt);
+            mm.w =
+                mrpt::math::TVector3D(logR[0], logR[1], logR[2]) * (1.0 / Dt);
+        }
+        else
+        {
+            mm.v = mrpt::math::TVector3D(twist.vx, twist.vy, twist.vz);
+            mm.w = mrpt::math::TVector3D(twist.wx, twist.wy, twist.wz);
+        }
+
+        const auto lambdaStorePoint =
+            [&](size_t i, const mrpt::math::TPoint3Df& corrPt)
+        {
+            outPc->setPointFast(n0 + i, corrPt.x, corrPt.y, corrPt.z);
+            if (Is && out_Is) (*out_Is)[n0 + i] = (*Is)[i];
+            if (Rs && out_Rs) (*out_Rs)[n0 + i] = (*Rs)[i];
+            if (Ts && out_Ts) (*out_Ts)[n0 + i] = (*Ts)[i];
+        };
+
+        switch (method)
+        {
+            case MotionCompensationMethod::Exact:
+            {
+                for_each_point(
+                    n,
+                    [&](size_t i)
+                    {
+                        const auto pt =
+                            mrpt::math::TPoint3Df(xs[i], ys[i], zs[i]);
+                        if (pt.x == 0 && pt.y == 0 && pt.z == 0) return;
+
+                        const auto p = mm.pose_at((*Ts)[i]);
+                        lambdaStorePoint(i, p.composePoint(pt));
+                    });
+            }
+            break;
+
+            case MotionCompensationMethod::FirstOrder:
             {
-                const auto pt = mrpt::math::TPoint3Df(xs[i], ys[i], zs[i]);
-                if (!(pt.x == 0 && pt.y == 0 && pt.z == 0))
+                // p' = base (+) (p + [w*dt]x p + v*dt)
+                const auto  baseF = RigidTransformF::From(mm.base);
+                const float t0    = static_cast<float>(mm.t0);
+                const float vx = static_cast<float>(mm.v.x),
+                            vy = static_cast<float>(mm.v.y),
+                            vz = static_cast<float>(mm.v.z);
+                const float wx = static_cast<float>(mm.w.x),
+                            wy = static_cast<float>(mm.w.y),
+                            wz = static_cast<float>(mm.w.z);
+
+                for_each_point(
+                    n,
+                    [&](size_t i)
+                    {
+                        const float x = xs[i], y = ys[i], z = zs[i];
+                        if (x == 0 && y == 0 && z == 0) return;
+
+                        const float dt = (*Ts)[i] - t0;
+                        const float rx = wx * dt, ry = wy * dt, rz = wz * dt;
+                        const float qx = x + (ry * z - rz * y) + vx * dt;
+                        const float qy = y + (rz * x - rx * z) + vy * dt;
+                        const float qz = z + (rx * y - ry * x) + vz * dt;
+
+                        lambdaStorePoint(
+                            i, mm.baseIsIdentity
+                                   ? mrpt::math::TPoint3Df(qx, qy, qz)
+                                   : baseF.apply(qx, qy, qz));
+                    });
+            }
+            break;
+
+            case MotionCompensationMethod::LookupTable:
+            {
+                // Time span of this scan:
+                const auto [itMin, itMax] =
+                    std::minmax_element(Ts->begin(), Ts->end());
+                const double tMin = *itMin, tMax = *itMax;
+
+                const size_t nBins = std::max<size_t>(1, lookup_table_bins);
+                const double binWidth = (tMax - tMin) / nBins;
+
+                // Exact poses at the center of each time bin:
+                std::vector<RigidTransformF> table(nBins);
+                for (size_t k = 0; k < nBins; k++)
                 {
-                    // Forward integrate twist:
-                    const mrpt::math::TVector3D v_dt = v * (*Ts)[i];
-                    const mrpt::math::TVector3D w_dt = w * (*Ts)[i];
-
-                    const auto p =
-                        mrpt::poses::CPose3D::FromRotationAndTranslation(
-                            // Rotation: From Lie group SO(3) exponential:
-                            mrpt::poses::Lie::SO<3>::exp(
-                                mrpt::math::CVectorFixedDouble<3>(w_dt)),
-                            // Translation: simple constant velocity model:
-                            v_dt);
-
-                    const auto corrPt = p.composePoint(pt);
-
-                    outPc->setPointFast(n0 + i, corrPt.x, corrPt.y, corrPt.z);
-                    if (Is && out_Is) (*out_Is)[n0 + i] = (*Is)[i];
-                    if (Rs && out_Rs) (*out_Rs)[n0 + i] = (*Rs)[i];
-                    if (Ts && out_Ts) (*out_Ts)[n0 + i] = (*Ts)[i];
+                    table[k] = RigidTransformF::From(
+                        mm.pose_at(tMin + (k + 0.5) * binWidth));
                 }
+
+                const float tMinF = static_cast<float>(tMin);
+                const float invBinWidth =
+                    binWidth > 0 ? static_cast<float>(1.0 / binWidth) : 0.0f;
+                const size_t lastBin = nBins - 1;
+
+                for_each_point(
+                    n,
+                    [&](size_t i)
+                    {
+                        const float x = xs[i], y = ys[i], z = zs[i];
+                        if (x == 0 && y == 0 && z == 0) return;
+
+                        const size_t bin = std::min(
+                            lastBin, static_cast<size_t>(
+                                         ((*Ts)[i] - tMinF) * invBinWidth));
+
+                        lambdaStorePoint(i, table[bin].apply(x, y, z));
+                    });
             }
-#if defined(MP2P_HAS_TBB)
-        );
-#endif
+            break;
+
+            default:
+                THROW_EXCEPTION("Unhandled value for 'method'");
+        };
     }
 
     outPc->mark_as_modified();
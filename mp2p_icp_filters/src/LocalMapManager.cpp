@@ -0,0 +1,306 @@
+/* -------------------------------------------------------------------------
+ * A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   LocalMapManager.cpp
+ * @brief  Bounded-memory, sliding-window local map for odometry
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp_filters/LocalMapManager.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <list>
+#include <vector>
+
+// Used in the PIMP:
+#include <tsl/robin_map.h>
+#include <tsl/robin_set.h>
+
+using namespace mp2p_icp_filters;
+
+struct LocalMapManager::Impl
+{
+    struct voxel_t
+    {
+        /** Indices of this voxel points in the local map point cloud */
+        std::vector<uint32_t> pointIdxs;
+
+        /** Scan counter of the last insertion into this voxel */
+        uint64_t lastUpdate = 0;
+
+        /** Position of this voxel in `lru` */
+        std::list<indices_t>::iterator lruIt;
+    };
+
+    tsl::robin_map<indices_t, voxel_t, IndicesHash> voxels;
+
+    /** Voxels, from least to most recently updated */
+    std::list<indices_t> lru;
+
+    /** Voxels in each chunk */
+    tsl::robin_map<
+        indices_t, tsl::robin_set<indices_t, IndicesHash>, IndicesHash>
+        chunks;
+
+    /** The voxel of each point in the local map point cloud */
+    std::vector<indices_t> pointOwner;
+};
+
+void LocalMapManager::Parameters::load_from_yaml(
+    const mrpt::containers::yaml& c)
+{
+    MCP_LOAD_OPT(c, layer_name);
+    MCP_LOAD_REQ(c, voxel_size);
+    MCP_LOAD_OPT(c, max_points_per_voxel);
+    MCP_LOAD_OPT(c, max_distance);
+    MCP_LOAD_OPT(c, max_age_scans);
+    MCP_LOAD_OPT(c, max_voxels);
+    MCP_LOAD_OPT(c, chunk_size);
+
+    ASSERT_GT_(voxel_size, .0);
+    ASSERT_GE_(max_points_per_voxel, 1U);
+    ASSERT_GE_(max_distance, .0);
+    ASSERT_GE_(chunk_size, 1U);
+}
+
+LocalMapManager::LocalMapManager() : impl_(mrpt::make_impl<Impl>())
+{
+    mrpt::system::COutputLogger::setLoggerName("LocalMapManager");
+    clear();
+}
+
+void LocalMapManager::initialize(const mrpt::containers::yaml& c)
+{
+    MRPT_START
+
+    MRPT_LOG_DEBUG_STREAM("Loading these params:\n" << c);
+    params_.load_from_yaml(c);
+
+    clear();
+
+    MRPT_END
+}
+
+void LocalMapManager::clear()
+{
+    impl_->voxels.clear();
+    impl_->lru.clear();
+    impl_->chunks.clear();
+    impl_->pointOwner.clear();
+    scanCount_ = 0;
+
+    points_ = mrpt::maps::CSimplePointsMap::Create();
+
+    localMap_.clear();
+    localMap_.layers[params_.layer_name] = points_;
+}
+
+std::size_t LocalMapManager::voxelCount() const
+{
+    return impl_->voxels.size();
+}
+
+LocalMapManager::indices_t LocalMapManager::voxelIndex(
+    float x, float y, float z) const
+{
+    const double inv = 1.0 / params_.voxel_size;
+    return {
+        static_cast<int32_t>(std::floor(x * inv)),
+        static_cast<int32_t>(std::floor(y * inv)),
+        static_cast<int32_t>(std::floor(z * inv))};
+}
+
+LocalMapManager::indices_t LocalMapManager::chunkIndex(
+    const indices_t& v) const
+{
+    const auto cs        = static_cast<int32_t>(params_.chunk_size);
+    const auto lambdaDiv = [cs](int32_t i)
+    { return i >= 0 ? i / cs : -((-i + cs - 1) / cs); };
+
+    return {lambdaDiv(v.cx_), lambdaDiv(v.cy_), lambdaDiv(v.cz_)};
+}
+
+LocalMapManager::UpdateStats LocalMapManager::insertScan(
+    const mrpt::maps::CPointsMap& scan, const mrpt::poses::CPose3D& robotPose)
+{
+    MRPT_START
+
+    // In case the layer name changed via params_ without initialize():
+    if (localMap_.layers.count(params_.layer_name) == 0)
+    {
+        localMap_.layers.clear();
+        localMap_.layers[params_.layer_name] = points_;
+    }
+
+    UpdateStats stats;
+    auto&       I = *impl_;
+
+    scanCount_++;
+
+    // 1) Insert new points:
+    // ---------------------------------
+    const auto& xs = scan.getPointsBufferRef_x();
+    const auto& ys = scan.getPointsBufferRef_y();
+    const auto& zs = scan.getPointsBufferRef_z();
+
+    for (size_t i = 0; i < xs.size(); i++)
+    {
+        float gx, gy, gz;
+        robotPose.composePoint(xs[i], ys[i], zs[i], gx, gy, gz);
+
+        const indices_t vIdx = voxelIndex(gx, gy, gz);
+
+        auto itVxl = I.voxels.find(vIdx);
+        if (itVxl == I.voxels.end())
+        {
+            // New voxel:
+            itVxl = I.voxels.insert({vIdx, Impl::voxel_t()}).first;
+            itVxl.value().lruIt = I.lru.insert(I.lru.end(), vIdx);
+            I.chunks[chunkIndex(vIdx)].insert(vIdx);
+        }
+        auto& vxl = itVxl.value();
+
+        // Mark as recently updated:
+        if (vxl.lastUpdate != scanCount_)
+        {
+            vxl.lastUpdate = scanCount_;
+            I.lru.splice(I.lru.end(), I.lru, vxl.lruIt);
+        }
+
+        if (vxl.pointIdxs.size() >= params_.max_points_per_voxel) continue;
+
+        vxl.pointIdxs.push_back(static_cast<uint32_t>(points_->size()));
+        I.pointOwner.push_back(vIdx);
+        points_->insertPointFast(gx, gy, gz);
+        stats.insertedPoints++;
+    }
+
+    // 2) Evict old voxels, from the front of the LRU list:
+    // ------------------------------------------------------
+    while (!I.lru.empty())
+    {
+        const indices_t oldest = I.lru.front();
+        const uint64_t  age    = scanCount_ - I.voxels.at(oldest).lastUpdate;
+
+        const bool tooOld =
+            params_.max_age_scans != 0 && age > params_.max_age_scans;
+        const bool tooMany =
+            params_.max_voxels != 0 && I.voxels.size() > params_.max_voxels;
+
+        if (!tooOld && !tooMany) break;
+        evictVoxel(oldest, stats);
+    }
+
+    // 3) Evict far voxels, by chunks:
+    // ---------------------------------
+    if (params_.max_distance > 0)
+    {
+        const double px = robotPose.x(), py = robotPose.y(),
+                     pz = robotPose.z();
+        const double chunkLen   = params_.chunk_size * params_.voxel_size;
+        const double maxDistSqr = mrpt::square(params_.max_distance);
+
+        // Distance from the robot to the [lo,hi] range of a chunk, in 1 axis:
+        const auto lambdaAxisDist = [chunkLen](double v, int32_t c)
+        {
+            const double lo = c * chunkLen, hi = lo + chunkLen;
+            return v < lo ? lo - v : (v > hi ? v - hi : .0);
+        };
+
+        std::vector<indices_t> farChunks;
+        for (const auto& kv : I.chunks)
+        {
+            const indices_t& cIdx = kv.first;
+            const double dSqr = mrpt::square(lambdaAxisDist(px, cIdx.cx_)) +
+                                mrpt::square(lambdaAxisDist(py, cIdx.cy_)) +
+                                mrpt::square(lambdaAxisDist(pz, cIdx.cz_));
+            if (dSqr > maxDistSqr) farChunks.push_back(cIdx);
+        }
+
+        for (const auto& cIdx : farChunks)
+        {
+            const auto itChunk = I.chunks.find(cIdx);
+            if (itChunk == I.chunks.end()) continue;
+
+            // Copy, since evictVoxel() modifies the chunk:
+            const std::vector<indices_t> chunkVoxels(
+                itChunk->second.begin(), itChunk->second.end());
+
+            for (const auto& vIdx : chunkVoxels) evictVoxel(vIdx, stats);
+        }
+    }
+
+    // The layer has been modified in place:
+    points_->mark_as_modified();
+    localMap_.invalidate_nn_indices();
+
+    MRPT_LOG_DEBUG_FMT(
+        "insertScan: +%zu points, -%zu voxels (-%zu points). Now: %zu "
+        "voxels, %zu points.",
+        stats.insertedPoints, stats.evictedVoxels, stats.evictedPoints,
+        I.voxels.size(), static_cast<size_t>(points_->size()));
+
+    return stats;
+
+    MRPT_END
+}
+
+void LocalMapManager::evictVoxel(const indices_t& vIdx, UpdateStats& stats)
+{
+    auto& I = *impl_;
+
+    const auto itVxl = I.voxels.find(vIdx);
+    if (itVxl == I.voxels.end()) return;
+
+    std::vector<uint32_t> ptIdxs = std::move(itVxl.value().pointIdxs);
+
+    I.lru.erase(itVxl->second.lruIt);
+    I.voxels.erase(itVxl);
+
+    if (auto itChunk = I.chunks.find(chunkIndex(vIdx));
+        itChunk != I.chunks.end())
+    {
+        itChunk.value().erase(vIdx);
+        if (itChunk->second.empty()) I.chunks.erase(itChunk);
+    }
+
+    // Remove in descending order, so the last point of the cloud is never
+    // one of the (already removed) points of this voxel:
+    std::sort(ptIdxs.begin(), ptIdxs.end(), std::greater<uint32_t>());
+    for (const uint32_t ptIdx : ptIdxs) removePoint(ptIdx);
+
+    stats.evictedVoxels++;
+    stats.evictedPoints += ptIdxs.size();
+}
+
+void LocalMapManager::removePoint(uint32_t ptIdx)
+{
+    auto& I = *impl_;
+
+    const auto lastIdx = static_cast<uint32_t>(points_->size() - 1);
+
+    if (ptIdx != lastIdx)
+    {
+        // Move the last point into the gap:
+        float x, y, z;
+        points_->getPointFast(lastIdx, x, y, z);
+        points_->setPointFast(ptIdx, x, y, z);
+
+        const indices_t owner = I.pointOwner[lastIdx];
+        I.pointOwner[ptIdx]   = owner;
+
+        auto& ownerIdxs = I.voxels.find(owner).value().pointIdxs;
+        *std::find(ownerIdxs.begin(), ownerIdxs.end(), lastIdx) = ptIdx;
+    }
+
+    I.pointOwner.pop_back();
+    points_->resize(lastIdx);
+}
@@ -91,6 +91,17 @@ void mp2p_icp_filters::simplemap_to_metricmap(
     ps.updateVariables(options.customVariables);
     ps.realize();
 
+    // Resolve per-keyframe variables only once:
+    const auto slotVx = ps.variableSlot("vx"), slotVy = ps.variableSlot("vy"),
+               slotVz = ps.variableSlot("vz"), slotWx = ps.variableSlot("wx"),
+               slotWy = ps.variableSlot("wy"), slotWz = ps.variableSlot("wz");
+    const auto slotX     = ps.variableSlot("robot_x"),
+               slotY     = ps.variableSlot("robot_y"),
+               slotZ     = ps.variableSlot("robot_z"),
+               slotYaw   = ps.variableSlot("robot_yaw"),
+               slotPitch = ps.variableSlot("robot_pitch"),
+               slotRoll  = ps.variableSlot("robot_roll");
+
     // progress bar:
     if (options.showProgressBar)
         std::cout << "\n";  // Needed for the VT100 codes below.
@@ -112,12 +123,12 @@ void mp2p_icp_filters::simplemap_to_metricmap(
         if (twist.has_value())
         {
             ps.updateVariables(
-                {{"vx", twist->vx},
-                 {"vy", twist->vy},
-                 {"vz", twist->vz},
-                 {"wx", twist->wx},
-                 {"wy", twist->wy},
-                 {"wz", twist->wz}});
+                {{slotVx, twist->vx},
+                 {slotVy, twist->vy},
+                 {slotVz, twist->vz},
+                 {slotWx, twist->wx},
+                 {slotWy, twist->wy},
+                 {slotWz, twist->wz}});
         }
 #else
         const auto& [pose, sf] = sm.get(curKF);
@@ -128,12 +139,12 @@ void mp2p_icp_filters::simplemap_to_metricmap(
 
         // Update pose variables:
         ps.updateVariables(
-            {{"robot_x", robotPose.x()},
-             {"robot_y", robotPose.y()},
-             {"robot_z", robotPose.z()},
-             {"robot_yaw", robotPose.yaw()},
-             {"robot_pitch", robotPose.pitch()},
-             {"robot_roll", robotPose.roll()}});
+            {{slotX, robotPose.x()},
+             {slotY, robotPose.y()},
+             {slotZ, robotPose.z()},
+             {slotYaw, robotPose.yaw()},
+             {slotPitch, robotPose.pitch()},
+             {slotRoll, robotPose.roll()}});
         ps.realize();
 
         for (const auto& obs : *sf)
@@ -0,0 +1,130 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   BlockGZOutputStream.h
+ * @brief  GZIP output file stream, compressed by blocks in parallel threads
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+#pragma once
+
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/CStream.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mp2p_icp
+{
+/** \addtogroup  mp2p_icp_map_grp
+ * @{ */
+
+/** A write-only file stream that splits its input into blocks, compresses
+ * each block as an independent GZIP member in a pool of threads, and writes
+ * them to the file in order. The threads are created by open() and reused
+ * for all blocks until close().
+ *
+ * A sequence of GZIP members is itself a valid GZIP file, so the output can
+ * be read back transparently with mrpt::io::CFileGZInputStream (and hence,
+ * with all the load_from_file() / loadFromFile() methods) or with `gunzip`.
+ * Files are only slightly larger than those of mrpt::io::CFileGZOutputStream,
+ * but compression is no longer bounded by the speed of one single core.
+ *
+ * Memory usage is bounded to about `blockSize` times the number of threads.
+ *
+ * Example:
+ * \code
+ * mp2p_icp::BlockGZOutputStream f("out.mm");
+ * auto arch = mrpt::serialization::archiveFrom(f);
+ * arch << myMap;
+ * \endcode
+ */
+class BlockGZOutputStream : public mrpt::io::CStream
+{
+   public:
+    struct Parameters
+    {
+        /** GZIP compression level, 0 (none) to 9 (best). */
+        int compressionLevel = 1;
+
+        /** Uncompressed size of each independently compressed block */
+        std::size_t blockSize = 4 * 1024 * 1024;
+
+        /** Number of compression threads (0: hardware concurrency) */
+        std::size_t threads = 0;
+    };
+
+    BlockGZOutputStream() = default;
+
+    /** Constructor and open(). Throws on error. */
+    explicit BlockGZOutputStream(
+        const std::string& fileName, const Parameters& p = Parameters());
+
+    /** Destructor: calls close(). Errors are only reported to std::cerr,
+     *  call close() explicitly to get exceptions. */
+    ~BlockGZOutputStream() override;
+
+    BlockGZOutputStream(const BlockGZOutputStream&)            = delete;
+    BlockGZOutputStream& operator=(const BlockGZOutputStream&) = delete;
+
+    /** Creates the file (overwriting it if existed).
+     * \return false on error. */
+    bool open(const std::string& fileName, const Parameters& p = Parameters());
+
+    bool is_open() const { return f_.is_open(); }
+
+    /** Compresses the last block, waits for all pending blocks, stops the
+     *  threads and closes the file. Throws on error, after stopping the
+     *  threads and closing the file anyway. */
+    void close();
+
+    // See docs in base class
+    size_t      Read(void* Buffer, size_t Count) override;
+    size_t      Write(const void* Buffer, size_t Count) override;
+    uint64_t    Seek(int64_t Offset, CStream::TSeekOrigin Origin) override;
+    uint64_t    getTotalBytesCount() const override;
+    uint64_t    getPosition() const override;
+    std::string getStreamDescription() const override;
+
+   private:
+    Parameters                  params_;
+    mrpt::io::CFileOutputStream f_;
+    std::string                 fileName_;
+    std::vector<uint8_t>        block_;
+    uint64_t                    totalIn_     = 0;
+    std::size_t                 maxInFlight_ = 1;
+
+    using compress_task_t = std::packaged_task<std::vector<uint8_t>()>;
+
+    /** Compressed blocks, in file order */
+    std::deque<std::future<std::vector<uint8_t>>> pending_;
+
+    /** Thread pool, and its queue of blocks to compress */
+    std::vector<std::thread>    workers_;
+    std::deque<compress_task_t> jobs_;
+    std::mutex                  jobsMtx_;
+    std::condition_variable     jobsCv_;
+    bool                        stopWorkers_ = false;
+
+    void start_workers();
+    void stop_workers();
+
+    /** Sends the current block to compression. */
+    void submit_block();
+
+    /** Writes the oldest pending block, waiting for it if needed. */
+    void write_oldest();
+};
+
+/** @} */
+
+}  // namespace mp2p_icp
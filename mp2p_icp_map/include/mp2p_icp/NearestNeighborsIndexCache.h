@@ -0,0 +1,119 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   NearestNeighborsIndexCache.h
+ * @brief  Build-once cache of NN search indices for static map layers
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+#pragma once
+
+#include <mrpt/maps/CMetricMap.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+
+namespace mp2p_icp
+{
+/** \addtogroup  mp2p_icp_map_grp
+ * @{ */
+
+/** Cache of ready-to-use nearest-neighbor search indices (KD-trees) for map
+ * layers, keyed by (layer, index build parameters).
+ *
+ * Indices are built once, on the first request, and then shared by all
+ * subsequent queries, e.g. from many ICP runs against the same global map, or
+ * from several matchers requesting different KD-tree leaf sizes for the same
+ * layer. Without this cache, each change of leaf size would force a full
+ * rebuild of the layer KD-tree, on every ICP iteration.
+ *
+ * All methods are safe to be called concurrently from several threads.
+ *
+ * Cached indices are only valid for **static** layers: the contract is "build
+ * once, then read only". An index is rebuilt if its layer is replaced by
+ * another object or its number of points changes, but other in-place
+ * modifications (e.g. moving points, or calling mark_as_modified() on the
+ * layer) cannot be detected, since MRPT maps do not expose any modification
+ * counter. Call invalidate() or clear() after modifying a layer in place;
+ * both increment generation(), so all indices built before are discarded.
+ *
+ * Indices with custom parameters are built on a private copy of the layer
+ * point cloud, so each distinct KD-tree leaf size requested for a layer
+ * duplicates its memory usage.
+ *
+ * \sa metric_map_t::layer_for_nn_queries()
+ */
+class NearestNeighborsIndexCache
+{
+   public:
+    NearestNeighborsIndexCache() = default;
+
+    /** Returns a map that can be used for NN queries over the same points
+     * (with identical point indices) than `layer`, with its NN index already
+     * built with the given parameters.
+     *
+     * \param layer The source map layer. A reference to it (not a copy) is
+     *        returned if the requested parameters coincide with those of the
+     *        layer itself, or if it is not a point cloud.
+     * \param kdtreeLeafMaxSize If set, the desired maximum number of points
+     *        per KD-tree leaf. Otherwise, the layer own KD-tree parameters are
+     *        used.
+     *
+     * The returned reference remains valid until invalidate() or clear() are
+     * called, or the layer is modified.
+     */
+    const mrpt::maps::CMetricMap& get(
+        const mrpt::maps::CMetricMap::Ptr& layer,
+        const std::optional<std::size_t>&  kdtreeLeafMaxSize = std::nullopt);
+
+    /** Removes all cached indices for the given layer */
+    void invalidate(const mrpt::maps::CMetricMap& layer);
+
+    /** Removes all cached indices */
+    void clear();
+
+    /** Number of cached (layer, parameters) entries */
+    std::size_t size() const;
+
+    /** A counter incremented by each call to invalidate() or clear(). Clients
+     * with derived caches can compare it to detect modified layers. */
+    uint64_t generation() const;
+
+   private:
+    /** Leaf size 0 means "the layer own parameters" */
+    using key_t = std::pair<const mrpt::maps::CMetricMap*, std::size_t>;
+
+    struct Entry
+    {
+        /** To detect a different layer allocated at a reused address */
+        std::weak_ptr<mrpt::maps::CMetricMap> source;
+
+        /** Number of points in the source layer when the index was built */
+        std::size_t sourceSize = 0;
+
+        /** Value of generation_ when the index was built */
+        uint64_t generation = 0;
+
+        /** Copy of the source point cloud with custom KD-tree parameters, or
+         * empty if the source layer itself is used */
+        mrpt::maps::CMetricMap::Ptr copy;
+    };
+
+    std::map<key_t, Entry>    entries_;
+    uint64_t                  generation_ = 0;
+    mutable std::shared_mutex entriesMtx_;
+
+    bool is_valid(
+        const Entry& e, const mrpt::maps::CMetricMap::Ptr& layer) const;
+};
+
+/** @} */
+
+}  // namespace mp2p_icp
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <mrpt/core/exceptions.h>
 #include <mrpt/expr/CRuntimeCompiledExpression.h>
 
 #include <cstdint>
@@ -17,6 +18,9 @@
 
 namespace mp2p_icp
 {
+class ParameterSource;
+class Parameterizable;
+
 namespace internal
 {
 struct InfoPerParam
@@ -27,16 +31,25 @@ struct InfoPerParam
     std::variant<std::monostate, double*, float*, uint32_t*> target;
     bool is_constant        = false;
     bool has_been_evaluated = false;
+
+    /// The source whose variables `compiled` is bound to (by reference)
+    const ParameterSource* compiledFor = nullptr;
+    /// "dirty" flags of the variables the expression depends on
+    std::vector<const bool*> dependencies;
 };
 }  // namespace internal
 
-class ParameterSource;
-class Parameterizable;
-
 /** Users of derived classes must declare an instance of this type, then attach
  * instances of derived classes to it, then optionally update variables via
  * updateVariable(), then call realize() for the changes to take effect.
  *
+ * For variables updated very often (e.g. once per ICP iteration or per
+ * keyframe), resolve them once with variableSlot() and update them through
+ * the returned slot, which avoids the lookup by name.
+ *
+ * realize() only re-evaluates those expressions depending on variables
+ * that actually changed since the last call.
+ *
  * \ingroup mp2p_icp_map_grp
  */
 class ParameterSource
@@ -46,11 +59,40 @@ class ParameterSource
 
     void attach(Parameterizable& obj);
 
+    /** A variable resolved by name only once. Valid during the lifetime of
+     *  the ParameterSource that created it. \sa variableSlot() */
+    class VariableSlot
+    {
+       public:
+        VariableSlot() = default;
+
+        bool   valid() const { return value_ != nullptr; }
+        double value() const { return *value_; }
+
+       private:
+        friend class ParameterSource;
+        double* value_ = nullptr;
+        bool*   dirty_ = nullptr;
+    };
+
+    /** Returns the slot for a given variable, defining it with value 0 if it
+     *  did not exist. */
+    VariableSlot variableSlot(const std::string& variable);
+
     /** Updates a variable value. Remember to call realize() after updating all
      *  variables for the changes to take effect */
     void updateVariable(const std::string& variable, double value)
     {
-        variables_[variable] = value;
+        updateVariable(variableSlot(variable), value);
+    }
+
+    /// \overload Fast version, without lookup by name.
+    void updateVariable(const VariableSlot& slot, double value)
+    {
+        ASSERTMSG_(slot.valid(), "Default-constructed VariableSlot");
+        if (*slot.value_ == value) return;
+        *slot.value_ = value;
+        *slot.dirty_ = true;
     }
 
     /** Like updateVariable(), accepting several pairs of names-values */
@@ -61,6 +103,14 @@ class ParameterSource
             updateVariable(name, value);
     }
 
+    /** Like updateVariable(), accepting several pairs of slots-values */
+    void updateVariables(
+        const std::vector<std::pair<VariableSlot, double>>& slotValuePairs)
+    {
+        for (const auto& [slot, value] : slotValuePairs)
+            updateVariable(slot, value);
+    }
+
     void realize();
 
     std::string printVariableValues() const;
@@ -72,8 +122,10 @@ class ParameterSource
     }
 
    private:
-    // Attached clients.
+    // Note: std::map guarantees stable addresses of values, which are bound
+    // by reference into compiled expressions and VariableSlot's.
     std::map<std::string, double>     variables_;
+    std::map<std::string, bool>       dirty_;
     std::set<internal::InfoPerParam*> attachedDeclParameters_;
 };
 
@@ -0,0 +1,149 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   SimpleMapStream.h
+ * @brief  Keyframe by keyframe reading and writing of .simplemap files
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+#pragma once
+
+#include <mp2p_icp/BlockGZOutputStream.h>
+#include <mrpt/io/CFileGZInputStream.h>
+#include <mrpt/maps/CSimpleMap.h>
+#include <mrpt/serialization/CArchive.h>
+
+#include <cstdint>
+#include <string>
+
+namespace mp2p_icp
+{
+/** \addtogroup  mp2p_icp_map_grp
+ * @{ */
+
+/** Reads the keyframes of a `.simplemap` file (a serialized
+ * mrpt::maps::CSimpleMap) one by one, so files of any size can be processed
+ * with constant memory.
+ *
+ * Note that MRPT archives have no per-object length, so observations cannot
+ * be skipped without decoding them. Observations with external storage are
+ * not loaded, though, and each keyframe can be released as soon as it has
+ * been processed.
+ *
+ * Example:
+ * \code
+ * mp2p_icp::SimpleMapReader r("map.simplemap");
+ * mrpt::maps::CSimpleMap::Keyframe kf;
+ * while (r.next(kf)) { ... }
+ * \endcode
+ *
+ * \sa SimpleMapWriter
+ */
+class SimpleMapReader
+{
+   public:
+    SimpleMapReader() = default;
+
+    /** Constructor and open(). */
+    explicit SimpleMapReader(const std::string& fileName);
+
+    /** Opens the file and reads its header. Throws on error. */
+    void open(const std::string& fileName);
+
+    bool is_open() const { return f_.is_open(); }
+
+    /** Total number of keyframes in the file */
+    std::size_t size() const { return count_; }
+
+    /** Number of keyframes already read by next() */
+    std::size_t read_count() const { return readCount_; }
+
+    /** Reads the next keyframe.
+     * \return false if there are no more keyframes. Throws on error.
+     */
+    bool next(mrpt::maps::CSimpleMap::Keyframe& kf);
+
+   private:
+    mrpt::io::CFileGZInputStream f_;
+    mrpt::serialization::CArchiveStreamBase<mrpt::io::CFileGZInputStream> arch_{
+        f_};
+
+    uint8_t     version_   = 0;
+    std::size_t count_     = 0;
+    std::size_t readCount_ = 0;
+};
+
+/** Writes a `.simplemap` file keyframe by keyframe, so it can be created with
+ * constant memory, without knowing the number of keyframes in advance.
+ *
+ * Keyframes are compressed in parallel as they are appended (see
+ * BlockGZOutputStream) into a temporary file next to the output file. close()
+ * writes the header and then copies the already compressed keyframes, so the
+ * result is a regular GZIP file, readable with
+ * mrpt::maps::CSimpleMap::loadFromFile().
+ *
+ * The output file is only created (or replaced) by an explicit call to
+ * close(). If the writer is destroyed or discard()'ed before, the temporary
+ * file is removed and any former output file is left untouched.
+ *
+ * \note While close() runs, the disk must have room for about twice the
+ * compressed size of the map, since the final file is written before the
+ * temporary one is removed.
+ *
+ * \sa SimpleMapReader
+ */
+class SimpleMapWriter
+{
+   public:
+    SimpleMapWriter() = default;
+
+    /** Constructor and open(). */
+    explicit SimpleMapWriter(
+        const std::string&                     fileName,
+        const BlockGZOutputStream::Parameters& p = {});
+
+    /** Destructor: calls discard(). Call close() explicitly to keep the
+     *  output. */
+    ~SimpleMapWriter();
+
+    SimpleMapWriter(const SimpleMapWriter&)            = delete;
+    SimpleMapWriter& operator=(const SimpleMapWriter&) = delete;
+
+    /** Creates the output file. Throws on error. */
+    void open(
+        const std::string&                     fileName,
+        const BlockGZOutputStream::Parameters& p = {});
+
+    bool is_open() const { return body_.is_open(); }
+
+    void append(const mrpt::maps::CSimpleMap::Keyframe& kf);
+
+    /** Number of keyframes appended so far */
+    std::size_t size() const { return count_; }
+
+    /** Writes the final file and removes the temporary one. Throws on error,
+     *  after removing the temporary files, in which case the output file is
+     *  left untouched.
+     */
+    void close();
+
+    /** Closes the writer without creating the output file, removing the
+     *  temporary one. */
+    void discard();
+
+   private:
+    std::string                     fileName_, bodyFileName_, partFileName_;
+    BlockGZOutputStream::Parameters params_;
+    BlockGZOutputStream             body_;
+    std::size_t                     count_ = 0;
+
+    /** Writes the header, keyframes and end flag to partFileName_ */
+    void write_final_file();
+};
+
+/** @} */
+
+}  // namespace mp2p_icp
@@ -0,0 +1,298 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   VoxelSurfelMap.h
+ * @brief  Voxelized map of surfels (local plane fits), for pt-to-plane ICP
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+#pragma once
+
+#include <mp2p_icp/NearestPlaneCapable.h>
+#include <mrpt/config/CLoadableOptions.h>
+#include <mrpt/img/TColor.h>
+#include <mrpt/maps/CMetricMap.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/maps/TMetricMapInitializer.h>
+#include <mrpt/math/TBoundingBox.h>
+#include <mrpt/math/TPoint3D.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace mp2p_icp
+{
+/** \addtogroup  mp2p_icp_map_grp
+ * @{ */
+
+/** A sparse voxel grid (a hash map of voxels) where each voxel keeps the
+ * first and second moments of all the points that fell into it, and a plane
+ * fit (surfel) computed from them: mean, normal and planarity.
+ *
+ * Points are not stored individually. Moments are updated incrementally as
+ * points are inserted, and only the voxels touched by each insertion are
+ * re-fitted, so inserting a new scan has a cost proportional to the scan size,
+ * not to the map size.
+ *
+ * This map implements NearestPlaneCapable, so it can be used as global layer
+ * for Matcher_Point2Plane: each query is a hash lookup of the voxel of the
+ * query point, plus a check of its neighboring voxels within the search
+ * distance.
+ *
+ * Queries (const methods) are safe to be called concurrently from several
+ * threads, as long as the map is not modified at the same time.
+ *
+ * It can be created from a Generator with a `metric_map_definition` like:
+ *
+ * \code
+ * metric_map_definition:
+ *   class: mp2p_icp::VoxelSurfelMap
+ *   creationOpts:
+ *     voxel_size: 0.5
+ *   insertOpts:
+ *     min_points_per_plane: 5
+ *     plane_eigen_threshold: 0.01
+ * \endcode
+ *
+ */
+class VoxelSurfelMap : public mrpt::maps::CMetricMap,
+                       public mp2p_icp::NearestPlaneCapable
+{
+    DEFINE_SERIALIZABLE(VoxelSurfelMap, mp2p_icp)
+
+   public:
+    /** Constructor, with the edge length of each voxel [meters] */
+    VoxelSurfelMap(float voxel_size = 0.50f);
+
+    /** Integer coordinates of a voxel */
+    struct VoxelIndex
+    {
+        VoxelIndex() = default;
+        VoxelIndex(int32_t x, int32_t y, int32_t z) : cx(x), cy(y), cz(z) {}
+
+        int32_t cx = 0, cy = 0, cz = 0;
+
+        bool operator==(const VoxelIndex& o) const
+        {
+            return cx == o.cx && cy == o.cy && cz == o.cz;
+        }
+    };
+
+    struct VoxelIndexHash
+    {
+        std::size_t operator()(const VoxelIndex& v) const noexcept
+        {
+            // Large primes, as in "Optimized spatial hashing for collision
+            // detection of deformable objects", Teschner et al. 2003:
+            return static_cast<std::size_t>(
+                (static_cast<uint64_t>(v.cx) * 73856093ULL) ^
+                (static_cast<uint64_t>(v.cy) * 19349669ULL) ^
+                (static_cast<uint64_t>(v.cz) * 83492791ULL));
+        }
+    };
+
+    /** The contents of one voxel */
+    struct Surfel
+    {
+        /** Number of points inserted so far */
+        uint32_t count = 0;
+
+        /** Sum of points, and sum of their outer products (xx, xy, xz, yy,
+         * yz, zz), relative to the voxel center for numerical accuracy. */
+        std::array<double, 3> sum{0, 0, 0};
+        std::array<double, 6> sumSq{0, 0, 0, 0, 0, 0};
+
+        /** @name Plane fit, up to date with the moments above
+         *  @{ */
+
+        /** Points mean, in map coordinates */
+        mrpt::math::TPoint3Df mean{0, 0, 0};
+
+        /** Unit normal, oriented so its largest component is positive */
+        mrpt::math::TVector3Df normal{0, 0, 1};
+
+        /** (e1-e0)/e2, for eigenvalues e0<=e1<=e2, in range [0,1] */
+        float planarity = 0;
+
+        /** Whether this surfel passes the insertion options thresholds */
+        bool isPlane = false;
+
+        /** @} */
+    };
+
+    using voxel_map_t =
+        std::unordered_map<VoxelIndex, Surfel, VoxelIndexHash>;
+
+    /** @name Voxel access and insertion
+     *  @{ */
+
+    float voxel_size() const { return voxel_size_; }
+
+    /** Changes the voxel size. This clears the map contents. */
+    void setVoxelProperties(float voxel_size);
+
+    /** Index of the voxel that contains a given point */
+    VoxelIndex coordToIndex(const mrpt::math::TPoint3Df& pt) const
+    {
+        return {
+            static_cast<int32_t>(std::floor(pt.x * voxel_size_inv_)),
+            static_cast<int32_t>(std::floor(pt.y * voxel_size_inv_)),
+            static_cast<int32_t>(std::floor(pt.z * voxel_size_inv_))};
+    }
+
+    /** Center of a given voxel */
+    mrpt::math::TPoint3Df indexToCoord(const VoxelIndex& idx) const
+    {
+        return {
+            (idx.cx + 0.5f) * voxel_size_, (idx.cy + 0.5f) * voxel_size_,
+            (idx.cz + 0.5f) * voxel_size_};
+    }
+
+    /** Direct read-only access to all voxels */
+    const voxel_map_t& voxels() const { return voxels_; }
+
+    /** Returns the surfel of the given voxel, or nullptr if it is empty */
+    const Surfel* surfelByIndex(const VoxelIndex& idx) const
+    {
+        const auto it = voxels_.find(idx);
+        return it == voxels_.end() ? nullptr : &it->second;
+    }
+
+    /** Inserts one point, re-fitting the surfel of its voxel. To insert many
+     * points, insertPointCloud() is more efficient. */
+    void insertPoint(const mrpt::math::TPoint3Df& pt);
+
+    /** Inserts all points of a point cloud, transformed by the given pose,
+     * re-fitting each touched voxel only once. */
+    void insertPointCloud(
+        const mrpt::maps::CPointsMap& pts, const mrpt::poses::CPose3D& pose);
+
+    /** @} */
+
+    /** @name Options
+     *  @{ */
+
+    struct TInsertionOptions : public mrpt::config::CLoadableOptions
+    {
+        TInsertionOptions() = default;
+
+        void loadFromConfigFile(
+            const mrpt::config::CConfigFileBase& source,
+            const std::string&                   section) override;
+        void saveToConfigFile(
+            mrpt::config::CConfigFileBase& c,
+            const std::string&             section) const override;
+
+        /** Minimum number of points in a voxel to fit a plane */
+        uint32_t min_points_per_plane = 5;
+
+        /** A surfel is a plane if e0 < plane_eigen_threshold * e1, for its
+         * eigenvalues sorted as e0<=e1<=e2. */
+        float plane_eigen_threshold = 0.01f;
+
+        void writeToStream(mrpt::serialization::CArchive& out) const;
+        void readFromStream(mrpt::serialization::CArchive& in);
+    };
+
+    TInsertionOptions insertionOptions;
+
+    struct TRenderOptions : public mrpt::config::CLoadableOptions
+    {
+        TRenderOptions() = default;
+
+        void loadFromConfigFile(
+            const mrpt::config::CConfigFileBase& source,
+            const std::string&                   section) override;
+        void saveToConfigFile(
+            mrpt::config::CConfigFileBase& c,
+            const std::string&             section) const override;
+
+        float point_size = 3.0f;
+
+        /** Draw normals of planar surfels, as segments of voxel_size/2 */
+        bool show_normals = false;
+
+        /** Color of planar surfel centers (and normals) */
+        mrpt::img::TColorf color{.0f, .0f, 1.0f};
+
+        void writeToStream(mrpt::serialization::CArchive& out) const;
+        void readFromStream(mrpt::serialization::CArchive& in);
+    };
+
+    TRenderOptions renderOptions;
+
+    /** @} */
+
+    /** @name API of the NearestPlaneCapable interface
+     *  @{ */
+
+    /** Looks for the planar surfel closest (in point-to-plane distance) to
+     * the query point, among the voxels whose boundaries are closer than
+     * `max_search_distance` to it (at most the 27 voxels around the point).
+     */
+    NearestPlaneResult nn_search_pt2pl(
+        const mrpt::math::TPoint3Df& point,
+        const float                  max_search_distance) const override;
+
+    /** @} */
+
+    /** @name Public virtual methods of CMetricMap
+     *  @{ */
+
+    std::string asString() const override;
+    void        getVisualizationInto(
+               mrpt::opengl::CSetOfObjects& outObj) const override;
+    bool                       isEmpty() const override;
+    mrpt::math::TBoundingBoxf  boundingBox() const override;
+    void saveMetricMapRepresentationToFile(
+        const std::string& filNamePrefix) const override;
+
+    /** @} */
+
+   protected:
+    // See docs in base class
+    void internal_clear() override;
+
+    bool internal_insertObservation(
+        const mrpt::obs::CObservation&                   obs,
+        const std::optional<const mrpt::poses::CPose3D>& robotPose =
+            std::nullopt) override;
+
+    double internal_computeObservationLikelihood(
+        const mrpt::obs::CObservation& obs,
+        const mrpt::poses::CPose3D&    takenFrom) const override;
+
+    bool internal_canComputeObservationLikelihood(
+        const mrpt::obs::CObservation& obs) const override;
+
+   private:
+    float       voxel_size_     = 0.50f;
+    float       voxel_size_inv_ = 1.0f / 0.50f;
+    voxel_map_t voxels_;
+
+    /** Bounding box of all inserted points */
+    mrpt::math::TPoint3Df bbMin_{0, 0, 0}, bbMax_{0, 0, 0};
+
+    /** Adds a point to the moments of its voxel, without re-fitting it */
+    Surfel& accumulate(const mrpt::math::TPoint3Df& pt, VoxelIndex& idx);
+
+    /** Re-computes the plane fit of a voxel from its moments */
+    void fit(const VoxelIndex& idx, Surfel& s) const;
+
+   public:
+    MAP_DEFINITION_START(VoxelSurfelMap)
+    float                                   voxel_size = 0.50f;
+    mp2p_icp::VoxelSurfelMap::TInsertionOptions insertionOpts;
+    mp2p_icp::VoxelSurfelMap::TRenderOptions    renderOpts;
+    MAP_DEFINITION_END(VoxelSurfelMap)
+};
+
+/** @} */
+
+}  // namespace mp2p_icp
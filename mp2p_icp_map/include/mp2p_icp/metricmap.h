@@ -11,6 +11,7 @@
  */
 #pragma once
 
+#include <mp2p_icp/NearestNeighborsIndexCache.h>
 #include <mp2p_icp/NearestPlaneCapable.h>
 #include <mp2p_icp/layer_name_t.h>
 #include <mp2p_icp/plane_patch.h>
@@ -138,7 +139,8 @@ class metric_map_t : public mrpt::serialization::CSerializable,
     virtual void clear();
 
     /** Saves the metric_map_t object  to file, using MRPT serialization and
-     *  using on-the-fly GZIP compression.
+     *  GZIP compression by blocks in parallel threads, see
+     *  BlockGZOutputStream.
      * \return true on success.
      */
     bool save_to_file(const std::string& fileName) const;
@@ -159,6 +161,40 @@ class metric_map_t : public mrpt::serialization::CSerializable,
      */
     mrpt::maps::CPointsMap::Ptr point_layer(const layer_name_t& name) const;
 
+    /** Returns a map with the same contents (and point indices) than the given
+     * layer, with its NN search index (KD-tree) already built with the given
+     * leaf size (or the layer default, if not set).
+     *
+     * Indices are built once and cached (see NearestNeighborsIndexCache), so
+     * repeated calls (e.g. from many ICP runs against this map as global map)
+     * are cheap and never modify the layer. Safe to be called concurrently.
+     *
+     * If kdtreeLeafMaxSize differs from the layer own KD-tree parameters,
+     * the index is built over a private copy of the layer points, hence each
+     * distinct leaf size requested for a point layer duplicates its memory
+     * usage until invalidate_nn_indices() is called or the layer is released.
+     *
+     * \note Layers are assumed to be static once queried ("build once, read
+     * only"): call invalidate_nn_indices() after modifying layer contents in
+     * place, since only changes in the number of points are detected.
+     * \exception std::exception If the layer does not exist.
+     */
+    const mrpt::maps::CMetricMap& layer_for_nn_queries(
+        const layer_name_t&               name,
+        const std::optional<std::size_t>& kdtreeLeafMaxSize =
+            std::nullopt) const;
+
+    /** Discards all cached NN indices. \sa layer_for_nn_queries() */
+    void invalidate_nn_indices() const { nnIndexCache_->clear(); }
+
+    /** Incremented by each call to invalidate_nn_indices(). Can be used by
+     * other caches derived from this map contents to detect modifications.
+     */
+    uint64_t nn_indices_generation() const
+    {
+        return nnIndexCache_->generation();
+    }
+
     /** Gets a renderizable view of all geometric entities.
      *
      * See render_params_t for options to show/hide the different geometric
@@ -217,6 +253,11 @@ class metric_map_t : public mrpt::serialization::CSerializable,
 
     /** @} */
 
+   private:
+    /** Not serialized. Shared among copies, since they share layers too. */
+    std::shared_ptr<NearestNeighborsIndexCache> nnIndexCache_ =
+        std::make_shared<NearestNeighborsIndexCache>();
+
    protected:
     /** Implement in derived classes if new data fields are required */
     virtual void derivedSerializeTo(
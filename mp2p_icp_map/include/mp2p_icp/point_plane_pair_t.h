@@ -15,6 +15,7 @@
 #include <mrpt/math/TPoint3D.h>
 #include <mrpt/typemeta/TTypeName.h>
 
+#include <cmath>
 #include <vector>
 
 namespace mp2p_icp
@@ -22,17 +23,63 @@ namespace mp2p_icp
 /** \addtogroup  mp2p_icp_map_grp
  * @{ */
 
-/** Point-to-plane pair */
+/** Point-to-plane pair.
+ *
+ * The global plane is stored in compact form, as a unit normal and an offset,
+ * normalized once when the pair is created, so the signed distance from a
+ * point `g` in the global frame to the plane is just `normal·g + offset`.
+ */
 struct point_plane_pair_t
 {
-    plane_patch_t         pl_global;
+    /** Unit normal of the global plane */
+    mrpt::math::TVector3Df normal{0, 0, 1};
+
+    /** Offset of the global plane: its points `p` fulfill `normal·p +
+     * offset = 0` */
+    float offset = 0;
+
     mrpt::math::TPoint3Df pt_local;
 
     point_plane_pair_t() = default;
+
+    /** Builds the pair from any (not necessarily normalized) global plane */
+    point_plane_pair_t(
+        const mrpt::math::TPlane& p_global, const mrpt::math::TPoint3Df& p_local)
+        : pt_local(p_local)
+    {
+        set_plane(p_global);
+    }
+
     point_plane_pair_t(
         const plane_patch_t& p_global, const mrpt::math::TPoint3Df& p_local)
-        : pl_global(p_global), pt_local(p_local)
+        : point_plane_pair_t(p_global.plane, p_local)
+    {
+    }
+
+    /** Sets the global plane, normalizing it */
+    void set_plane(const mrpt::math::TPlane& pl)
+    {
+        const auto& c = pl.coefs;
+        const double k =
+            1.0 / std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+
+        normal = {
+            static_cast<float>(c[0] * k), static_cast<float>(c[1] * k),
+            static_cast<float>(c[2] * k)};
+        offset = static_cast<float>(c[3] * k);
+    }
+
+    /** The global plane */
+    mrpt::math::TPlane plane() const
+    {
+        return mrpt::math::TPlane(normal.x, normal.y, normal.z, offset);
+    }
+
+    /** Signed distance from a point in the global frame to the plane */
+    template <typename T>
+    T distance(const mrpt::math::TPoint3D_<T>& g) const
     {
+        return normal.x * g.x + normal.y * g.y + normal.z * g.z + offset;
     }
 
     DECLARE_TTYPENAME_CLASSNAME(mp2p_icp::point_plane_pair_t)
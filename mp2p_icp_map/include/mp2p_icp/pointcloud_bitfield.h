@@ -42,19 +42,32 @@ struct pointcloud_bitfield_t
         DenseOrSparseBitField()  = default;
         ~DenseOrSparseBitField() = default;
 
+        /** Sets all bits to false. If the field was already dense with the
+         * same size, only the bits set since the last call are cleared, so
+         * the cost is proportional to the number of marked elements instead
+         * of the map size. */
         void assign(size_t numElements, bool dense)
         {
             if (dense)
             {
                 sparse_.clear();
-                if (!dense_) dense_.emplace();
-                dense_->assign(numElements, false);
+                if (dense_ && dense_->size() == numElements &&
+                    touched_.size() < numElements / 64)
+                {
+                    for (const auto id : touched_) (*dense_)[id] = false;
+                }
+                else
+                {
+                    if (!dense_) dense_.emplace();
+                    dense_->assign(numElements, false);
+                }
             }
             else
             {
                 dense_.reset();
                 sparse_.clear();
             }
+            touched_.clear();
         }
 
         [[nodiscard]] bool operator[](const size_t id) const
@@ -67,7 +80,14 @@ struct pointcloud_bitfield_t
         void mark_as_set(const size_t id)
         {
             if (dense_.has_value())
-                dense_.value()[id] = true;
+            {
+                auto&& bit = dense_.value()[id];
+                if (!bit)
+                {
+                    bit = true;
+                    touched_.push_back(id);
+                }
+            }
             else
                 sparse_.insert(id);
         }
@@ -75,6 +95,9 @@ struct pointcloud_bitfield_t
        private:
         std::optional<std::vector<bool>> dense_;
         std::set<uint64_t>               sparse_;
+
+        /** Indices set in dense_, to clear them quickly in assign() */
+        std::vector<uint64_t> touched_;
     };
 
     /** @name Data fields
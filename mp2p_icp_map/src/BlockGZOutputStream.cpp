@@ -0,0 +1,221 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   BlockGZOutputStream.cpp
+ * @brief  GZIP output file stream, compressed by blocks in parallel threads
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/BlockGZOutputStream.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/io/zip.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+using namespace mp2p_icp;
+
+BlockGZOutputStream::BlockGZOutputStream(
+    const std::string& fileName, const Parameters& p)
+{
+    if (!open(fileName, p))
+        THROW_EXCEPTION_FMT("Error creating file: '%s'", fileName.c_str());
+}
+
+BlockGZOutputStream::~BlockGZOutputStream()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[BlockGZOutputStream] Error closing '" << fileName_
+                  << "': " << e.what() << std::endl;
+    }
+    stop_workers();
+}
+
+bool BlockGZOutputStream::open(const std::string& fileName, const Parameters& p)
+{
+    close();
+
+    ASSERT_GE_(p.compressionLevel, 0);
+    ASSERT_LE_(p.compressionLevel, 9);
+    ASSERT_GT_(p.blockSize, 0U);
+
+    params_   = p;
+    fileName_ = fileName;
+    totalIn_  = 0;
+
+    maxInFlight_ = params_.threads != 0
+                       ? params_.threads
+                       : std::max<std::size_t>(
+                             1, std::thread::hardware_concurrency());
+
+    block_.clear();
+    block_.reserve(params_.blockSize);
+
+    if (!f_.open(fileName)) return false;
+
+    start_workers();
+    return true;
+}
+
+void BlockGZOutputStream::close()
+{
+    if (!f_.is_open()) return;
+
+    try
+    {
+        // The last (partial) block. Write an empty GZIP member for empty
+        // streams, so the output is always a valid GZIP file:
+        if (!block_.empty() || totalIn_ == 0) submit_block();
+
+        while (!pending_.empty()) write_oldest();
+    }
+    catch (...)
+    {
+        pending_.clear();
+        block_.clear();
+        stop_workers();
+        f_.close();
+        throw;
+    }
+
+    stop_workers();
+    f_.close();
+}
+
+void BlockGZOutputStream::start_workers()
+{
+    stopWorkers_ = false;
+
+    // One thread per block in flight:
+    for (std::size_t i = 0; i < maxInFlight_; i++)
+    {
+        workers_.emplace_back(
+            [this]()
+            {
+                for (;;)
+                {
+                    compress_task_t job;
+                    {
+                        std::unique_lock<std::mutex> lck(jobsMtx_);
+                        jobsCv_.wait(
+                            lck,
+                            [this]()
+                            { return stopWorkers_ || !jobs_.empty(); });
+                        if (stopWorkers_) return;
+
+                        job = std::move(jobs_.front());
+                        jobs_.pop_front();
+                    }
+                    // Exceptions are stored in the future:
+                    job();
+                }
+            });
+    }
+}
+
+void BlockGZOutputStream::stop_workers()
+{
+    {
+        std::lock_guard<std::mutex> lck(jobsMtx_);
+        stopWorkers_ = true;
+        jobs_.clear();
+    }
+    jobsCv_.notify_all();
+
+    for (auto& t : workers_) t.join();
+    workers_.clear();
+}
+
+void BlockGZOutputStream::submit_block()
+{
+    // Bounded number of blocks in memory:
+    while (pending_.size() >= maxInFlight_) write_oldest();
+
+    compress_task_t job(
+        [level = params_.compressionLevel,
+         data  = std::move(block_)]() -> std::vector<uint8_t>
+        {
+            std::vector<uint8_t> gz;
+            const bool           ok =
+                mrpt::io::zip::compress_gz_data_block(data, gz, level);
+            ASSERTMSG_(ok, "Error compressing data block");
+            return gz;
+        });
+    pending_.emplace_back(job.get_future());
+
+    {
+        std::lock_guard<std::mutex> lck(jobsMtx_);
+        jobs_.push_back(std::move(job));
+    }
+    jobsCv_.notify_one();
+
+    block_ = std::vector<uint8_t>();
+    block_.reserve(params_.blockSize);
+}
+
+void BlockGZOutputStream::write_oldest()
+{
+    ASSERT_(!pending_.empty());
+
+    // Rethrows any exception from the compression thread:
+    const std::vector<uint8_t> gz = pending_.front().get();
+    pending_.pop_front();
+
+    f_.WriteBuffer(gz.data(), gz.size());
+}
+
+size_t BlockGZOutputStream::Write(const void* Buffer, size_t Count)
+{
+    ASSERTMSG_(f_.is_open(), "Write() called on a closed stream");
+
+    const auto* data      = reinterpret_cast<const uint8_t*>(Buffer);
+    size_t      remaining = Count;
+
+    while (remaining > 0)
+    {
+        const size_t n =
+            std::min(remaining, params_.blockSize - block_.size());
+
+        block_.insert(block_.end(), data, data + n);
+        data += n;
+        remaining -= n;
+
+        if (block_.size() >= params_.blockSize) submit_block();
+    }
+
+    totalIn_ += Count;
+    return Count;
+}
+
+size_t BlockGZOutputStream::Read(
+    [[maybe_unused]] void* Buffer, [[maybe_unused]] size_t Count)
+{
+    THROW_EXCEPTION("Read() not available in an output stream");
+}
+
+uint64_t BlockGZOutputStream::Seek(
+    [[maybe_unused]] int64_t              Offset,
+    [[maybe_unused]] CStream::TSeekOrigin Origin)
+{
+    THROW_EXCEPTION("Seek() not available in a GZIP stream");
+}
+
+uint64_t BlockGZOutputStream::getTotalBytesCount() const { return totalIn_; }
+
+uint64_t BlockGZOutputStream::getPosition() const { return totalIn_; }
+
+std::string BlockGZOutputStream::getStreamDescription() const
+{
+    return "mp2p_icp::BlockGZOutputStream for file '" + fileName_ + "'";
+}
@@ -0,0 +1,153 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   NearestNeighborsIndexCache.cpp
+ * @brief  Build-once cache of NN search indices for static map layers
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/NearestNeighborsIndexCache.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/core/exceptions.h>
+
+#include <mutex>
+
+using namespace mp2p_icp;
+
+namespace
+{
+std::size_t layerPointCount(const mrpt::maps::CMetricMap& layer)
+{
+    const auto* pts = mp2p_icp::MapToPointsMap(layer);
+    return pts ? pts->size() : 0;
+}
+}  // namespace
+
+bool NearestNeighborsIndexCache::is_valid(
+    const Entry& e, const mrpt::maps::CMetricMap::Ptr& layer) const
+{
+    return e.generation == generation_ && e.source.lock() == layer &&
+           e.sourceSize == layerPointCount(*layer);
+}
+
+const mrpt::maps::CMetricMap& NearestNeighborsIndexCache::get(
+    const mrpt::maps::CMetricMap::Ptr& layer,
+    const std::optional<std::size_t>&  kdtreeLeafMaxSize)
+{
+    MRPT_START
+
+    ASSERT_(layer);
+
+    const auto* pts = mp2p_icp::MapToPointsMap(*layer);
+
+    // Only point clouds support custom KD-tree parameters:
+    std::size_t leafSize = 0;
+    if (pts && kdtreeLeafMaxSize.has_value() &&
+        *kdtreeLeafMaxSize != pts->kdtree_search_params.leaf_max_size)
+    {
+        leafSize = *kdtreeLeafMaxSize;
+    }
+
+    const key_t key = {layer.get(), leafSize};
+
+    const auto lambdaResult =
+        [&](const Entry& e) -> const mrpt::maps::CMetricMap&
+    {
+        return e.copy ? *e.copy : *layer;
+    };
+
+    // Fast path: already built.
+    {
+        std::shared_lock<std::shared_mutex> lck(entriesMtx_);
+        if (auto it = entries_.find(key);
+            it != entries_.end() && is_valid(it->second, layer))
+        {
+            return lambdaResult(it->second);
+        }
+    }
+
+    // Slow path: build it, once.
+    std::unique_lock<std::shared_mutex> lck(entriesMtx_);
+
+    // Release indices of layers that no longer exist:
+    for (auto it = entries_.begin(); it != entries_.end();)
+    {
+        if (it->second.source.expired() && it->first != key)
+            it = entries_.erase(it);
+        else
+            ++it;
+    }
+
+    // Check again, someone else might have built it in the meanwhile:
+    if (auto it = entries_.find(key);
+        it != entries_.end() && is_valid(it->second, layer))
+    {
+        return lambdaResult(it->second);
+    }
+
+    // Build into a new entry, only stored if everything succeeds:
+    Entry newEntry;
+    newEntry.generation = generation_;
+    newEntry.sourceSize = layerPointCount(*layer);
+
+    if (leafSize != 0)
+    {
+        ASSERT_(pts);
+        auto copy = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
+            pts->duplicateGetSmartPtr());
+        ASSERT_(copy);
+        copy->kdtree_search_params.leaf_max_size = leafSize;
+        copy->mark_as_modified();
+        newEntry.copy = copy;
+    }
+
+    if (const auto* nn = mp2p_icp::MapToNN(lambdaResult(newEntry), false); nn)
+        nn->nn_prepare_for_3d_queries();
+
+    newEntry.source = layer;
+
+    Entry& e = entries_[key];
+    e        = std::move(newEntry);
+
+    return lambdaResult(e);
+
+    MRPT_END
+}
+
+void NearestNeighborsIndexCache::invalidate(const mrpt::maps::CMetricMap& layer)
+{
+    std::unique_lock<std::shared_mutex> lck(entriesMtx_);
+
+    generation_++;
+
+    for (auto it = entries_.begin(); it != entries_.end();)
+    {
+        if (it->first.first == &layer)
+            it = entries_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void NearestNeighborsIndexCache::clear()
+{
+    std::unique_lock<std::shared_mutex> lck(entriesMtx_);
+    generation_++;
+    entries_.clear();
+}
+
+std::size_t NearestNeighborsIndexCache::size() const
+{
+    std::shared_lock<std::shared_mutex> lck(entriesMtx_);
+    return entries_.size();
+}
+
+uint64_t NearestNeighborsIndexCache::generation() const
+{
+    std::shared_lock<std::shared_mutex> lck(entriesMtx_);
+    return generation_;
+}
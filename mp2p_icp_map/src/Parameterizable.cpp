@@ -7,6 +7,8 @@
 #include <mp2p_icp/Parameterizable.h>
 #include <mrpt/core/exceptions.h>
 
+#include <algorithm>
+#include <cctype>
 #include <sstream>
 #include <stdexcept>
 
@@ -14,12 +16,36 @@ using namespace mp2p_icp;
 
 void ParameterSource::attach(Parameterizable& obj)
 {
-    for (auto& p : obj.declaredParameters())  //
+    for (auto& p : obj.declaredParameters())
+    {
         attachedDeclParameters_.insert(&p);
 
+        // Expressions compiled against another source must be recompiled:
+        if (!p.is_constant && p.compiledFor != this)
+        {
+            p.compiled.reset();
+            p.dependencies.clear();
+            p.compiledFor        = nullptr;
+            p.has_been_evaluated = false;
+        }
+    }
+
     obj.attachedSource_ = this;
 }
 
+ParameterSource::VariableSlot ParameterSource::variableSlot(
+    const std::string& variable)
+{
+    auto [itVal, isNew] = variables_.try_emplace(variable, 0.0);
+    bool& dirty         = dirty_[variable];
+    if (isNew) dirty = true;
+
+    VariableSlot slot;
+    slot.value_ = &itVal->second;
+    slot.dirty_ = &dirty;
+    return slot;
+}
+
 std::string ParameterSource::printVariableValues() const
 {
     std::string s;
@@ -38,16 +64,43 @@ void ParameterSource::realize()
 {
     // Here comes the beef:
     // 1) Compile uncompiled expressions,
-    // 2) Eval them all and store the results in their target.
+    // 2) Eval those depending on modified variables, and store the results in
+    // their target.
 
     // 1) compile?
     for (auto& p : attachedDeclParameters_)
     {
         if (p->is_constant) continue;
-        if (p->compiled.has_value()) continue;  // already done:
+        if (p->compiled.has_value() && p->compiledFor == this)
+            continue;  // already done
 
         auto& expr = p->compiled.emplace();
         expr.compile(p->expression, variables_);
+        p->compiledFor        = this;
+        p->has_been_evaluated = false;
+
+        // Find out the variables in the expression. Any identifier which is
+        // not a variable (e.g. function names) is just ignored:
+        p->dependencies.clear();
+        const auto& str = p->expression;
+        for (size_t i = 0; i < str.size();)
+        {
+            if (!std::isalpha(static_cast<unsigned char>(str[i])) &&
+                str[i] != '_')
+            {
+                i++;
+                continue;
+            }
+            size_t j = i + 1;
+            while (j < str.size() &&
+                   (std::isalnum(static_cast<unsigned char>(str[j])) ||
+                    str[j] == '_'))
+                j++;
+
+            if (auto it = dirty_.find(str.substr(i, j - i)); it != dirty_.end())
+                p->dependencies.push_back(&it->second);
+            i = j;
+        }
     }
 
     // 2) Evaluate and store:
@@ -55,6 +108,13 @@ void ParameterSource::realize()
     {
         if (p->is_constant) continue;
 
+        // Skip if none of its variables changed:
+        if (p->has_been_evaluated &&
+            std::none_of(
+                p->dependencies.begin(), p->dependencies.end(),
+                [](const bool* dirty) { return *dirty; }))
+            continue;
+
         const double val = p->compiled->eval();
 
         std::visit(
@@ -84,6 +144,9 @@ void ParameterSource::realize()
 
         p->has_been_evaluated = true;
     }
+
+    // 3) All changes have been propagated:
+    for (auto& [name, dirty] : dirty_) dirty = false;
 }
 
 template <typename T>
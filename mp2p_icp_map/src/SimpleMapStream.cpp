@@ -0,0 +1,292 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   SimpleMapStream.cpp
+ * @brief  Keyframe by keyframe reading and writing of .simplemap files
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/SimpleMapStream.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/io/CFileInputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/io/zip.h>
+#include <mrpt/serialization/optional_serialization.h>
+#include <mrpt/system/filesystem.h>
+
+#include <filesystem>
+#include <iostream>
+#include <limits>
+
+using namespace mp2p_icp;
+
+/* A serialized CSimpleMap, as written by CArchive::WriteObject(), is:
+ *  - uint8:  0x80 | length of the class name
+ *  - the class name
+ *  - uint8:  serialization version (1: no twist, 2: with optional twist)
+ *  - uint32: number of keyframes
+ *  - for each keyframe: CPose3DPDF object, CSensoryFrame object, and (v>=2)
+ *    std::optional<TTwist3D>
+ *  - uint8:  end flag (0x88)
+ */
+namespace
+{
+constexpr uint8_t CLASS_NAME_FLAG = 0x80;
+
+struct SimpleMapFraming
+{
+    std::vector<uint8_t> header;  //!< Up to, and excluding, the count
+    uint8_t              version = 0;
+    uint8_t              endFlag = 0;
+};
+
+// Gets the framing bytes from the serialization of an empty map, so they
+// always match those of the MRPT version we are built against:
+const SimpleMapFraming& simplemap_framing()
+{
+    static const SimpleMapFraming framing = []()
+    {
+        const mrpt::maps::CSimpleMap emptyMap;
+        const std::string className = emptyMap.GetRuntimeClass()->className;
+
+        mrpt::io::CMemoryStream buf;
+        auto                    arch = mrpt::serialization::archiveFrom(buf);
+        arch << emptyMap;
+
+        const auto* data =
+            reinterpret_cast<const uint8_t*>(buf.getRawBufferData());
+        const std::size_t len         = buf.getTotalBytesCount();
+        const std::size_t headerLen   = 1 + className.size() + 1;
+        const std::size_t expectedLen = headerLen + sizeof(uint32_t) + 1;
+
+        ASSERTMSG_(
+            len == expectedLen &&
+                data[0] == (CLASS_NAME_FLAG | className.size()),
+            "Unexpected CSimpleMap serialization format");
+
+        SimpleMapFraming f;
+        f.header.assign(data, data + headerLen);
+        f.version = data[headerLen - 1];
+        f.endFlag = data[len - 1];
+
+        ASSERTMSG_(
+            f.version == 1 || f.version == 2,
+            mrpt::format(
+                "Unsupported CSimpleMap serialization version: %u",
+                static_cast<unsigned>(f.version)));
+
+        return f;
+    }();
+    return framing;
+}
+
+std::vector<uint8_t> gzip(const std::vector<uint8_t>& data, int level)
+{
+    std::vector<uint8_t> gz;
+    const bool ok = mrpt::io::zip::compress_gz_data_block(data, gz, level);
+    ASSERTMSG_(ok, "Error compressing data block");
+    return gz;
+}
+
+}  // namespace
+
+// --------------------------------------------------------------------------
+// SimpleMapReader
+// --------------------------------------------------------------------------
+SimpleMapReader::SimpleMapReader(const std::string& fileName)
+{
+    open(fileName);
+}
+
+void SimpleMapReader::open(const std::string& fileName)
+{
+    if (!f_.open(fileName))
+        THROW_EXCEPTION_FMT("Error opening file: '%s'", fileName.c_str());
+
+    const auto& framing = simplemap_framing();
+
+    const uint8_t nameLenFlag = arch_.ReadAs<uint8_t>();
+    ASSERTMSG_(
+        (nameLenFlag & CLASS_NAME_FLAG) != 0,
+        "File does not contain a serialized CSimpleMap");
+
+    std::string className(nameLenFlag & 0x7f, ' ');
+    const size_t nRead = arch_.ReadBuffer(className.data(), className.size());
+    ASSERT_EQUAL_(nRead, className.size());
+
+    // Old files may not have the namespace:
+    const std::string expected = "CSimpleMap";
+    ASSERTMSG_(
+        className.size() >= expected.size() &&
+            className.compare(
+                className.size() - expected.size(), expected.size(),
+                expected) == 0,
+        mrpt::format(
+            "File contains a '%s' object, expected a CSimpleMap",
+            className.c_str()));
+
+    version_ = arch_.ReadAs<uint8_t>();
+    ASSERTMSG_(
+        version_ >= 1 && version_ <= framing.version,
+        mrpt::format(
+            "Unsupported CSimpleMap serialization version: %u",
+            static_cast<unsigned>(version_)));
+
+    count_     = arch_.ReadAs<uint32_t>();
+    readCount_ = 0;
+}
+
+bool SimpleMapReader::next(mrpt::maps::CSimpleMap::Keyframe& kf)
+{
+    ASSERTMSG_(f_.is_open(), "next() called before open()");
+
+    if (readCount_ >= count_) return false;
+
+    kf.pose = arch_.ReadObject<mrpt::poses::CPose3DPDF>();
+    kf.sf   = arch_.ReadObject<mrpt::obs::CSensoryFrame>();
+    if (version_ >= 2)
+        arch_ >> kf.localTwist;
+    else
+        kf.localTwist.reset();
+
+    if (++readCount_ == count_)
+    {
+        const uint8_t endFlag = arch_.ReadAs<uint8_t>();
+        ASSERTMSG_(
+            endFlag == simplemap_framing().endFlag,
+            "Corrupted simplemap file: missing end flag");
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------------------------
+// SimpleMapWriter
+// --------------------------------------------------------------------------
+SimpleMapWriter::SimpleMapWriter(
+    const std::string& fileName, const BlockGZOutputStream::Parameters& p)
+{
+    open(fileName, p);
+}
+
+SimpleMapWriter::~SimpleMapWriter() { discard(); }
+
+void SimpleMapWriter::open(
+    const std::string& fileName, const BlockGZOutputStream::Parameters& p)
+{
+    discard();
+
+    // Fail early if the MRPT format is not the expected one:
+    simplemap_framing();
+
+    fileName_     = fileName;
+    bodyFileName_ = fileName + ".body.tmp";
+    partFileName_ = fileName + ".part.tmp";
+    params_       = p;
+    count_        = 0;
+
+    if (!body_.open(bodyFileName_, params_))
+        THROW_EXCEPTION_FMT("Error creating file: '%s'", bodyFileName_.c_str());
+}
+
+void SimpleMapWriter::append(const mrpt::maps::CSimpleMap::Keyframe& kf)
+{
+    ASSERTMSG_(body_.is_open(), "append() called before open()");
+    ASSERT_(kf.pose);
+    ASSERT_(kf.sf);
+    ASSERT_LT_(count_, std::numeric_limits<uint32_t>::max());
+
+    auto arch = mrpt::serialization::archiveFrom(body_);
+    arch << *kf.pose << *kf.sf;
+    if (simplemap_framing().version >= 2) arch << kf.localTwist;
+
+    count_++;
+}
+
+void SimpleMapWriter::close()
+{
+    if (!body_.is_open()) return;
+
+    try
+    {
+        body_.close();
+        write_final_file();
+
+        // Only replace the output file once it is complete:
+        std::filesystem::rename(partFileName_, fileName_);
+    }
+    catch (...)
+    {
+        mrpt::system::deleteFile(partFileName_);
+        mrpt::system::deleteFile(bodyFileName_);
+        throw;
+    }
+
+    mrpt::system::deleteFile(bodyFileName_);
+}
+
+void SimpleMapWriter::discard()
+{
+    if (!body_.is_open()) return;
+
+    try
+    {
+        body_.close();
+    }
+    catch (const std::exception&)
+    {
+        // Ignore: the file is removed anyway.
+    }
+
+    mrpt::system::deleteFile(bodyFileName_);
+}
+
+void SimpleMapWriter::write_final_file()
+{
+    const auto& framing = simplemap_framing();
+
+    // Header (with the final count) and end flag, each one as an independent
+    // GZIP member around the already compressed keyframes:
+    std::vector<uint8_t> header;
+    {
+        mrpt::io::CMemoryStream buf;
+        auto                    arch = mrpt::serialization::archiveFrom(buf);
+        arch.WriteBuffer(framing.header.data(), framing.header.size());
+        arch.WriteAs<uint32_t>(count_);
+
+        const auto* data =
+            reinterpret_cast<const uint8_t*>(buf.getRawBufferData());
+        header.assign(data, data + buf.getTotalBytesCount());
+    }
+
+    mrpt::io::CFileOutputStream f;
+    if (!f.open(partFileName_))
+        THROW_EXCEPTION_FMT("Error creating file: '%s'", partFileName_.c_str());
+
+    const auto gzHeader = gzip(header, params_.compressionLevel);
+    f.WriteBuffer(gzHeader.data(), gzHeader.size());
+
+    {
+        mrpt::io::CFileInputStream body;
+        if (!body.open(bodyFileName_))
+            THROW_EXCEPTION_FMT(
+                "Error reading file: '%s'", bodyFileName_.c_str());
+
+        std::vector<uint8_t> buf(16 * 1024 * 1024);
+        for (;;)
+        {
+            const size_t n = body.Read(buf.data(), buf.size());
+            if (n == 0) break;
+            f.WriteBuffer(buf.data(), n);
+        }
+    }
+
+    const auto gzEnd = gzip({framing.endFlag}, params_.compressionLevel);
+    f.WriteBuffer(gzEnd.data(), gzEnd.size());
+    f.close();
+}
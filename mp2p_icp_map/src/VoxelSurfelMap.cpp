@@ -0,0 +1,531 @@
+/* -------------------------------------------------------------------------
+ *  A repertory of multi primitive-to-primitive (MP2P) ICP algorithms in C++
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   VoxelSurfelMap.cpp
+ * @brief  Voxelized map of surfels (local plane fits), for pt-to-plane ICP
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/VoxelSurfelMap.h>
+#include <mrpt/config/CConfigFileBase.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/math/CMatrixFixed.h>
+#include <mrpt/opengl/CPointCloud.h>
+#include <mrpt/opengl/CSetOfLines.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+#include <mrpt/serialization/CArchive.h>
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+using namespace mp2p_icp;
+using namespace std::string_literals;
+
+//  =========== Begin of Map definition ============
+MAP_DEFINITION_REGISTER(
+    "mp2p_icp::VoxelSurfelMap,voxelSurfelMap", mp2p_icp::VoxelSurfelMap)
+
+VoxelSurfelMap::TMapDefinition::TMapDefinition() = default;
+
+void VoxelSurfelMap::TMapDefinition::loadFromConfigFile_map_specific(
+    const mrpt::config::CConfigFileBase& s, const std::string& sectionPrefix)
+{
+    // [<sectionNamePrefix>+"_creationOpts"]
+    const std::string sSectCreation = sectionPrefix + "_creationOpts"s;
+    MRPT_LOAD_CONFIG_VAR(voxel_size, float, s, sSectCreation);
+
+    insertionOpts.loadFromConfigFile(s, sectionPrefix + "_insertOpts"s);
+    renderOpts.loadFromConfigFile(s, sectionPrefix + "_renderOpts"s);
+}
+
+void VoxelSurfelMap::TMapDefinition::dumpToTextStream_map_specific(
+    std::ostream& out) const
+{
+    LOADABLEOPTS_DUMP_VAR(voxel_size, float);
+
+    insertionOpts.dumpToTextStream(out);
+    renderOpts.dumpToTextStream(out);
+}
+
+mrpt::maps::CMetricMap::Ptr VoxelSurfelMap::internal_CreateFromMapDefinition(
+    const mrpt::maps::TMetricMapInitializer& _def)
+{
+    const auto* def =
+        dynamic_cast<const VoxelSurfelMap::TMapDefinition*>(&_def);
+    ASSERT_(def);
+
+    auto obj              = VoxelSurfelMap::Create(def->voxel_size);
+    obj->insertionOptions = def->insertionOpts;
+    obj->renderOptions    = def->renderOpts;
+    return obj;
+}
+//  =========== End of Map definition Block =========
+
+IMPLEMENTS_SERIALIZABLE(VoxelSurfelMap, mrpt::maps::CMetricMap, mp2p_icp)
+
+VoxelSurfelMap::VoxelSurfelMap(float voxel_size)
+{
+    setVoxelProperties(voxel_size);
+}
+
+void VoxelSurfelMap::setVoxelProperties(float voxel_size)
+{
+    ASSERT_GT_(voxel_size, .0f);
+
+    voxel_size_     = voxel_size;
+    voxel_size_inv_ = 1.0f / voxel_size;
+
+    internal_clear();
+}
+
+// =========== Serialization ==============
+uint8_t VoxelSurfelMap::serializeGetVersion() const { return 0; }
+void    VoxelSurfelMap::serializeTo(mrpt::serialization::CArchive& out) const
+{
+    out << voxel_size_;
+    insertionOptions.writeToStream(out);
+    renderOptions.writeToStream(out);
+
+    out << bbMin_.x << bbMin_.y << bbMin_.z << bbMax_.x << bbMax_.y
+        << bbMax_.z;
+
+    // Only moments are stored; plane fits are recomputed when loading:
+    out.WriteAs<uint32_t>(voxels_.size());
+    for (const auto& [idx, s] : voxels_)
+    {
+        out << idx.cx << idx.cy << idx.cz << s.count;
+        for (const double v : s.sum) out << v;
+        for (const double v : s.sumSq) out << v;
+    }
+}
+void VoxelSurfelMap::serializeFrom(
+    mrpt::serialization::CArchive& in, uint8_t version)
+{
+    switch (version)
+    {
+        case 0:
+        {
+            float voxelSize = 0;
+            in >> voxelSize;
+            setVoxelProperties(voxelSize);  // This also clears the map
+
+            insertionOptions.readFromStream(in);
+            renderOptions.readFromStream(in);
+
+            in >> bbMin_.x >> bbMin_.y >> bbMin_.z >> bbMax_.x >> bbMax_.y >>
+                bbMax_.z;
+
+            const auto nVoxels = in.ReadAs<uint32_t>();
+            voxels_.reserve(nVoxels);
+            for (uint32_t i = 0; i < nVoxels; i++)
+            {
+                VoxelIndex idx;
+                Surfel     s;
+                in >> idx.cx >> idx.cy >> idx.cz >> s.count;
+                for (double& v : s.sum) in >> v;
+                for (double& v : s.sumSq) in >> v;
+
+                fit(idx, s);
+                voxels_[idx] = s;
+            }
+        }
+        break;
+        default:
+            MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version);
+    };
+}
+
+// =========== Insertion ==============
+VoxelSurfelMap::Surfel& VoxelSurfelMap::accumulate(
+    const mrpt::math::TPoint3Df& pt, VoxelIndex& idx)
+{
+    if (voxels_.empty())
+    {
+        bbMin_ = pt;
+        bbMax_ = pt;
+    }
+    else
+    {
+        mrpt::keep_min(bbMin_.x, pt.x);
+        mrpt::keep_min(bbMin_.y, pt.y);
+        mrpt::keep_min(bbMin_.z, pt.z);
+        mrpt::keep_max(bbMax_.x, pt.x);
+        mrpt::keep_max(bbMax_.y, pt.y);
+        mrpt::keep_max(bbMax_.z, pt.z);
+    }
+
+    idx = coordToIndex(pt);
+
+    Surfel&    s = voxels_[idx];
+    const auto c = indexToCoord(idx);
+
+    const double dx = pt.x - c.x, dy = pt.y - c.y, dz = pt.z - c.z;
+
+    s.count++;
+    s.sum[0] += dx;
+    s.sum[1] += dy;
+    s.sum[2] += dz;
+    s.sumSq[0] += dx * dx;
+    s.sumSq[1] += dx * dy;
+    s.sumSq[2] += dx * dz;
+    s.sumSq[3] += dy * dy;
+    s.sumSq[4] += dy * dz;
+    s.sumSq[5] += dz * dz;
+
+    return s;
+}
+
+void VoxelSurfelMap::fit(const VoxelIndex& idx, Surfel& s) const
+{
+    s.isPlane = false;
+    if (s.count == 0) return;
+
+    const double inv_n = 1.0 / s.count;
+    const double mx = s.sum[0] * inv_n, my = s.sum[1] * inv_n,
+                 mz = s.sum[2] * inv_n;
+
+    const auto c = indexToCoord(idx);
+    s.mean       = {
+        static_cast<float>(c.x + mx), static_cast<float>(c.y + my),
+        static_cast<float>(c.z + mz)};
+
+    if (s.count < 3 || s.count < insertionOptions.min_points_per_plane)
+        return;
+
+    mrpt::math::CMatrixFixed<double, 3, 3> cov;
+    cov(0, 0) = s.sumSq[0] * inv_n - mx * mx;
+    cov(1, 0) = s.sumSq[1] * inv_n - mx * my;
+    cov(2, 0) = s.sumSq[2] * inv_n - mx * mz;
+    cov(1, 1) = s.sumSq[3] * inv_n - my * my;
+    cov(2, 1) = s.sumSq[4] * inv_n - my * mz;
+    cov(2, 2) = s.sumSq[5] * inv_n - mz * mz;
+    cov(0, 1) = cov(1, 0);
+    cov(0, 2) = cov(2, 0);
+    cov(1, 2) = cov(2, 1);
+
+    // Eigenvalues in ascending order:
+    mrpt::math::CMatrixFixed<double, 3, 3> eigVectors;
+    std::vector<double>                    eigVals;
+    cov.eig_symmetric(eigVectors, eigVals);
+
+    // Clamp round-off negative values:
+    const double e0 = std::max(eigVals[0], 0.0), e1 = eigVals[1],
+                 e2 = eigVals[2];
+
+    if (e2 <= 0) return;
+
+    s.planarity = static_cast<float>((e1 - e0) / e2);
+
+    auto n = eigVectors.extractColumn<mrpt::math::TVector3D>(0);
+
+    // Deterministic orientation: largest component is positive.
+    const double ax = std::abs(n.x), ay = std::abs(n.y), az = std::abs(n.z);
+    const double major = (ax >= ay && ax >= az) ? n.x : (ay >= az ? n.y : n.z);
+    if (major < 0) n *= -1.0;
+
+    s.normal = {
+        static_cast<float>(n.x), static_cast<float>(n.y),
+        static_cast<float>(n.z)};
+
+    s.isPlane =
+        e1 > 0 && e0 < insertionOptions.plane_eigen_threshold * e1;
+}
+
+void VoxelSurfelMap::insertPoint(const mrpt::math::TPoint3Df& pt)
+{
+    VoxelIndex idx;
+    Surfel&    s = accumulate(pt, idx);
+    fit(idx, s);
+}
+
+void VoxelSurfelMap::insertPointCloud(
+    const mrpt::maps::CPointsMap& pts, const mrpt::poses::CPose3D& pose)
+{
+    MRPT_START
+
+    const auto& xs = pts.getPointsBufferRef_x();
+    const auto& ys = pts.getPointsBufferRef_y();
+    const auto& zs = pts.getPointsBufferRef_z();
+
+    std::unordered_set<VoxelIndex, VoxelIndexHash> touched;
+
+    for (size_t i = 0; i < xs.size(); i++)
+    {
+        double gx, gy, gz;
+        pose.composePoint(xs[i], ys[i], zs[i], gx, gy, gz);
+
+        VoxelIndex idx;
+        accumulate(
+            {static_cast<float>(gx), static_cast<float>(gy),
+             static_cast<float>(gz)},
+            idx);
+        touched.insert(idx);
+    }
+
+    // Re-fit each modified voxel only once:
+    for (const auto& idx : touched) fit(idx, voxels_.at(idx));
+
+    MRPT_END
+}
+
+bool VoxelSurfelMap::internal_insertObservation(
+    const mrpt::obs::CObservation&                   obs,
+    const std::optional<const mrpt::poses::CPose3D>& robotPose)
+{
+    MRPT_START
+
+    // Reuse the observation-to-points conversions of point maps:
+    mrpt::maps::CSimplePointsMap pts;
+    pts.insertionOptions.minDistBetweenLaserPoints = 0;
+
+    if (!pts.insertObservation(obs, robotPose)) return false;
+
+    insertPointCloud(pts, mrpt::poses::CPose3D::Identity());
+    return true;
+
+    MRPT_END
+}
+
+double VoxelSurfelMap::internal_computeObservationLikelihood(
+    [[maybe_unused]] const mrpt::obs::CObservation& obs,
+    [[maybe_unused]] const mrpt::poses::CPose3D&    takenFrom) const
+{
+    return .0;
+}
+
+bool VoxelSurfelMap::internal_canComputeObservationLikelihood(
+    [[maybe_unused]] const mrpt::obs::CObservation& obs) const
+{
+    return false;
+}
+
+void VoxelSurfelMap::internal_clear()
+{
+    voxels_.clear();
+    bbMin_ = {0, 0, 0};
+    bbMax_ = {0, 0, 0};
+}
+
+// =========== Queries ==============
+NearestPlaneCapable::NearestPlaneResult VoxelSurfelMap::nn_search_pt2pl(
+    const mrpt::math::TPoint3Df& point, const float max_search_distance) const
+{
+    NearestPlaneResult ret;
+
+    if (voxels_.empty()) return ret;
+
+    const VoxelIndex c         = coordToIndex(point);
+    const float      maxDistSq = mrpt::square(max_search_distance);
+
+    // Distance from the point to the [lo,hi] range of a voxel, along one axis:
+    const auto lambdaAxisDist = [this](float v, int32_t cellIdx)
+    {
+        const float lo = cellIdx * voxel_size_, hi = lo + voxel_size_;
+        return v < lo ? lo - v : (v > hi ? v - hi : 0.0f);
+    };
+
+    for (int32_t dx = -1; dx <= 1; dx++)
+    {
+        const float ddx = lambdaAxisDist(point.x, c.cx + dx);
+        for (int32_t dy = -1; dy <= 1; dy++)
+        {
+            const float ddy = lambdaAxisDist(point.y, c.cy + dy);
+            for (int32_t dz = -1; dz <= 1; dz++)
+            {
+                const float ddz = lambdaAxisDist(point.z, c.cz + dz);
+
+                // Voxel too far?
+                if (ddx * ddx + ddy * ddy + ddz * ddz > maxDistSq) continue;
+
+                const Surfel* s =
+                    surfelByIndex({c.cx + dx, c.cy + dy, c.cz + dz});
+                if (!s || !s->isPlane) continue;
+
+                const float dist = std::abs(
+                    s->normal.x * (point.x - s->mean.x) +
+                    s->normal.y * (point.y - s->mean.y) +
+                    s->normal.z * (point.z - s->mean.z));
+
+                if (dist > max_search_distance) continue;
+                if (ret.pairing && dist >= ret.distance) continue;
+
+                // Surfel normals are already unit vectors:
+                auto& pp    = ret.pairing.emplace();
+                pp.normal   = s->normal;
+                pp.offset   = -(s->normal.x * s->mean.x +
+                              s->normal.y * s->mean.y +
+                              s->normal.z * s->mean.z);
+                pp.pt_local = point;
+                ret.distance = dist;
+            }
+        }
+    }
+
+    return ret;
+}
+
+// =========== CMetricMap API ==============
+std::string VoxelSurfelMap::asString() const
+{
+    std::size_t nPlanes = 0;
+    for (const auto& kv : voxels_)
+        if (kv.second.isPlane) nPlanes++;
+
+    return mrpt::format(
+        "VoxelSurfelMap, voxel_size=%.03f, %zu voxels (%zu planar)",
+        voxel_size_, voxels_.size(), nPlanes);
+}
+
+bool VoxelSurfelMap::isEmpty() const { return voxels_.empty(); }
+
+mrpt::math::TBoundingBoxf VoxelSurfelMap::boundingBox() const
+{
+    return mrpt::math::TBoundingBoxf(bbMin_, bbMax_);
+}
+
+void VoxelSurfelMap::getVisualizationInto(
+    mrpt::opengl::CSetOfObjects& outObj) const
+{
+    MRPT_START
+
+    if (!genericMapParams.enableSaveAs3DObject) return;
+
+    auto glPts = mrpt::opengl::CPointCloud::Create();
+    glPts->setPointSize(renderOptions.point_size);
+    glPts->setColor(renderOptions.color);
+
+    auto glNormals = mrpt::opengl::CSetOfLines::Create();
+    glNormals->setColor(renderOptions.color);
+
+    const float normalLength = 0.5f * voxel_size_;
+
+    for (const auto& kv : voxels_)
+    {
+        const Surfel& s = kv.second;
+        if (!s.isPlane) continue;
+
+        glPts->insertPoint(s.mean.x, s.mean.y, s.mean.z);
+
+        if (renderOptions.show_normals)
+        {
+            glNormals->appendLine(
+                s.mean.x, s.mean.y, s.mean.z,
+                s.mean.x + normalLength * s.normal.x,
+                s.mean.y + normalLength * s.normal.y,
+                s.mean.z + normalLength * s.normal.z);
+        }
+    }
+
+    outObj.insert(glPts);
+    if (renderOptions.show_normals) outObj.insert(glNormals);
+
+    MRPT_END
+}
+
+void VoxelSurfelMap::saveMetricMapRepresentationToFile(
+    const std::string& filNamePrefix) const
+{
+    const std::string fil = filNamePrefix + "_surfels.txt"s;
+
+    std::ofstream f(fil);
+    ASSERTMSG_(f.is_open(), mrpt::format("Cannot write to '%s'", fil.c_str()));
+
+    f << "% x y z nx ny nz planarity is_plane count\n";
+    for (const auto& kv : voxels_)
+    {
+        const Surfel& s = kv.second;
+        f << s.mean.x << " " << s.mean.y << " " << s.mean.z << " "
+          << s.normal.x << " " << s.normal.y << " " << s.normal.z << " "
+          << s.planarity << " " << (s.isPlane ? 1 : 0) << " " << s.count
+          << "\n";
+    }
+}
+
+// =========== Options ==============
+void VoxelSurfelMap::TInsertionOptions::loadFromConfigFile(
+    const mrpt::config::CConfigFileBase& c, const std::string& s)
+{
+    MRPT_LOAD_CONFIG_VAR(min_points_per_plane, uint64_t, c, s);
+    MRPT_LOAD_CONFIG_VAR(plane_eigen_threshold, float, c, s);
+}
+
+void VoxelSurfelMap::TInsertionOptions::saveToConfigFile(
+    mrpt::config::CConfigFileBase& c, const std::string& s) const
+{
+    MRPT_SAVE_CONFIG_VAR(min_points_per_plane, c, s);
+    MRPT_SAVE_CONFIG_VAR(plane_eigen_threshold, c, s);
+}
+
+void VoxelSurfelMap::TInsertionOptions::writeToStream(
+    mrpt::serialization::CArchive& out) const
+{
+    const uint8_t version = 0;
+    out << version;
+    out << min_points_per_plane << plane_eigen_threshold;
+}
+
+void VoxelSurfelMap::TInsertionOptions::readFromStream(
+    mrpt::serialization::CArchive& in)
+{
+    const uint8_t version = in.ReadAs<uint8_t>();
+    switch (version)
+    {
+        case 0:
+            in >> min_points_per_plane >> plane_eigen_threshold;
+            break;
+        default:
+            MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version);
+    }
+}
+
+void VoxelSurfelMap::TRenderOptions::loadFromConfigFile(
+    const mrpt::config::CConfigFileBase& c, const std::string& s)
+{
+    MRPT_LOAD_CONFIG_VAR(point_size, float, c, s);
+    MRPT_LOAD_CONFIG_VAR(show_normals, bool, c, s);
+    MRPT_LOAD_CONFIG_VAR(color.R, float, c, s);
+    MRPT_LOAD_CONFIG_VAR(color.G, float, c, s);
+    MRPT_LOAD_CONFIG_VAR(color.B, float, c, s);
+}
+
+void VoxelSurfelMap::TRenderOptions::saveToConfigFile(
+    mrpt::config::CConfigFileBase& c, const std::string& s) const
+{
+    MRPT_SAVE_CONFIG_VAR(point_size, c, s);
+    MRPT_SAVE_CONFIG_VAR(show_normals, c, s);
+    MRPT_SAVE_CONFIG_VAR(color.R, c, s);
+    MRPT_SAVE_CONFIG_VAR(color.G, c, s);
+    MRPT_SAVE_CONFIG_VAR(color.B, c, s);
+}
+
+void VoxelSurfelMap::TRenderOptions::writeToStream(
+    mrpt::serialization::CArchive& out) const
+{
+    const uint8_t version = 0;
+    out << version;
+    out << point_size << show_normals << color.R << color.G << color.B
+        << color.A;
+}
+
+void VoxelSurfelMap::TRenderOptions::readFromStream(
+    mrpt::serialization::CArchive& in)
+{
+    const uint8_t version = in.ReadAs<uint8_t>();
+    switch (version)
+    {
+        case 0:
+            in >> point_size >> show_normals >> color.R >> color.G >>
+                color.B >> color.A;
+            break;
+        default:
+            MRPT_THROW_UNKNOWN_SERIALIZATION_VERSION(version);
+    }
+}
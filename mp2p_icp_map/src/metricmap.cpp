@@ -10,9 +10,9 @@
  * @date   Jun 10, 2019
  */
 
+#include <mp2p_icp/BlockGZOutputStream.h>
 #include <mp2p_icp/metricmap.h>
 #include <mrpt/io/CFileGZInputStream.h>
-#include <mrpt/io/CFileGZOutputStream.h>
 #include <mrpt/maps/CVoxelMap.h>
 #include <mrpt/maps/CVoxelMapRGB.h>
 #include <mrpt/math/CHistogram.h>
@@ -28,6 +28,7 @@
 #include <mrpt/system/string_utils.h>  // unitsFormat()
 
 #include <algorithm>
+#include <iostream>
 #include <iterator>
 
 IMPLEMENTS_MRPT_OBJECT(
@@ -566,13 +567,22 @@ std::string metric_map_t::contents_summary() const
 
 bool metric_map_t::save_to_file(const std::string& fileName) const
 {
-    auto f = mrpt::io::CFileGZOutputStream(fileName);
-    if (!f.is_open()) return false;
+    try
+    {
+        BlockGZOutputStream f;
+        if (!f.open(fileName)) return false;
 
-    auto arch = mrpt::serialization::archiveFrom(f);
-    arch << *this;
+        auto arch = mrpt::serialization::archiveFrom(f);
+        arch << *this;
+        f.close();
 
-    return true;
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "[metric_map_t::save_to_file] Error: " << e.what();
+        return false;
+    }
 }
 
 bool metric_map_t::load_from_file(const std::string& fileName)
@@ -645,6 +655,17 @@ mrpt::maps::CPointsMap::Ptr metric_map_t::point_layer(
     return ret;
 }
 
+const mrpt::maps::CMetricMap& metric_map_t::layer_for_nn_queries(
+    const layer_name_t&               name,
+    const std::optional<std::size_t>& kdtreeLeafMaxSize) const
+{
+    auto it = layers.find(name);
+    if (it == layers.end())
+        THROW_EXCEPTION_FMT("Layer '%s' does not exist.", name.c_str());
+
+    return nnIndexCache_->get(it->second, kdtreeLeafMaxSize);
+}
+
 const mrpt::maps::CPointsMap* mp2p_icp::MapToPointsMap(
     const mrpt::maps::CMetricMap& map)
 {
@@ -10,6 +10,7 @@
  * @date   Jun 10, 2019
  */
 
+#include <mp2p_icp/VoxelSurfelMap.h>
 #include <mp2p_icp/metricmap.h>
 #include <mrpt/core/initializer.h>
 
@@ -23,4 +24,5 @@ MRPT_INITIALIZER(register_mp2p_icp_map)
     using mrpt::rtti::registerClass;
 
     registerClass(CLASS_ID(mp2p_icp::metric_map_t));
+    registerClass(CLASS_ID(mp2p_icp::VoxelSurfelMap));
 }
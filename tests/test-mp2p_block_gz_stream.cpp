@@ -0,0 +1,93 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_block_gz_stream.cpp
+ * @brief  Unit tests for BlockGZOutputStream
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/BlockGZOutputStream.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/io/CFileGZInputStream.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/filesystem.h>
+
+static void test_block_gz_roundtrip(std::size_t blockSize, std::size_t threads)
+{
+    const auto fileName = mrpt::system::getTempFileName() + ".mm";
+
+    auto pts = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = 0; i < 20000; i++) pts->insertPoint(i * 0.1f, 1.0f, -i * 0.2f);
+
+    mp2p_icp::metric_map_t m;
+    m.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = pts;
+
+    {
+        mp2p_icp::BlockGZOutputStream::Parameters p;
+        p.blockSize = blockSize;
+        p.threads   = threads;
+
+        mp2p_icp::BlockGZOutputStream f(fileName, p);
+        auto arch = mrpt::serialization::archiveFrom(f);
+        arch << m;
+        arch << static_cast<uint32_t>(0x12345678);
+        f.close();
+    }
+
+    // Read back as a regular GZIP stream:
+    {
+        mrpt::io::CFileGZInputStream f(fileName);
+        auto                         arch = mrpt::serialization::archiveFrom(f);
+
+        mp2p_icp::metric_map_t m2;
+        arch >> m2;
+
+        uint32_t tail = 0;
+        arch >> tail;
+        ASSERT_EQUAL_(tail, 0x12345678U);
+
+        ASSERT_EQUAL_(m2.size_points_only(), 20000U);
+        const auto pts2 = m2.point_layer(mp2p_icp::metric_map_t::PT_LAYER_RAW);
+        ASSERT_NEAR_(pts2->getPointsBufferRef_x()[1234], 123.4f, 1e-3f);
+        ASSERT_NEAR_(pts2->getPointsBufferRef_z()[1234], -246.8f, 1e-3f);
+    }
+
+    mrpt::system::deleteFile(fileName);
+}
+
+static void test_block_gz_empty()
+{
+    const auto fileName = mrpt::system::getTempFileName() + ".gz";
+
+    {
+        mp2p_icp::BlockGZOutputStream f(fileName);
+    }
+
+    mrpt::io::CFileGZInputStream f(fileName);
+    uint8_t                      buf[4];
+    ASSERT_EQUAL_(f.Read(buf, sizeof(buf)), 0U);
+
+    mrpt::system::deleteFile(fileName);
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_block_gz_roundtrip(4 * 1024 * 1024, 0);  // A single block
+        test_block_gz_roundtrip(1000, 3);  // Many blocks, in flight
+        test_block_gz_roundtrip(1000, 1);
+        test_block_gz_empty();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -63,6 +63,11 @@ static void test_Jacob_error_point2point()
 
     const mrpt::math::CMatrixFixed<double, 3, 6> jacob(J1 * dDexpe_de);
 
+    // Closed-form tangent-space Jacobian:
+    mrpt::math::CMatrixFixed<double, 3, 6> J6;
+    mp2p_icp::error_point2point(pair, p, J6);
+    ASSERT_LT_((J6.asEigen() - jacob.asEigen()).array().abs().maxCoeff(), 1e-6);
+
     // Numerical Jacobian:
     CMatrixDouble numJacob;
     {
@@ -135,6 +140,11 @@ static void test_Jacob_error_point2line()
 
     const mrpt::math::CMatrixFixed<double, 3, 6> jacob(J1 * dDexpe_de);
 
+    // Closed-form tangent-space Jacobian:
+    mrpt::math::CMatrixFixed<double, 3, 6> J6;
+    mp2p_icp::error_point2line(pair, p, J6);
+    ASSERT_LT_((J6.asEigen() - jacob.asEigen()).array().abs().maxCoeff(), 1e-6);
+
     // Numerical Jacobian:
     CMatrixDouble numJacob;
     {
@@ -195,12 +205,8 @@ static void test_Jacob_error_point2plane()
 
     mp2p_icp::point_plane_pair_t pair;
 
-    pair.pl_global.centroid.x     = normalf(20);
-    pair.pl_global.centroid.y     = normalf(20);
-    pair.pl_global.centroid.z     = normalf(20);
-    pair.pl_global.plane.coefs[0] = normald(20);
-    pair.pl_global.plane.coefs[1] = normald(20);
-    pair.pl_global.plane.coefs[2] = normald(20);
+    pair.set_plane(mrpt::math::TPlane(
+        normald(20), normald(20), normald(20), normald(20)));
 
     pair.pt_local.x = normalf(10);
     pair.pt_local.y = normalf(10);
@@ -216,6 +222,19 @@ static void test_Jacob_error_point2plane()
 
     const mrpt::math::CMatrixFixed<double, 3, 6> jacob(J1 * dDexpe_de);
 
+    // Closed-form scalar residual: its Jacobian, times the unit normal, must
+    // match the 3-vector one:
+    mrpt::math::CMatrixFixed<double, 1, 6> J6;
+    const double err = mp2p_icp::error_point2plane(pair, p, J6);
+
+    const auto g = p.composePoint(mrpt::math::TPoint3D(
+        pair.pt_local.x, pair.pt_local.y, pair.pt_local.z));
+    ASSERT_NEAR_(err, pair.distance(g), 1e-6);
+
+    const Eigen::Vector3d n(pair.normal.x, pair.normal.y, pair.normal.z);
+    const Eigen::Matrix<double, 3, 6> J6n = -n * J6.asEigen();
+    ASSERT_LT_((J6n - jacob.asEigen()).array().abs().maxCoeff(), 1e-4);
+
     // Numerical Jacobian:
     CMatrixDouble numJacob;
     {
@@ -369,6 +388,11 @@ static void test_Jacob_error_plane2plane()
 
     const mrpt::math::CMatrixFixed<double, 3, 6> jacob(J1 * dDexpe_de);
 
+    // Closed-form tangent-space Jacobian:
+    mrpt::math::CMatrixFixed<double, 3, 6> J6;
+    mp2p_icp::error_plane2plane(pair, p, J6);
+    ASSERT_LT_((J6.asEigen() - jacob.asEigen()).array().abs().maxCoeff(), 1e-6);
+
     // Numerical Jacobian:
     CMatrixDouble numJacob;
     {
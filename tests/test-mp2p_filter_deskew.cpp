@@ -0,0 +1,149 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_filter_deskew.cpp
+ * @brief  Unit tests for FilterDeskew motion compensation methods
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp_filters/FilterDeskew.h>
+#include <mrpt/maps/CPointsMapXYZIRT.h>
+#include <mrpt/random/RandomGenerators.h>
+
+namespace
+{
+// A scan of random points around the sensor, with timestamps in [0,0.1] s:
+mp2p_icp::metric_map_t generateScan()
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(123);
+
+    auto pts = mrpt::maps::CPointsMapXYZIRT::Create();
+    for (int i = 0; i < 5000; i++)
+    {
+        pts->insertPointFast(
+            rng.drawUniform(-20.0, 20.0), rng.drawUniform(-20.0, 20.0),
+            rng.drawUniform(-2.0, 2.0));
+        pts->insertPointField_Intensity(1.0f);
+        pts->insertPointField_Ring(0);
+        pts->insertPointField_Timestamp(i * 0.1f / 5000);
+    }
+
+    mp2p_icp::metric_map_t m;
+    m.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = pts;
+    return m;
+}
+
+mrpt::maps::CPointsMap::Ptr runDeskew(
+    const std::string& method, bool interpolatePoses)
+{
+    const std::string motion = interpolatePoses ? R"###(
+interpolate_poses:
+  start_time: 0.0
+  end_time: 0.1
+  start_pose: [0, 0, 0, 0, 0, 0]
+  end_pose: [1.0, 0.1, 0, 0.05, 0, 0]
+)###"
+                                                : R"###(
+twist: [10.0, 1.0, 0, 0, 0, 0.5]
+)###";
+
+    const auto p = mrpt::containers::yaml::FromText(
+        "input_pointcloud_layer: 'raw'\n"
+        "output_pointcloud_layer: 'deskewed'\n"
+        "lookup_table_bins: 2048\n"
+        "method: '" +
+        method + "'\n" + motion);
+
+    mp2p_icp_filters::FilterDeskew f;
+    f.initialize(p);
+
+    auto m = generateScan();
+    f.filter(m);
+
+    return m.point_layer("deskewed");
+}
+
+void compareClouds(
+    const mrpt::maps::CPointsMap& a, const mrpt::maps::CPointsMap& b,
+    double maxError)
+{
+    ASSERT_EQUAL_(a.size(), b.size());
+
+    double maxErr = 0;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        mrpt::math::TPoint3Df pa, pb;
+        a.getPoint(i, pa.x, pa.y, pa.z);
+        b.getPoint(i, pb.x, pb.y, pb.z);
+        maxErr = std::max<double>(maxErr, (pa - pb).norm());
+    }
+    std::cout << "Max error: " << maxErr << "\n";
+    ASSERT_LT_(maxErr, maxError);
+}
+
+void test_deskew_methods_vs_exact(bool interpolatePoses)
+{
+    const auto exact =
+        runDeskew("MotionCompensationMethod::Exact", interpolatePoses);
+
+    // Rotation of 0.05 rad in the scan: 2nd order terms ~ 0.05^2/2 * 20 m
+    compareClouds(
+        *exact,
+        *runDeskew("MotionCompensationMethod::FirstOrder", interpolatePoses),
+        5e-2);
+
+    // Bin width 0.1/2048 s, max. velocity of a point ~ 10+0.5*20 m/s
+    compareClouds(
+        *exact,
+        *runDeskew("MotionCompensationMethod::LookupTable", interpolatePoses),
+        5e-3);
+}
+
+void test_deskew_twist_and_poses_is_error()
+{
+    const auto p = mrpt::containers::yaml::FromText(R"###(
+input_pointcloud_layer: 'raw'
+output_pointcloud_layer: 'deskewed'
+twist: [0, 0, 0, 0, 0, 0]
+interpolate_poses:
+  start_time: 0.0
+  end_time: 0.1
+  start_pose: [0, 0, 0, 0, 0, 0]
+  end_pose: [0, 0, 0, 0, 0, 0]
+)###");
+
+    mp2p_icp_filters::FilterDeskew f;
+
+    bool thrown = false;
+    try
+    {
+        f.initialize(p);
+    }
+    catch (const std::exception&)
+    {
+        thrown = true;
+    }
+    ASSERT_(thrown);
+}
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_deskew_methods_vs_exact(false);
+        test_deskew_methods_vs_exact(true);
+        test_deskew_twist_and_poses_is_error();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
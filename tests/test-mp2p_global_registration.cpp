@@ -0,0 +1,166 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_global_registration.cpp
+ * @brief  Unit tests for FPFH+RANSAC global registration
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/global_registration.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/poses/Lie/SO.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <iostream>
+
+namespace
+{
+// Samples the surface of an axis-aligned box, with ~density points/m^2:
+void sampleBox(
+    mrpt::maps::CSimplePointsMap& pts, float x0, float y0, float z0, float sx,
+    float sy, float sz, float density)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+
+    const auto lambdaFace = [&](int axis, float fixedValue, float su, float sv)
+    {
+        const auto n = static_cast<int>(su * sv * density);
+        for (int i = 0; i < n; i++)
+        {
+            const float u = rng.drawUniform(0.0f, su);
+            const float v = rng.drawUniform(0.0f, sv);
+            switch (axis)
+            {
+                case 0: pts.insertPoint(fixedValue, y0 + u, z0 + v); break;
+                case 1: pts.insertPoint(x0 + u, fixedValue, z0 + v); break;
+                case 2: pts.insertPoint(x0 + u, y0 + v, fixedValue); break;
+            }
+        }
+    };
+
+    lambdaFace(0, x0, sy, sz);
+    lambdaFace(0, x0 + sx, sy, sz);
+    lambdaFace(1, y0, sx, sz);
+    lambdaFace(1, y0 + sy, sx, sz);
+    lambdaFace(2, z0 + sz, sx, sy);
+}
+
+// A non-symmetric scene: a floor with boxes of different sizes:
+mrpt::maps::CSimplePointsMap::Ptr generateScene()
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(123);
+
+    auto pts = mrpt::maps::CSimplePointsMap::Create();
+
+    constexpr float density = 40.0f;
+    for (int i = 0; i < 30 * 30 * density; i++)
+    {
+        pts->insertPoint(
+            rng.drawUniform(-15.0f, 15.0f), rng.drawUniform(-15.0f, 15.0f),
+            0.0f);
+    }
+
+    sampleBox(*pts, -12, -10, 0, 3.0f, 2.0f, 1.0f, density);
+    sampleBox(*pts, -5, 6, 0, 1.0f, 4.0f, 2.5f, density);
+    sampleBox(*pts, 4, -8, 0, 5.0f, 1.0f, 1.5f, density);
+    sampleBox(*pts, 8, 5, 0, 2.0f, 2.0f, 3.0f, density);
+    sampleBox(*pts, -2, -3, 0, 1.5f, 0.8f, 0.8f, density);
+    sampleBox(*pts, 10, -12, 0, 1.0f, 1.0f, 4.0f, density);
+    sampleBox(*pts, -13, 9, 0, 4.0f, 3.0f, 2.0f, density);
+
+    return pts;
+}
+
+void test_recover_large_transform()
+{
+    const auto scene = generateScene();
+
+    // Far from identity: ICP alone would never converge from there.
+    const auto truePose = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+        25.0, -40.0, 3.0, mrpt::DEG2RAD(135.0), mrpt::DEG2RAD(5.0),
+        mrpt::DEG2RAD(-3.0));
+
+    // The same scene, as seen in the "local" frame:
+    auto localPts = mrpt::maps::CSimplePointsMap::Create();
+    localPts->changeCoordinatesReference(*scene, -truePose);
+
+    mp2p_icp::metric_map_t local, global;
+    local.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW]  = localPts;
+    global.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = scene;
+
+    mp2p_icp::GlobalRegistrationParameters p;
+    p.keypoint_voxel_size = 0.5;
+    p.normal_radius       = 0.6;
+    p.feature_radius      = 2.0;
+    p.inlier_threshold    = 0.5;
+
+    const auto r = mp2p_icp::global_registration(local, global, p);
+
+    std::cout << "Keypoints: " << r.localKeypoints << " / " << r.globalKeypoints
+              << " correspondences: " << r.correspondences
+              << " inliers: " << r.inliers << "\n"
+              << "Estimated pose: " << r.optimalPose << "\n"
+              << "True pose     : " << truePose << "\n";
+
+    ASSERT_(r.success);
+
+    const auto   err      = r.optimalPose - truePose;
+    const double errTrans = err.translation().norm();
+    const double errRot =
+        mrpt::poses::Lie::SO<3>::log(err.getRotationMatrix()).norm();
+
+    // Coarse result, only intended as initial guess for ICP:
+    ASSERT_LT_(errTrans, 0.5);
+    ASSERT_LT_(errRot, mrpt::DEG2RAD(3.0));
+
+    std::cout << "test_recover_large_transform: OK\n";
+}
+
+void test_match_features_mutual()
+{
+    const auto scene = generateScene();
+
+    mp2p_icp::GlobalRegistrationParameters p;
+    p.keypoint_voxel_size = 0.5;
+    p.normal_radius       = 0.6;
+    p.feature_radius      = 2.0;
+
+    // Identical clouds: every feature must be its own mutual nearest match.
+    const auto feats = mp2p_icp::compute_fpfh_features(*scene, p);
+    ASSERT_(feats.size() > 0);
+
+    const auto corrs = mp2p_icp::match_features(feats, feats, true);
+
+    std::size_t identity = 0;
+    for (const auto& [li, gi] : corrs)
+        if (feats.descriptors[li] == feats.descriptors[gi]) identity++;
+
+    ASSERT_EQUAL_(identity, corrs.size());
+    ASSERT_GT_(corrs.size(), feats.size() / 2);
+
+    std::cout << "test_match_features_mutual: OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_match_features_mutual();
+        test_recover_large_transform();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,209 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_icp_batch_runner.cpp
+ * @brief  Unit tests for ICP_BatchRunner
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/ICP_BatchRunner.h>
+#include <mp2p_icp/icp_pipeline_from_yaml.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/poses/Lie/SE.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <atomic>
+#include <iostream>
+
+namespace
+{
+const char* icpPipelineYaml = R"###(
+class_name: mp2p_icp::ICP
+params:
+  maxIterations: 50
+  minAbsStep_trans: 1e-5
+  minAbsStep_rot: 1e-5
+solvers:
+  - class: mp2p_icp::Solver_Horn
+    params: ~
+matchers:
+  - class: mp2p_icp::Matcher_Points_DistanceThreshold
+    params:
+      threshold: 0.75
+      pointLayerMatches:
+        - {global: "raw", local: "raw", weight: 1.0}
+quality:
+  - class: mp2p_icp::QualityEvaluator_PairedRatio
+    params:
+      threshold: 0.05
+)###";
+
+// Points on the floor and three walls of a 10x8x3 m room:
+mp2p_icp::metric_map_t generateRoom()
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(123);
+
+    auto pts = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = 0; i < 2000; i++)
+    {
+        const float u = rng.drawUniform(0.0f, 1.0f);
+        const float v = rng.drawUniform(0.0f, 1.0f);
+        switch (i % 4)
+        {
+            case 0: pts->insertPoint(10 * u, 8 * v, 0); break;
+            case 1: pts->insertPoint(10 * u, 0, 3 * v); break;
+            case 2: pts->insertPoint(0, 8 * u, 3 * v); break;
+            case 3: pts->insertPoint(10, 8 * u, 3 * v); break;
+        }
+    }
+
+    mp2p_icp::metric_map_t m;
+    m.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = pts;
+    return m;
+}
+
+// The room, as seen from a given pose:
+mp2p_icp::metric_map_t::Ptr observeFrom(
+    const mp2p_icp::metric_map_t& room, const mrpt::poses::CPose3D& pose)
+{
+    const auto roomPts =
+        room.point_layer(mp2p_icp::metric_map_t::PT_LAYER_RAW);
+
+    auto pts = mrpt::maps::CSimplePointsMap::Create();
+    pts->changeCoordinatesReference(*roomPts, -pose);
+
+    auto m = mp2p_icp::metric_map_t::Create();
+    m->layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = pts;
+    return m;
+}
+
+void test_batch_vs_serial()
+{
+    const auto config = mrpt::containers::yaml::FromText(icpPipelineYaml);
+
+    auto global = mp2p_icp::metric_map_t::Create();
+    *global     = generateRoom();
+
+    // Jobs with different true poses, and initial guesses off by a few cm:
+    std::vector<mp2p_icp::ICP_BatchRunner::Job> jobs;
+    std::vector<mrpt::poses::CPose3D>           truePoses;
+    for (int i = 0; i < 12; i++)
+    {
+        const auto truePose = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+            2.0 + 0.5 * i, 1.0 + 0.25 * i, 0.0, 0.05 * i, 0, 0);
+        const auto guess =
+            truePose + mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+                           0.10, -0.05, 0.02, 0.02, 0, 0);
+
+        truePoses.push_back(truePose);
+        jobs.emplace_back(
+            observeFrom(*global, truePose), global, guess.asTPose());
+    }
+
+    // Install a user hook in the pipelines, which must be kept by run():
+    std::atomic_size_t userHookCalls{0};
+
+    mp2p_icp::ICP_BatchRunner runner(config, 4);
+    ASSERT_EQUAL_(runner.pool_size(), 4U);
+    for (std::size_t i = 0; i < runner.pool_size(); i++)
+    {
+        runner.pipeline(i)->setIterationHook(
+            [&](const mp2p_icp::ICP::IterationHook_Input&)
+            {
+                userHookCalls++;
+                return mp2p_icp::ICP::IterationHook_Output();
+            });
+    }
+
+    const auto batchResults = runner.run(jobs);
+    ASSERT_EQUAL_(batchResults.size(), jobs.size());
+    ASSERT_(userHookCalls > 0);
+    for (std::size_t i = 0; i < runner.pool_size(); i++)
+        ASSERT_(runner.pipeline(i)->getIterationHook());
+
+    // Serial reference, with a single independent pipeline:
+    auto [icp, icpParams] = mp2p_icp::icp_pipeline_from_yaml(config);
+
+    for (std::size_t i = 0; i < jobs.size(); i++)
+    {
+        const auto& job = jobs[i];
+        const auto& br  = batchResults[i];
+        ASSERT_(br.executed);
+
+        mp2p_icp::Results serial;
+        icp->align(
+            *job.pcLocal, *job.pcGlobal, job.initialGuessLocalWrtGlobal,
+            icpParams, serial);
+
+        const auto batchPose  = br.result.optimal_tf.mean;
+        const auto serialPose = serial.optimal_tf.mean;
+
+        const double errVsSerial =
+            mrpt::poses::Lie::SE<3>::log(batchPose - serialPose).norm();
+
+        ASSERT_EQUAL_(br.result.nIterations, serial.nIterations);
+        ASSERT_NEAR_(br.result.quality, serial.quality, 1e-9);
+        ASSERT_LT_(errVsSerial, 1e-6);
+
+        // And both must have converged to the ground truth:
+        const double errVsTrue =
+            (batchPose - truePoses[i]).translation().norm();
+        ASSERT_LT_(errVsTrue, 1e-2);
+    }
+
+    std::cout << "test_batch_vs_serial: OK (" << jobs.size() << " jobs, "
+              << userHookCalls << " hook calls)\n";
+}
+
+void test_early_stop()
+{
+    const auto config = mrpt::containers::yaml::FromText(icpPipelineYaml);
+
+    auto global = mp2p_icp::metric_map_t::Create();
+    *global     = generateRoom();
+
+    std::vector<mp2p_icp::ICP_BatchRunner::Job> jobs;
+    for (int i = 0; i < 50; i++)
+    {
+        const auto truePose =
+            mrpt::poses::CPose3D::FromXYZYawPitchRoll(3.0, 2.0, 0, 0, 0, 0);
+        jobs.emplace_back(
+            observeFrom(*global, truePose), global, truePose.asTPose());
+    }
+
+    // Single worker: the first job reaches a perfect quality and all others
+    // must be skipped:
+    mp2p_icp::ICP_BatchRunner runner(config, 1);
+    const auto results = runner.run(jobs, 0.9);
+
+    ASSERT_(results.front().executed);
+    ASSERT_(results.front().result.quality >= 0.9);
+    for (std::size_t i = 1; i < results.size(); i++)
+        ASSERT_(!results[i].executed);
+
+    std::cout << "test_early_stop: OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_batch_vs_serial();
+        test_early_stop();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
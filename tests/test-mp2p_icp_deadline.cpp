@@ -0,0 +1,140 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_icp_deadline.cpp
+ * @brief  Unit tests for the ICP time budget (Parameters::maxTimeSeconds)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/ICP.h>
+#include <mp2p_icp/icp_pipeline_from_yaml.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <iostream>
+
+namespace
+{
+const char* icpPipelineYaml = R"###(
+class_name: mp2p_icp::ICP
+params:
+  maxIterations: 100
+  minAbsStep_trans: 1e-6
+  minAbsStep_rot: 1e-6
+solvers:
+  - class: mp2p_icp::Solver_Horn
+    params: ~
+matchers:
+  - class: mp2p_icp::Matcher_Points_DistanceThreshold
+    params:
+      threshold: 0.75
+      pointLayerMatches:
+        - {global: "raw", local: "raw", weight: 1.0}
+quality:
+  - class: mp2p_icp::QualityEvaluator_PairedRatio
+    params:
+      threshold: 0.05
+)###";
+
+// Points on the floor and three walls of a 10x8x3 m room:
+mp2p_icp::metric_map_t generateRoom()
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(123);
+
+    auto pts = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = 0; i < 20000; i++)
+    {
+        const float u = rng.drawUniform(0.0f, 1.0f);
+        const float v = rng.drawUniform(0.0f, 1.0f);
+        switch (i % 4)
+        {
+            case 0: pts->insertPoint(10 * u, 8 * v, 0); break;
+            case 1: pts->insertPoint(10 * u, 0, 3 * v); break;
+            case 2: pts->insertPoint(0, 8 * u, 3 * v); break;
+            case 3: pts->insertPoint(10, 8 * u, 3 * v); break;
+        }
+    }
+
+    mp2p_icp::metric_map_t m;
+    m.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = pts;
+    return m;
+}
+
+void test_deadline()
+{
+    const auto config = mrpt::containers::yaml::FromText(icpPipelineYaml);
+    auto [icp, icpParams] = mp2p_icp::icp_pipeline_from_yaml(config);
+
+    const auto global = generateRoom();
+
+    const auto truePose =
+        mrpt::poses::CPose3D::FromXYZYawPitchRoll(3.0, 2.0, 0, 0.1, 0, 0);
+    const auto guess = truePose + mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+                                      0.20, -0.10, 0.05, 0.03, 0, 0);
+
+    auto localPts = mrpt::maps::CSimplePointsMap::Create();
+    localPts->changeCoordinatesReference(
+        *global.point_layer(mp2p_icp::metric_map_t::PT_LAYER_RAW), -truePose);
+
+    mp2p_icp::metric_map_t local;
+    local.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = localPts;
+
+    // Reference: no time limit.
+    mp2p_icp::Results unlimited;
+    icp->align(local, global, guess.asTPose(), icpParams, unlimited);
+
+    ASSERT_(
+        unlimited.terminationReason != mp2p_icp::IterTermReason::Deadline);
+    ASSERT_GT_(unlimited.nIterations, 1U);
+
+    // A budget so small that there is only time for the first iteration,
+    // which is always run:
+    icpParams.maxTimeSeconds = 1e-9;
+
+    mp2p_icp::Results r;
+    icp->align(local, global, guess.asTPose(), icpParams, r);
+
+    ASSERT_(r.terminationReason == mp2p_icp::IterTermReason::Deadline);
+    ASSERT_EQUAL_(r.nIterations, 1U);
+
+    // The returned pairings are those the solution was computed from, that
+    // is, those at the initial guess:
+    const auto pairingsAtGuess = mp2p_icp::run_matchers(
+        icp->matchers(), global, local, guess, {});
+
+    ASSERT_GT_(r.finalPairings.size(), 0U);
+    ASSERT_EQUAL_(r.finalPairings.size(), pairingsAtGuess.size());
+    ASSERT_GT_(r.quality, 0.0);
+
+    // And the solution has already moved towards the true pose:
+    const double errGuess  = (guess - truePose).translation().norm();
+    const double errResult =
+        (r.optimal_tf.mean - truePose).translation().norm();
+    ASSERT_LT_(errResult, errGuess);
+
+    std::cout << "test_deadline: OK (" << unlimited.nIterations
+              << " iterations without time limit)\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_deadline();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,245 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_local_map_manager.cpp
+ * @brief  Unit tests for LocalMapManager
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp_filters/LocalMapManager.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <tuple>
+
+namespace
+{
+// Random points in a cube of the given size, centered at the robot:
+mrpt::maps::CSimplePointsMap randomScan(std::size_t n, float size)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+
+    mrpt::maps::CSimplePointsMap pts;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        pts.insertPoint(
+            rng.drawUniform(-0.5f * size, 0.5f * size),
+            rng.drawUniform(-0.5f * size, 0.5f * size),
+            rng.drawUniform(-0.5f * size, 0.5f * size));
+    }
+    return pts;
+}
+
+// Checks the invariants of the map: one layer with all points, and no voxel
+// with more than max_points_per_voxel points:
+void checkInvariants(const mp2p_icp_filters::LocalMapManager& lmm)
+{
+    const auto& m = lmm.localMap();
+    ASSERT_EQUAL_(m.layers.size(), 1U);
+
+    const auto pts = m.point_layer(lmm.params_.layer_name);
+    ASSERT_(pts);
+    ASSERT_EQUAL_(pts->size(), lmm.pointCount());
+
+    std::map<std::tuple<int, int, int>, std::size_t> perVoxel;
+    for (std::size_t i = 0; i < pts->size(); i++)
+    {
+        float x = 0, y = 0, z = 0;
+        pts->getPoint(i, x, y, z);
+        const double inv = 1.0 / lmm.params_.voxel_size;
+        perVoxel[{static_cast<int>(std::floor(x * inv)),
+                  static_cast<int>(std::floor(y * inv)),
+                  static_cast<int>(std::floor(z * inv))}]++;
+    }
+
+    ASSERT_EQUAL_(perVoxel.size(), lmm.voxelCount());
+    for (const auto& kv : perVoxel)
+        ASSERT_LE_(kv.second, lmm.params_.max_points_per_voxel);
+}
+
+void test_insert()
+{
+    mrpt::random::getRandomGenerator().randomize(123);
+
+    mp2p_icp_filters::LocalMapManager lmm;
+    lmm.initialize(mrpt::containers::yaml::FromText(R"###(
+layer_name: "local_map"
+voxel_size: 1.0
+max_points_per_voxel: 5
+max_distance: 0
+)###"));
+
+    ASSERT_EQUAL_(lmm.pointCount(), 0U);
+    ASSERT_EQUAL_(lmm.voxelCount(), 0U);
+
+    // All points within a single voxel: only the first 5 are kept.
+    const auto scan1 = randomScan(100, 0.5f);
+    const auto pose1 = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+        10.5, 10.5, 10.5, 0, 0, 0);
+
+    auto stats = lmm.insertScan(scan1, pose1);
+    ASSERT_EQUAL_(stats.insertedPoints, 5U);
+    ASSERT_EQUAL_(stats.evictedVoxels, 0U);
+    ASSERT_EQUAL_(lmm.pointCount(), 5U);
+    ASSERT_EQUAL_(lmm.voxelCount(), 1U);
+    checkInvariants(lmm);
+
+    // The same voxel again: it is full already.
+    stats = lmm.insertScan(scan1, pose1);
+    ASSERT_EQUAL_(stats.insertedPoints, 0U);
+    ASSERT_EQUAL_(lmm.pointCount(), 5U);
+
+    // A larger scan, over many voxels:
+    stats = lmm.insertScan(randomScan(5000, 8.0f), pose1);
+    ASSERT_GT_(stats.insertedPoints, 0U);
+    ASSERT_EQUAL_(lmm.pointCount(), 5U + stats.insertedPoints);
+    ASSERT_GT_(lmm.voxelCount(), 100U);
+    checkInvariants(lmm);
+
+    lmm.clear();
+    ASSERT_EQUAL_(lmm.pointCount(), 0U);
+    ASSERT_EQUAL_(lmm.voxelCount(), 0U);
+    checkInvariants(lmm);
+
+    std::cout << "test_insert: OK\n";
+}
+
+void test_max_voxels()
+{
+    mrpt::random::getRandomGenerator().randomize(456);
+
+    mp2p_icp_filters::LocalMapManager lmm;
+    lmm.initialize(mrpt::containers::yaml::FromText(R"###(
+voxel_size: 0.5
+max_points_per_voxel: 4
+max_distance: 0
+max_voxels: 300
+)###"));
+
+    // The robot moves along a straight line, so the map would grow
+    // without bounds:
+    for (int i = 0; i < 50; i++)
+    {
+        const auto pose =
+            mrpt::poses::CPose3D::FromXYZYawPitchRoll(i * 2.0, 0, 0, 0, 0, 0);
+        lmm.insertScan(randomScan(2000, 4.0f), pose);
+
+        ASSERT_LE_(lmm.voxelCount(), 300U);
+        ASSERT_LE_(lmm.pointCount(), 300U * 4U);
+        checkInvariants(lmm);
+    }
+
+    // The oldest voxels are evicted first: all remaining points are close to
+    // the last poses.
+    const auto pts = lmm.localMap().point_layer("local_map");
+    for (std::size_t i = 0; i < pts->size(); i++)
+    {
+        float x = 0, y = 0, z = 0;
+        pts->getPoint(i, x, y, z);
+        ASSERT_GT_(x, 49 * 2.0 - 10.0);
+    }
+
+    std::cout << "test_max_voxels: OK\n";
+}
+
+void test_max_age()
+{
+    mrpt::random::getRandomGenerator().randomize(789);
+
+    mp2p_icp_filters::LocalMapManager lmm;
+    lmm.initialize(mrpt::containers::yaml::FromText(R"###(
+voxel_size: 0.5
+max_points_per_voxel: 4
+max_distance: 0
+max_age_scans: 3
+)###"));
+
+    const auto pose0 = mrpt::poses::CPose3D::Identity();
+    const auto pose1 =
+        mrpt::poses::CPose3D::FromXYZYawPitchRoll(100, 0, 0, 0, 0, 0);
+
+    const auto stats0   = lmm.insertScan(randomScan(1000, 2.0f), pose0);
+    const auto nVoxels0 = lmm.voxelCount();
+
+    // Scans far away from the first one: its voxels are kept while they are
+    // not older than max_age_scans...
+    std::size_t evictedPoints = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        const auto s = lmm.insertScan(randomScan(100, 1.0f), pose1);
+        evictedPoints += s.evictedPoints;
+    }
+    ASSERT_EQUAL_(evictedPoints, 0U);
+
+    // ...and evicted afterwards:
+    const auto s = lmm.insertScan(randomScan(100, 1.0f), pose1);
+    ASSERT_EQUAL_(s.evictedVoxels, nVoxels0);
+    ASSERT_EQUAL_(s.evictedPoints, stats0.insertedPoints);
+    checkInvariants(lmm);
+
+    std::cout << "test_max_age: OK\n";
+}
+
+void test_max_distance()
+{
+    mrpt::random::getRandomGenerator().randomize(321);
+
+    mp2p_icp_filters::LocalMapManager lmm;
+    lmm.initialize(mrpt::containers::yaml::FromText(R"###(
+voxel_size: 0.5
+max_points_per_voxel: 4
+max_distance: 20.0
+chunk_size: 4
+)###"));
+
+    // Voxels may be kept up to one chunk diagonal beyond max_distance:
+    const double maxDist =
+        20.0 + std::sqrt(3.0) * lmm.params_.chunk_size * lmm.params_.voxel_size;
+
+    for (int i = 0; i < 40; i++)
+    {
+        const auto pose = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+            i * 3.0, i * 1.0, 0, 0, 0, 0);
+        lmm.insertScan(randomScan(2000, 10.0f), pose);
+        checkInvariants(lmm);
+
+        const auto pts = lmm.localMap().point_layer("local_map");
+        for (std::size_t j = 0; j < pts->size(); j++)
+        {
+            float x = 0, y = 0, z = 0;
+            pts->getPoint(j, x, y, z);
+            ASSERT_LT_(
+                pose.translation().distanceTo(mrpt::math::TPoint3D(x, y, z)),
+                maxDist);
+        }
+    }
+
+    std::cout << "test_max_distance: OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_insert();
+        test_max_voxels();
+        test_max_age();
+        test_max_distance();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
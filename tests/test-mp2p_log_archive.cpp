@@ -0,0 +1,151 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_log_archive.cpp
+ * @brief  Unit tests for LogArchiveWriter and LogArchiveReader
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/LogArchive.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/system/filesystem.h>
+
+static mp2p_icp::metric_map_t::Ptr generateMap(int nPoints, float z)
+{
+    auto pts = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = 0; i < nPoints; i++) pts->insertPoint(i * 0.1f, 1.0f, z);
+
+    auto m = mp2p_icp::metric_map_t::Create();
+    m->layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = pts;
+    return m;
+}
+
+static mp2p_icp::LogRecord generateRecord(
+    const mp2p_icp::metric_map_t::Ptr& global,
+    const mp2p_icp::metric_map_t::Ptr& local, mp2p_icp::IterTermReason reason,
+    double quality)
+{
+    mp2p_icp::LogRecord lr;
+    lr.pcGlobal                     = global;
+    lr.pcLocal                      = local;
+    lr.icpResult.terminationReason  = reason;
+    lr.icpResult.quality            = quality;
+    lr.icpResult.nIterations        = 7;
+    lr.dynamicVariables["test_var"] = quality;
+    return lr;
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        using mp2p_icp::IterTermReason;
+
+        const auto archiveFile =
+            mrpt::system::getTempFileName() + ".icparchive";
+
+        // The same global map for all records:
+        const auto global = generateMap(1000, 0.0f);
+
+        {
+            mp2p_icp::LogArchiveWriter w;
+            w.open(archiveFile);
+
+            w.append(generateRecord(
+                global, generateMap(10, 1.0f), IterTermReason::Stalled, 0.9));
+            w.append(generateRecord(
+                global, generateMap(20, 2.0f), IterTermReason::MaxIterations,
+                0.5));
+            w.append(generateRecord(
+                global, generateMap(30, 3.0f), IterTermReason::Stalled, 0.8));
+
+            ASSERT_EQUAL_(w.record_count(), 3U);
+            ASSERT_EQUAL_(w.map_count(), 4U);  // 1 global + 3 local
+        }
+
+        {
+            mp2p_icp::LogArchiveReader r;
+            r.open(archiveFile);
+
+            ASSERT_EQUAL_(r.size(), 3U);
+            ASSERT_EQUAL_(r.map_count(), 4U);
+
+            // Filter without loading anything:
+            const auto stalled = r.filter(
+                [](const auto& info)
+                { return info.terminationReason == IterTermReason::Stalled; });
+            ASSERT_EQUAL_(stalled.size(), 2U);
+            ASSERT_EQUAL_(stalled.at(0), 0U);
+            ASSERT_EQUAL_(stalled.at(1), 2U);
+
+            ASSERT_EQUAL_(r.records().at(1).nIterations, 7U);
+            ASSERT_NEAR_(r.records().at(1).quality, 0.5, 1e-9);
+            ASSERT_EQUAL_(
+                r.records().at(0).globalMapHash,
+                r.records().at(2).globalMapHash);
+
+            // Random access:
+            const auto lr = r.load(2);
+            ASSERT_(lr.pcGlobal && lr.pcLocal);
+            ASSERT_EQUAL_(lr.pcGlobal->size_points_only(), 1000U);
+            ASSERT_EQUAL_(lr.pcLocal->size_points_only(), 30U);
+            ASSERT_NEAR_(lr.icpResult.quality, 0.8, 1e-9);
+            ASSERT_NEAR_(lr.dynamicVariables.at("test_var"), 0.8, 1e-9);
+
+            // The shared global map is decompressed only once:
+            const auto lr0 = r.load(0);
+            ASSERT_(lr0.pcGlobal == lr.pcGlobal);
+
+            const auto lrNoMaps = r.load(1, false /*maps*/);
+            ASSERT_(!lrNoMaps.pcGlobal && !lrNoMaps.pcLocal);
+        }
+
+        // Simulate a crash while writing, then append:
+        {
+            mrpt::io::CFileOutputStream f(
+                archiveFile, mrpt::io::OpenMode::APPEND);
+            const uint8_t garbage[5] = {'R', 0xff, 0xff, 0xff, 0xff};
+            f.Write(garbage, sizeof(garbage));
+        }
+        {
+            mp2p_icp::LogArchiveReader r;
+            r.open(archiveFile);
+            ASSERT_EQUAL_(r.size(), 3U);
+        }
+        {
+            mp2p_icp::LogArchiveWriter w;
+            w.open(archiveFile);
+            ASSERT_EQUAL_(w.record_count(), 3U);
+
+            w.append(generateRecord(
+                global, generateMap(10, 1.0f), IterTermReason::NoPairings,
+                0.1));
+
+            // Both maps were already in the archive:
+            ASSERT_EQUAL_(w.map_count(), 4U);
+        }
+        {
+            mp2p_icp::LogArchiveReader r;
+            r.open(archiveFile);
+            ASSERT_EQUAL_(r.size(), 4U);
+            ASSERT_EQUAL_(r.map_count(), 4U);
+            ASSERT_(
+                r.records().at(3).terminationReason ==
+                IterTermReason::NoPairings);
+            ASSERT_EQUAL_(r.load(3).pcLocal->size_points_only(), 10U);
+        }
+
+        mrpt::system::deleteFile(archiveFile);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,224 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_matcher_parallel.cpp
+ * @brief  Checks that the parallel point matchers give the same pairings as
+ *         their single-threaded execution
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/Matcher_Point2Line.h>
+#include <mp2p_icp/Matcher_Point2Plane.h>
+#include <mp2p_icp/VoxelSurfelMap.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <iostream>
+#include <map>
+#include <tuple>
+
+#if defined(MP2P_HAS_TBB)
+#include <tbb/global_control.h>
+#endif
+
+namespace
+{
+// Points on the floor and three walls of a 10x8x3 m room, plus two vertical
+// edges at its corners, so there are both planes and lines:
+mrpt::maps::CSimplePointsMap::Ptr generateRoom(std::size_t n)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+
+    auto pts = mrpt::maps::CSimplePointsMap::Create();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const float u = rng.drawUniform(0.0f, 1.0f);
+        const float v = rng.drawUniform(0.0f, 1.0f);
+        switch (i % 6)
+        {
+            case 0: pts->insertPoint(10 * u, 8 * v, 0); break;
+            case 1: pts->insertPoint(10 * u, 0, 3 * v); break;
+            case 2: pts->insertPoint(0, 8 * u, 3 * v); break;
+            case 3: pts->insertPoint(10, 8 * u, 3 * v); break;
+            case 4: pts->insertPoint(0, 0, 3 * v); break;
+            case 5: pts->insertPoint(10, 0, 3 * v); break;
+        }
+    }
+    return pts;
+}
+
+// Noisy local points:
+mrpt::maps::CSimplePointsMap::Ptr generateLocal(std::size_t n)
+{
+    auto  room = generateRoom(n);
+    auto& rng  = mrpt::random::getRandomGenerator();
+
+    auto pts = mrpt::maps::CSimplePointsMap::Create();
+    for (std::size_t i = 0; i < room->size(); i++)
+    {
+        float x = 0, y = 0, z = 0;
+        room->getPoint(i, x, y, z);
+        pts->insertPoint(
+            x + rng.drawGaussian1D(0, 0.01), y + rng.drawGaussian1D(0, 0.01),
+            z + rng.drawGaussian1D(0, 0.01));
+    }
+    return pts;
+}
+
+using point_key_t = std::tuple<double, double, double>;
+
+// Local point coordinates to local point index:
+std::map<point_key_t, std::size_t> indexLocalPoints(
+    const mp2p_icp::metric_map_t& local)
+{
+    const auto pts = local.point_layer(mp2p_icp::metric_map_t::PT_LAYER_RAW);
+
+    std::map<point_key_t, std::size_t> idxs;
+    for (std::size_t i = 0; i < pts->size(); i++)
+    {
+        float x = 0, y = 0, z = 0;
+        pts->getPoint(i, x, y, z);
+        idxs[{x, y, z}] = i;
+    }
+    return idxs;
+}
+
+// Runs the matcher with at most `maxThreads` TBB threads (ignored if built
+// without TBB, in which case both runs are single-threaded):
+mp2p_icp::Pairings runMatcher(
+    const mp2p_icp::Matcher& m, const mp2p_icp::metric_map_t& global,
+    const mp2p_icp::metric_map_t& local, const mrpt::poses::CPose3D& pose,
+    [[maybe_unused]] std::size_t maxThreads)
+{
+#if defined(MP2P_HAS_TBB)
+    tbb::global_control gc(
+        tbb::global_control::max_allowed_parallelism, maxThreads);
+#endif
+
+    mp2p_icp::Pairings   pairs;
+    mp2p_icp::MatchState ms(global, local);
+    m.match(global, local, pose, {}, ms, pairs);
+    return pairs;
+}
+
+template <typename PAIRS_T, typename EQUAL_T>
+void checkSamePairings(
+    const mp2p_icp::metric_map_t& local, const PAIRS_T& serial,
+    const PAIRS_T& parallel, EQUAL_T lambdaEqual)
+{
+    const auto localIdxs = indexLocalPoints(local);
+
+    ASSERT_EQUAL_(serial.size(), parallel.size());
+    std::size_t lastIdx = 0;
+    for (std::size_t i = 0; i < serial.size(); i++)
+    {
+        ASSERT_(lambdaEqual(serial[i], parallel[i]));
+
+        // Output must follow the local point order:
+        const auto& p   = serial[i].pt_local;
+        const auto  idx = localIdxs.at({p.x, p.y, p.z});
+        if (i > 0) ASSERT_GT_(idx, lastIdx);
+        lastIdx = idx;
+    }
+}
+
+const mrpt::poses::CPose3D testPose =
+    mrpt::poses::CPose3D::FromXYZYawPitchRoll(0.02, -0.01, 0.01, 0.005, 0, 0);
+
+void test_point2plane()
+{
+    mrpt::random::getRandomGenerator().randomize(123);
+
+    mp2p_icp::metric_map_t global, local;
+
+    const auto roomPts = generateRoom(60000);
+    auto       surfels = mp2p_icp::VoxelSurfelMap::Create(0.5f);
+    surfels->insertPointCloud(*roomPts, mrpt::poses::CPose3D::Identity());
+    global.layers["surfels"] = surfels;
+
+    local.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = generateLocal(20000);
+
+    mp2p_icp::Matcher_Point2Plane m;
+    m.initialize(mrpt::containers::yaml::FromText(R"###(
+distanceThreshold: 0.1
+pointLayerMatches:
+  - {global: "surfels", local: "raw"}
+)###"));
+
+    const auto serial   = runMatcher(m, global, local, testPose, 1);
+    const auto parallel = runMatcher(m, global, local, testPose, 8);
+
+    ASSERT_GT_(serial.paired_pt2pl.size(), 1000U);
+
+    checkSamePairings(
+        local, serial.paired_pt2pl, parallel.paired_pt2pl,
+        [](const mp2p_icp::point_plane_pair_t& a,
+           const mp2p_icp::point_plane_pair_t& b)
+        {
+            return a.pt_local == b.pt_local && a.normal == b.normal &&
+                   a.offset == b.offset;
+        });
+
+    std::cout << "test_point2plane: OK (" << serial.paired_pt2pl.size()
+              << " pairings)\n";
+}
+
+void test_point2line()
+{
+    mrpt::random::getRandomGenerator().randomize(456);
+
+    mp2p_icp::metric_map_t global, local;
+    global.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = generateRoom(60000);
+    local.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW]  = generateLocal(20000);
+
+    mp2p_icp::Matcher_Point2Line m;
+    m.initialize(mrpt::containers::yaml::FromText(R"###(
+distanceThreshold: 0.25
+knn: 6
+minimumLinePoints: 4
+lineEigenThreshold: 0.01
+pointLayerMatches:
+  - {global: "raw", local: "raw"}
+)###"));
+
+    const auto serial   = runMatcher(m, global, local, testPose, 1);
+    const auto parallel = runMatcher(m, global, local, testPose, 8);
+
+    ASSERT_GT_(serial.paired_pt2ln.size(), 100U);
+
+    checkSamePairings(
+        local, serial.paired_pt2ln, parallel.paired_pt2ln,
+        [](const mp2p_icp::point_line_pair_t& a,
+           const mp2p_icp::point_line_pair_t& b)
+        {
+            return a.pt_local == b.pt_local &&
+                   a.ln_global.pBase == b.ln_global.pBase &&
+                   a.ln_global.director == b.ln_global.director;
+        });
+
+    std::cout << "test_point2line: OK (" << serial.paired_pt2ln.size()
+              << " pairings)\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_point2plane();
+        test_point2line();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,158 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_matcher_planes.cpp
+ * @brief  Unit tests for Matcher_Planes_Normals
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/Matcher_Planes_Normals.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/core/exceptions.h>
+
+#include <iostream>
+
+namespace
+{
+mp2p_icp::plane_patch_t makePlane(
+    const mrpt::math::TPoint3D& c, const mrpt::math::TVector3D& n)
+{
+    return {mrpt::math::TPlane(c, n), c};
+}
+
+// A few planes, far enough from each other:
+mp2p_icp::metric_map_t generatePlanes()
+{
+    mp2p_icp::metric_map_t m;
+    m.planes.push_back(makePlane({0, 0, 0}, {0, 0, 1}));
+    m.planes.push_back(makePlane({10, 0, 1}, {1, 0, 0}));
+    m.planes.push_back(makePlane({0, 10, 1}, {0, 1, 0}));
+    m.planes.push_back(makePlane({-10, -10, 2}, {0.7071, 0.7071, 0}));
+    return m;
+}
+
+void initMatcher(mp2p_icp::Matcher_Planes_Normals& m, bool allowAlreadyMatched)
+{
+    mrpt::containers::yaml p;
+    p["distanceThreshold"]              = 1.0;
+    p["allowMatchAlreadyMatchedPlanes"] = allowAlreadyMatched;
+    m.initialize(p);
+}
+
+void test_all_paired()
+{
+    const auto global = generatePlanes();
+    const auto local  = generatePlanes();
+
+    mp2p_icp::Matcher_Planes_Normals m;
+    initMatcher(m, false);
+
+    mp2p_icp::Pairings   pairs;
+    mp2p_icp::MatchState ms(global, local);
+    m.match(global, local, {0, 0, 0, 0, 0, 0}, {}, ms, pairs);
+
+    ASSERT_EQUAL_(pairs.paired_pl2pl.size(), global.planes.size());
+    for (std::size_t i = 0; i < global.planes.size(); i++)
+    {
+        const auto& pp = pairs.paired_pl2pl.at(i);
+        ASSERT_NEAR_(
+            (pp.p_global.centroid - pp.p_local.centroid).norm(), 0, 1e-9);
+        ASSERT_(ms.localPairedBitField.planes.at(i));
+        ASSERT_(ms.globalPairedBitField.planes.at(i));
+    }
+
+    std::cout << "test_all_paired: OK\n";
+}
+
+// The index must be rebuilt if the global map is modified in place, even if
+// its address and number of planes do not change:
+void test_modified_global_map()
+{
+    auto       global = generatePlanes();
+    const auto local0 = generatePlanes();
+
+    mp2p_icp::Matcher_Planes_Normals m;
+    initMatcher(m, false);
+
+    {
+        mp2p_icp::Pairings   pairs;
+        mp2p_icp::MatchState ms(global, local0);
+        m.match(global, local0, {0, 0, 0, 0, 0, 0}, {}, ms, pairs);
+        ASSERT_EQUAL_(pairs.paired_pl2pl.size(), 4U);
+    }
+
+    // Move the first plane far away:
+    const mrpt::math::TPoint3D newCenter = {50, 50, 0};
+    global.planes[0] = makePlane(newCenter, {0, 0, 1});
+
+    mp2p_icp::metric_map_t local1;
+    local1.planes.push_back(makePlane(newCenter, {0, 0, 1}));
+
+    mp2p_icp::Pairings   pairs;
+    mp2p_icp::MatchState ms(global, local1);
+    m.match(global, local1, {0, 0, 0, 0, 0, 0}, {}, ms, pairs);
+    ASSERT_EQUAL_(pairs.paired_pl2pl.size(), 1U);
+    ASSERT_NEAR_(
+        (pairs.paired_pl2pl.at(0).p_global.centroid - newCenter).norm(), 0,
+        1e-9);
+
+    std::cout << "test_modified_global_map: OK\n";
+}
+
+// Each global plane is only paired once, unless explicitly allowed:
+void test_global_paired_bitfield()
+{
+    const auto global = generatePlanes();
+
+    // Two local planes, both close to the first global plane:
+    mp2p_icp::metric_map_t local;
+    local.planes.push_back(makePlane({0.1, 0, 0}, {0, 0, 1}));
+    local.planes.push_back(makePlane({-0.1, 0, 0}, {0, 0, 1}));
+
+    for (const bool allow : {false, true})
+    {
+        mp2p_icp::Matcher_Planes_Normals m;
+        initMatcher(m, allow);
+
+        mp2p_icp::Pairings   pairs;
+        mp2p_icp::MatchState ms(global, local);
+        m.match(global, local, {0, 0, 0, 0, 0, 0}, {}, ms, pairs);
+        ASSERT_EQUAL_(pairs.paired_pl2pl.size(), allow ? 2U : 1U);
+    }
+
+    // Already paired by a former matcher in the pipeline:
+    {
+        mp2p_icp::Matcher_Planes_Normals m;
+        initMatcher(m, false);
+
+        mp2p_icp::Pairings   pairs;
+        mp2p_icp::MatchState ms(global, local);
+        ms.globalPairedBitField.planes.at(0) = true;
+        m.match(global, local, {0, 0, 0, 0, 0, 0}, {}, ms, pairs);
+        ASSERT_(pairs.paired_pl2pl.empty());
+    }
+
+    std::cout << "test_global_paired_bitfield: OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_all_paired();
+        test_modified_global_map();
+        test_global_paired_bitfield();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
@@ -13,6 +13,7 @@
 
 #include <mp2p_icp/Matcher_Point2Plane.h>
 #include <mp2p_icp/Matcher_Points_DistanceThreshold.h>
+#include <mp2p_icp/VoxelSurfelMap.h>
 #include <mp2p_icp/metricmap.h>
 #include <mrpt/maps/CSimplePointsMap.h>
 
@@ -54,8 +55,16 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
     try
     {
         mp2p_icp::metric_map_t pcGlobal;
-        pcGlobal.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] =
-            generateGlobalPoints();
+        const auto             globalPts = generateGlobalPoints();
+        pcGlobal.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = globalPts;
+
+        // Surfels, for the pt-to-plane matcher:
+        auto surfels = mp2p_icp::VoxelSurfelMap::Create(0.2f);
+        surfels->insertPointCloud(*globalPts, mrpt::poses::CPose3D::Identity());
+        pcGlobal.layers["surfels"] = surfels;
+
+        // Two planar voxels, one non-planar:
+        ASSERT_EQUAL_(surfels->voxels().size(), 3U);
 
         mp2p_icp::metric_map_t pcLocal;
         pcLocal.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] =
@@ -64,12 +73,11 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
         {
             auto m = mp2p_icp::Matcher_Point2Plane::Create();
 
-            mrpt::containers::yaml p;
-            p["distanceThreshold"]   = 0.1;
-            p["searchRadius"]        = 0.1;
-            p["minimumPlanePoints"]  = 5.0;
-            p["knn"]                 = 5;
-            p["planeEigenThreshold"] = 0.1;
+            const auto p = mrpt::containers::yaml::FromText(R"###(
+distanceThreshold: 0.1
+pointLayerMatches:
+  - {global: "surfels", local: "raw"}
+)###");
 
             m->initialize(p);
 
@@ -105,15 +113,11 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
                 ASSERT_NEAR_(p0.pt_local.y, 0.0, 1e-3);
                 ASSERT_NEAR_(p0.pt_local.z, 0.0, 1e-3);
 
-                ASSERT_NEAR_(p0.pl_global.centroid.x, 10.0, 0.01);
-                ASSERT_NEAR_(p0.pl_global.centroid.y, 0.0, 0.01);
-                ASSERT_NEAR_(p0.pl_global.centroid.z, 0.0, 0.01);
-
-                // Plane equation: "x=10"  (Ax+By+Cz+D=0)
-                ASSERT_NEAR_(p0.pl_global.plane.coefs[0], 1.0, 1e-3);
-                ASSERT_NEAR_(p0.pl_global.plane.coefs[1], 0.0, 1e-3);
-                ASSERT_NEAR_(p0.pl_global.plane.coefs[2], 0.0, 1e-3);
-                ASSERT_NEAR_(p0.pl_global.plane.coefs[3], -10.0, 1e-3);
+                // Plane equation: "x=10"  (n·p + d=0)
+                ASSERT_NEAR_(p0.normal.x, 1.0, 1e-3);
+                ASSERT_NEAR_(p0.normal.y, 0.0, 1e-3);
+                ASSERT_NEAR_(p0.normal.z, 0.0, 1e-3);
+                ASSERT_NEAR_(p0.offset, -10.0, 1e-3);
             }
 
             {
@@ -14,6 +14,10 @@
 #include <mp2p_icp/Matcher_Points_DistanceThreshold.h>
 #include <mp2p_icp/metricmap.h>
 #include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <algorithm>
 
 static mrpt::maps::CSimplePointsMap::Ptr generateGlobalPoints()
 {
@@ -35,6 +39,79 @@ static mrpt::maps::CSimplePointsMap::Ptr generateLocalPoints()
     return pts;
 }
 
+// Correspondence reuse must never change the output pairings:
+static void test_correspondence_reuse(uint32_t pairingsPerPoint)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(123);
+
+    auto globalPts = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = 0; i < 5000; i++)
+    {
+        globalPts->insertPoint(
+            rng.drawUniform(-5.0f, 5.0f), rng.drawUniform(-5.0f, 5.0f),
+            rng.drawUniform(-1.0f, 1.0f));
+    }
+    auto localPts = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = 0; i < 1000; i++)
+    {
+        localPts->insertPoint(
+            rng.drawUniform(-4.0f, 4.0f), rng.drawUniform(-4.0f, 4.0f),
+            rng.drawUniform(-1.0f, 1.0f));
+    }
+
+    mp2p_icp::metric_map_t pcGlobal, pcLocal;
+    pcGlobal.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = globalPts;
+    pcLocal.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW]  = localPts;
+
+    const auto lambdaInit = [&](mp2p_icp::Matcher_Points_DistanceThreshold& m,
+                                double reuseFraction)
+    {
+        mrpt::containers::yaml p;
+        p["threshold"]                   = 0.30;
+        p["thresholdAngularDeg"]         = 0.0;
+        p["pairingsPerPoint"]            = pairingsPerPoint;
+        p["correspondenceReuseFraction"] = reuseFraction;
+        m.initialize(p);
+    };
+
+    mp2p_icp::Matcher_Points_DistanceThreshold mNoReuse, mReuse;
+    lambdaInit(mNoReuse, 0.0);
+    lambdaInit(mReuse, 0.5);
+
+    const auto lambdaSortedPairs = [](const mp2p_icp::Pairings& pairs)
+    {
+        std::vector<std::pair<uint64_t, uint64_t>> r;
+        for (const auto& p : pairs.paired_pt2pt)
+            r.emplace_back(p.localIdx, p.globalIdx);
+        std::sort(r.begin(), r.end());
+        return r;
+    };
+
+    // Several small pose steps, as in the last iterations of ICP:
+    mrpt::poses::CPose3D pose =
+        mrpt::poses::CPose3D::FromXYZYawPitchRoll(0.2, -0.1, 0.05, 0.1, 0, 0);
+    const auto step = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+        0.01, 0.005, -0.002, mrpt::DEG2RAD(0.2), 0, 0);
+
+    for (uint32_t iter = 0; iter < 10; iter++)
+    {
+        mp2p_icp::MatchContext mc;
+        mc.icpIteration = iter;
+
+        mp2p_icp::Pairings   pairs0, pairs1;
+        mp2p_icp::MatchState ms0(pcGlobal, pcLocal), ms1(pcGlobal, pcLocal);
+        mNoReuse.match(pcGlobal, pcLocal, pose, mc, ms0, pairs0);
+        mReuse.match(pcGlobal, pcLocal, pose, mc, ms1, pairs1);
+
+        ASSERT_(!pairs0.empty());
+        ASSERT_EQUAL_(pairs0.potential_pairings, pairs1.potential_pairings);
+        ASSERT_(lambdaSortedPairs(pairs0) == lambdaSortedPairs(pairs1));
+
+        pose = pose + step;
+    }
+}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 {
     try
@@ -101,6 +178,9 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
                 ASSERT_EQUAL_(pairs.paired_pt2pt.at(0).globalIdx, 19);
             }
         }
+
+        test_correspondence_reuse(1);
+        test_correspondence_reuse(3);
     }
     catch (std::exception& e)
     {
@@ -41,6 +41,27 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 
             ASSERT_NEAR_(m.threshold, 1.0, 1e-4);
             ASSERT_NEAR_(m.thresholdAngularDeg, .0, 1e-4);
+
+            // v3: via a pre-resolved variable slot:
+            const auto slot = globalParams.variableSlot("MATCH_THRESHOLD");
+            ASSERT_(slot.valid());
+
+            globalParams.updateVariables({{slot, 2.0}});
+            globalParams.realize();
+
+            ASSERT_NEAR_(m.threshold, 4.0, 1e-4);
+
+            // Unrelated variables must not re-evaluate the expression:
+            m.threshold = 0.1;
+            globalParams.updateVariable("OTHER_VARIABLE", 1.0);
+            globalParams.realize();
+
+            ASSERT_NEAR_(m.threshold, 0.1, 1e-4);
+
+            globalParams.updateVariable(slot, 0.25);
+            globalParams.realize();
+
+            ASSERT_NEAR_(m.threshold, 0.5, 1e-4);
         }
     }
     catch (std::exception& e)
@@ -0,0 +1,187 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_nn_index_cache.cpp
+ * @brief  Unit tests for NearestNeighborsIndexCache
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/NearestNeighborsIndexCache.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <iostream>
+#include <thread>
+
+namespace
+{
+mrpt::maps::CSimplePointsMap::Ptr randomCloud(std::size_t n)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(123);
+
+    auto pts = mrpt::maps::CSimplePointsMap::Create();
+    for (std::size_t i = 0; i < n; i++)
+    {
+        pts->insertPoint(
+            rng.drawUniform(-10.0f, 10.0f), rng.drawUniform(-10.0f, 10.0f),
+            rng.drawUniform(-2.0f, 2.0f));
+    }
+    return pts;
+}
+
+// Both maps must return the same NN indices for a set of random queries:
+void checkSameNN(
+    const mrpt::maps::CMetricMap& a, const mrpt::maps::CMetricMap& b)
+{
+    const auto* nnA = mp2p_icp::MapToNN(a, true);
+    const auto* nnB = mp2p_icp::MapToNN(b, true);
+
+    auto& rng = mrpt::random::getRandomGenerator();
+    for (int i = 0; i < 100; i++)
+    {
+        const mrpt::math::TPoint3Df query(
+            rng.drawUniform(-10.0f, 10.0f), rng.drawUniform(-10.0f, 10.0f),
+            rng.drawUniform(-2.0f, 2.0f));
+
+        mrpt::math::TPoint3Df ptA, ptB;
+        float                 distA = 0, distB = 0;
+        uint64_t              idxA = 0, idxB = 0;
+
+        ASSERT_(nnA->nn_single_search(query, ptA, distA, idxA));
+        ASSERT_(nnB->nn_single_search(query, ptB, distB, idxB));
+        ASSERT_EQUAL_(idxA, idxB);
+    }
+}
+
+void test_build_once()
+{
+    mp2p_icp::NearestNeighborsIndexCache cache;
+
+    auto pts = randomCloud(2000);
+
+    const std::size_t defaultLeaf = pts->kdtree_search_params.leaf_max_size;
+    const std::size_t customLeaf  = defaultLeaf + 5;
+
+    // Default parameters: the layer itself is used.
+    const auto& m1 = cache.get(pts);
+    ASSERT_EQUAL_(&m1, pts.get());
+    ASSERT_EQUAL_(&cache.get(pts, defaultLeaf), pts.get());
+    ASSERT_EQUAL_(cache.size(), 1U);
+
+    // Custom leaf size: a copy, built once and reused afterwards:
+    const auto& m2 = cache.get(pts, customLeaf);
+    ASSERT_(&m2 != pts.get());
+    ASSERT_EQUAL_(&cache.get(pts, customLeaf), &m2);
+    ASSERT_EQUAL_(cache.size(), 2U);
+
+    const auto* pts2 = mp2p_icp::MapToPointsMap(m2);
+    ASSERT_(pts2);
+    ASSERT_EQUAL_(pts2->size(), pts->size());
+    ASSERT_EQUAL_(pts2->kdtree_search_params.leaf_max_size, customLeaf);
+
+    // The source layer is never modified:
+    ASSERT_EQUAL_(pts->kdtree_search_params.leaf_max_size, defaultLeaf);
+
+    checkSameNN(*pts, m2);
+
+    std::cout << "test_build_once: OK\n";
+}
+
+void test_invalidation()
+{
+    mp2p_icp::NearestNeighborsIndexCache cache;
+
+    auto pts = randomCloud(1000);
+
+    const std::size_t customLeaf = pts->kdtree_search_params.leaf_max_size + 5;
+
+    // A change in the number of points is detected automatically:
+    const auto* before = mp2p_icp::MapToPointsMap(cache.get(pts, customLeaf));
+    ASSERT_EQUAL_(before->size(), 1000U);
+
+    pts->insertPoint(0, 0, 0);
+    const auto* after = mp2p_icp::MapToPointsMap(cache.get(pts, customLeaf));
+    ASSERT_EQUAL_(after->size(), 1001U);
+    checkSameNN(*pts, *after);
+
+    // In-place modifications require an explicit invalidation:
+    const uint64_t gen0 = cache.generation();
+    pts->setPoint(0, 100.0f, 100.0f, 100.0f);
+    cache.invalidate(*pts);
+    ASSERT_EQUAL_(cache.size(), 0U);
+    ASSERT_(cache.generation() > gen0);
+
+    const auto& rebuilt = cache.get(pts, customLeaf);
+    float       x = 0, y = 0, z = 0;
+    mp2p_icp::MapToPointsMap(rebuilt)->getPoint(0, x, y, z);
+    ASSERT_EQUAL_(x, 100.0f);
+    checkSameNN(*pts, rebuilt);
+
+    // A different layer, even at a reused address, is a different entry:
+    pts.reset();
+    auto other = randomCloud(500);
+    ASSERT_EQUAL_(
+        mp2p_icp::MapToPointsMap(cache.get(other, customLeaf))->size(), 500U);
+
+    // Through metric_map_t:
+    mp2p_icp::metric_map_t m;
+    m.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = other;
+
+    const uint64_t mapGen0 = m.nn_indices_generation();
+    m.layer_for_nn_queries(mp2p_icp::metric_map_t::PT_LAYER_RAW, customLeaf);
+    m.invalidate_nn_indices();
+    ASSERT_(m.nn_indices_generation() > mapGen0);
+
+    std::cout << "test_invalidation: OK\n";
+}
+
+void test_concurrent_get()
+{
+    mp2p_icp::NearestNeighborsIndexCache cache;
+
+    auto pts = randomCloud(20000);
+
+    const std::size_t customLeaf = pts->kdtree_search_params.leaf_max_size + 5;
+
+    constexpr std::size_t N = 8;
+
+    std::vector<const mrpt::maps::CMetricMap*> results(N, nullptr);
+    std::vector<std::thread>                   threads;
+    for (std::size_t i = 0; i < N; i++)
+    {
+        threads.emplace_back(
+            [&, i]() { results[i] = &cache.get(pts, customLeaf); });
+    }
+    for (auto& t : threads) t.join();
+
+    // All threads got the same index, built only once:
+    for (const auto* r : results) ASSERT_EQUAL_(r, results.front());
+    ASSERT_EQUAL_(cache.size(), 1U);
+
+    std::cout << "test_concurrent_get: OK\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_build_once();
+        test_invalidation();
+        test_concurrent_get();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
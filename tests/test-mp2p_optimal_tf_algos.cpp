@@ -244,10 +244,10 @@ std::tuple<mrpt::poses::CPose3D, std::vector<std::size_t>>
         planePairs.push_back(pair);
 
         // Add point-plane pairing:
-        mp2p_icp::point_plane_pair_t pt2pl;
-        pt2pl.pl_global = plA[i];
-        pt2pl.pt_local  = mrpt::math::TPoint3Df(
-             plB[i].centroid.x, plB[i].centroid.y, plB[i].centroid.z);
+        const mp2p_icp::point_plane_pair_t pt2pl(
+            plA[i], mrpt::math::TPoint3Df(
+                        plB[i].centroid.x, plB[i].centroid.y,
+                        plB[i].centroid.z));
 
         pt2plPairs.push_back(pt2pl);
     }
@@ -29,24 +29,21 @@ static void test_opt_pt2pl(
     mp2p_icp::Pairings p;
 
     {
-        auto& pp     = p.paired_pt2pl.emplace_back();
-        pp.pl_global = {
-            mrpt::math::TPlane::FromPointAndNormal({0, 0, 0}, {0, 0, 1}),
-            {0, 0, 0}};
+        auto& pp = p.paired_pt2pl.emplace_back();
+        pp.set_plane(
+            mrpt::math::TPlane::FromPointAndNormal({0, 0, 0}, {0, 0, 1}));
         pp.pt_local = groundTruth.inverseComposePoint({0.5, 0, 0});
     }
     {
-        auto& pp     = p.paired_pt2pl.emplace_back();
-        pp.pl_global = {
-            mrpt::math::TPlane::FromPointAndNormal({0, 0, 0}, {1, 0, 0}),
-            {0, 0, 0}};
+        auto& pp = p.paired_pt2pl.emplace_back();
+        pp.set_plane(
+            mrpt::math::TPlane::FromPointAndNormal({0, 0, 0}, {1, 0, 0}));
         pp.pt_local = groundTruth.inverseComposePoint({0, 0.8, 0});
     }
     {
-        auto& pp     = p.paired_pt2pl.emplace_back();
-        pp.pl_global = {
-            mrpt::math::TPlane::FromPointAndNormal({0, 0, 0}, {0, 1, 0}),
-            {0, 0, 0}};
+        auto& pp = p.paired_pt2pl.emplace_back();
+        pp.set_plane(
+            mrpt::math::TPlane::FromPointAndNormal({0, 0, 0}, {0, 1, 0}));
         pp.pt_local = groundTruth.inverseComposePoint({0, 0, 0.3});
     }
     {
@@ -75,6 +72,15 @@ static void test_opt_pt2pl(
         mrpt::poses::Lie::SE<3>::log(result.optimalPose - groundTruth).norm(),
         0.0, 1e-3);
 
+    // Convergence telemetry:
+    ASSERT_(result.hessianEigenvalues.has_value());
+    if (!result.iterations.empty())
+    {
+        ASSERT_LE_(
+            result.iterations.back().cost,
+            result.iterations.front().cost + 1e-9);
+    }
+
     MRPT_END
 }
 
@@ -91,10 +97,24 @@ static void test_mp2p_optimize_pt2pl()
         // solverParams["innerLoopVerbose"] = true;
         solverGN.initialize(solverParams);
     }
+    mp2p_icp::Solver_GaussNewton solverLM;
+    {
+        mrpt::containers::yaml solverParams;
+        solverParams["maxIterations"] = 25;
+        solverParams["stepControl"]   = "GNStepControl::LevenbergMarquardt";
+        solverLM.initialize(solverParams);
+    }
+    mp2p_icp::Solver_GaussNewton solverGNFloat;
+    {
+        mrpt::containers::yaml solverParams;
+        solverParams["maxIterations"]   = 25;
+        solverParams["singlePrecision"] = true;
+        solverGNFloat.initialize(solverParams);
+    }
     // mp2p_icp::Solver_Horn solverHorn;
 
     const std::vector<const mp2p_icp::Solver*> solvers = {
-        &solverGN,
+        &solverGN, &solverLM, &solverGNFloat,
         //&solverHorn
     };
 
@@ -139,11 +159,67 @@ static void test_mp2p_optimize_pt2pl()
     }
 }
 
+// A corridor along "x": floor and two walls, so the translation in "x" is
+// unobservable.
+static void test_mp2p_optimize_pt2pl_degenerate()
+{
+    const auto groundTruth =
+        mrpt::poses::CPose3D::FromTranslation(0.3, 0.2, 0.1);
+
+    mp2p_icp::Pairings p;
+
+    const auto lambdaAddPair = [&](const mrpt::math::TPoint3D&  g,
+                                   const mrpt::math::TVector3D& n)
+    {
+        const auto l = groundTruth.inverseComposePoint(g);
+        p.paired_pt2pl.emplace_back(
+            mrpt::math::TPlane::FromPointAndNormal(g, n),
+            mrpt::math::TPoint3Df(l.x, l.y, l.z));
+    };
+
+    for (int i = 0; i < 10; i++)
+    {
+        const double x = -5.0 + i;
+        lambdaAddPair({x, -0.5 + 0.1 * i, 0}, {0, 0, 1});  // floor
+        lambdaAddPair({x, -1.0, 0.2 * i}, {0, 1, 0});  // wall #1
+        lambdaAddPair({x, 1.0, 0.2 * (10 - i)}, {0, -1, 0});  // wall #2
+    }
+
+    mp2p_icp::Solver_GaussNewton solver;
+    {
+        mrpt::containers::yaml solverParams;
+        solverParams["maxIterations"]       = 10;
+        solverParams["degeneracyThreshold"] = 1e-6;
+        solver.initialize(solverParams);
+    }
+
+    mp2p_icp::OptimalTF_Result result;
+    mp2p_icp::SolverContext    sc;
+    sc.guessRelativePose = mrpt::poses::CPose3D::Identity();
+
+    ASSERT_(solver.optimal_pose(p, result, sc));
+
+    std::cout << "Degenerate case, optimalPose: " << result.optimalPose
+              << std::endl;
+
+    // Observable coordinates are solved, "x" is left untouched:
+    ASSERT_NEAR_(result.optimalPose.x(), 0.0, 1e-3);
+    ASSERT_NEAR_(result.optimalPose.y(), 0.2, 1e-3);
+    ASSERT_NEAR_(result.optimalPose.z(), 0.1, 1e-3);
+    ASSERT_NEAR_(result.optimalPose.yaw(), 0.0, 1e-3);
+
+    ASSERT_(result.wellConstrainedProjector.has_value());
+    const auto& P = *result.wellConstrainedProjector;
+    ASSERT_LT_(P(0, 0), 0.01);
+    for (int i = 1; i < 6; i++) ASSERT_GT_(P(i, i), 0.99);
+}
+
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 {
     try
     {
         test_mp2p_optimize_pt2pl();
+        test_mp2p_optimize_pt2pl_degenerate();
     }
     catch (std::exception& e)
     {
@@ -0,0 +1,192 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_quality_paired_ratio.cpp
+ * @brief  Unit tests for QualityEvaluator_PairedRatio on random subsets
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/Matcher_Points_Base.h>
+#include <mp2p_icp/QualityEvaluator_PairedRatio.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+constexpr std::size_t NUM_POINTS = 30000;
+
+// Local points are the global ones, except 2 out of each 5, moved away so
+// they cannot be paired: the true pairing ratio is exactly 0.6.
+void generateMaps(mp2p_icp::metric_map_t& global, mp2p_icp::metric_map_t& local)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(123);
+
+    auto g = mrpt::maps::CSimplePointsMap::Create();
+    auto l = mrpt::maps::CSimplePointsMap::Create();
+    for (std::size_t i = 0; i < NUM_POINTS; i++)
+    {
+        const float x = rng.drawUniform(-10.0f, 10.0f);
+        const float y = rng.drawUniform(-10.0f, 10.0f);
+        const float z = rng.drawUniform(-1.0f, 1.0f);
+
+        g->insertPoint(x, y, z);
+        l->insertPoint(x, y, (i % 5) < 3 ? z : z + 100.0f);
+    }
+
+    global.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW] = g;
+    local.layers[mp2p_icp::metric_map_t::PT_LAYER_RAW]  = l;
+}
+
+void initEvaluator(
+    mp2p_icp::QualityEvaluator_PairedRatio& q, uint64_t maxLocalPoints,
+    double minRatio)
+{
+    mrpt::containers::yaml p;
+    p["reuse_icp_pairings"]             = false;
+    p["threshold"]                      = 0.05;
+    p["thresholdAngularDeg"]            = 0.0;
+    p["maxLocalPointsToEvaluate"]       = maxLocalPoints;
+    p["absolute_minimum_pairing_ratio"] = minRatio;
+    q.initialize(p);
+}
+
+void test_random_subset_sampling()
+{
+    mp2p_icp::metric_map_t global, local;
+    generateMaps(global, local);
+
+    const auto& pts =
+        *local.point_layer(mp2p_icp::metric_map_t::PT_LAYER_RAW);
+
+    using mp2p_icp::Matcher_Points_Base;
+    const mrpt::poses::CPose3D pose;
+
+    // Fewer points than the limit: all of them, no index list.
+    {
+        const auto tl = Matcher_Points_Base::transform_local_to_global(
+            pts, pose, NUM_POINTS, 1);
+        ASSERT_(!tl.idxs.has_value());
+        ASSERT_EQUAL_(tl.x_locals.size(), NUM_POINTS);
+    }
+
+    // A subset: distinct indices, sorted, repeatable for the same seed:
+    const std::size_t M = 2000;
+
+    const auto tl1 =
+        Matcher_Points_Base::transform_local_to_global(pts, pose, M, 1);
+    const auto tl2 =
+        Matcher_Points_Base::transform_local_to_global(pts, pose, M, 1);
+    const auto tl3 =
+        Matcher_Points_Base::transform_local_to_global(pts, pose, M, 2);
+
+    ASSERT_(tl1.idxs.has_value());
+    ASSERT_EQUAL_(tl1.idxs->size(), M);
+    ASSERT_EQUAL_(tl1.x_locals.size(), M);
+    for (std::size_t i = 0; i < M; i++)
+    {
+        ASSERT_LT_((*tl1.idxs)[i], NUM_POINTS);
+        if (i > 0) ASSERT_LT_((*tl1.idxs)[i - 1], (*tl1.idxs)[i]);
+
+        // Points match their indices:
+        float x = 0, y = 0, z = 0;
+        pts.getPoint((*tl1.idxs)[i], x, y, z);
+        ASSERT_EQUAL_(tl1.x_locals[i], x);
+        ASSERT_EQUAL_(tl1.z_locals[i], z);
+    }
+    ASSERT_(*tl1.idxs == *tl2.idxs);
+    ASSERT_(*tl1.idxs != *tl3.idxs);
+
+    std::cout << "test_random_subset_sampling: OK\n";
+}
+
+void test_subset_ratio_and_margin()
+{
+    mp2p_icp::metric_map_t global, local;
+    generateMaps(global, local);
+
+    const mrpt::poses::CPose3D pose;
+    const mp2p_icp::Pairings   noPairings;
+
+    // All points: the exact ratio, with no margin.
+    {
+        mp2p_icp::QualityEvaluator_PairedRatio q;
+        initEvaluator(q, 0, 0.61);
+
+        const auto r = q.evaluate(global, local, pose, noPairings);
+        ASSERT_NEAR_(r.quality, 0.6, 1e-9);
+        ASSERT_(r.hard_discard);
+    }
+
+    // A random subset: an estimate, within a few standard errors, and the
+    // same one on each call since the default seed is fixed:
+    const uint64_t M = 2000;
+    double         qSubset = 0;
+    {
+        mp2p_icp::QualityEvaluator_PairedRatio q;
+        initEvaluator(q, M, 0.0);
+
+        const auto r1 = q.evaluate(global, local, pose, noPairings);
+        const auto r2 = q.evaluate(global, local, pose, noPairings);
+        ASSERT_EQUAL_(r1.quality, r2.quality);
+        ASSERT_NEAR_(r1.quality, 0.6, 4 * 0.5 / std::sqrt(double(M)));
+        ASSERT_(!r1.hard_discard);
+
+        qSubset = r1.quality;
+    }
+
+    // Discard only below the estimate minus the ~95% confidence margin:
+    const double margin = 2.0 * std::sqrt(qSubset * (1 - qSubset) / M);
+    {
+        mp2p_icp::QualityEvaluator_PairedRatio q;
+        initEvaluator(q, M, qSubset + 0.5 * margin);
+        ASSERT_(!q.evaluate(global, local, pose, noPairings).hard_discard);
+    }
+    {
+        mp2p_icp::QualityEvaluator_PairedRatio q;
+        initEvaluator(q, M, qSubset + 1.5 * margin);
+        ASSERT_(q.evaluate(global, local, pose, noPairings).hard_discard);
+    }
+
+    // The reused matcher state must work for other maps too:
+    {
+        mp2p_icp::QualityEvaluator_PairedRatio q;
+        initEvaluator(q, 0, 0.0);
+
+        ASSERT_NEAR_(
+            q.evaluate(global, local, pose, noPairings).quality, 0.6, 1e-9);
+        ASSERT_NEAR_(
+            q.evaluate(global, global, pose, noPairings).quality, 1.0, 1e-9);
+        ASSERT_NEAR_(
+            q.evaluate(global, local, pose, noPairings).quality, 0.6, 1e-9);
+    }
+
+    std::cout << "test_subset_ratio_and_margin: OK (subset estimate: "
+              << qSubset << " +- " << margin << ")\n";
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_random_subset_sampling();
+        test_subset_ratio_and_margin();
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}
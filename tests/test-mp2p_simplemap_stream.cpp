@@ -0,0 +1,153 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-mp2p_simplemap_stream.cpp
+ * @brief  Unit tests for SimpleMapReader and SimpleMapWriter
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 19, 2026
+ */
+
+#include <mp2p_icp/SimpleMapStream.h>
+#include <mrpt/obs/CObservationComment.h>
+#include <mrpt/poses/CPose3DPDFGaussian.h>
+#include <mrpt/system/filesystem.h>
+
+static mrpt::maps::CSimpleMap generateSimpleMap(std::size_t nKFs)
+{
+    mrpt::maps::CSimpleMap sm;
+    for (std::size_t i = 0; i < nKFs; i++)
+    {
+        auto pose = mrpt::poses::CPose3DPDFGaussian::Create();
+        pose->mean = mrpt::poses::CPose3D::FromTranslation(1.0 * i, 2.0, 0);
+
+        auto obs         = mrpt::obs::CObservationComment::Create();
+        obs->sensorLabel = "comment";
+        obs->text        = std::to_string(i);
+
+        auto sf = mrpt::obs::CSensoryFrame::Create();
+        sf->insert(obs);
+
+        std::optional<mrpt::math::TTwist3D> twist;
+        if (i % 2) twist = mrpt::math::TTwist3D(0.1 * i, 0, 0, 0, 0, 0);
+
+        sm.insert(pose, sf, twist);
+    }
+    return sm;
+}
+
+static void checkKeyframe(
+    const mrpt::maps::CSimpleMap::Keyframe& kf, std::size_t i, double dz)
+{
+    const auto& [pose, sf, twist] = kf;
+    ASSERT_(pose && sf);
+
+    const auto p = pose->getMeanVal();
+    ASSERT_NEAR_(p.x(), 1.0 * i, 1e-9);
+    ASSERT_NEAR_(p.z(), dz, 1e-9);
+
+    ASSERT_EQUAL_(sf->size(), 1U);
+    const auto obs =
+        sf->getObservationByClass<mrpt::obs::CObservationComment>();
+    ASSERT_(obs);
+    ASSERT_EQUAL_(obs->text, std::to_string(i));
+
+    ASSERT_EQUAL_(twist.has_value(), (i % 2) == 1);
+    if (twist) ASSERT_NEAR_(twist->vx, 0.1 * i, 1e-9);
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        const auto fileIn  = mrpt::system::getTempFileName() + ".simplemap";
+        const auto fileOut = mrpt::system::getTempFileName() + ".simplemap";
+
+        const std::size_t N = 7;
+        generateSimpleMap(N).saveToFile(fileIn);
+
+        // Read a regular simplemap, and write a transformed one, keyframe
+        // by keyframe:
+        {
+            mp2p_icp::SimpleMapReader r(fileIn);
+            ASSERT_EQUAL_(r.size(), N);
+
+            mp2p_icp::BlockGZOutputStream::Parameters p;
+            p.blockSize = 100;  // Force many blocks
+            p.threads   = 2;
+
+            mp2p_icp::SimpleMapWriter w(fileOut, p);
+
+            mrpt::maps::CSimpleMap::Keyframe kf;
+            for (std::size_t i = 0; r.next(kf); i++)
+            {
+                checkKeyframe(kf, i, 0.0);
+
+                kf.pose->changeCoordinatesReference(
+                    mrpt::poses::CPose3D::FromTranslation(0, 0, 5.0));
+                w.append(kf);
+            }
+            ASSERT_EQUAL_(r.read_count(), N);
+            ASSERT_EQUAL_(w.size(), N);
+
+            w.close();
+        }
+
+        // The output must be readable by MRPT as usual:
+        {
+            mrpt::maps::CSimpleMap sm;
+            ASSERT_(sm.loadFromFile(fileOut));
+            ASSERT_EQUAL_(sm.size(), N);
+            for (std::size_t i = 0; i < N; i++)
+                checkKeyframe(sm.get(i), i, 5.0);
+        }
+
+        // Writers not explicitly closed must neither create nor replace the
+        // output file, and must remove their temporary files:
+        const auto fileDiscarded = mrpt::system::getTempFileName();
+        {
+            mp2p_icp::SimpleMapWriter w(fileDiscarded);
+            w.append(generateSimpleMap(1).get(0));
+        }
+        ASSERT_(!mrpt::system::fileExists(fileDiscarded));
+        ASSERT_(!mrpt::system::fileExists(fileDiscarded + ".body.tmp"));
+        {
+            mp2p_icp::SimpleMapWriter w(fileOut);
+            w.append(generateSimpleMap(1).get(0));
+            w.discard();
+            ASSERT_(!w.is_open());
+        }
+        {
+            mrpt::maps::CSimpleMap sm;
+            ASSERT_(sm.loadFromFile(fileOut));
+            ASSERT_EQUAL_(sm.size(), N);
+        }
+
+        // Empty maps:
+        {
+            mp2p_icp::SimpleMapWriter w(fileOut);
+            w.close();
+        }
+        ASSERT_(!mrpt::system::fileExists(fileOut + ".body.tmp"));
+        {
+            mrpt::maps::CSimpleMap sm;
+            ASSERT_(sm.loadFromFile(fileOut));
+            ASSERT_(sm.empty());
+
+            mp2p_icp::SimpleMapReader r(fileOut);
+            mrpt::maps::CSimpleMap::Keyframe kf;
+            ASSERT_(!r.next(kf));
+        }
+
+        mrpt::system::deleteFile(fileIn);
+        mrpt::system::deleteFile(fileOut);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << mrpt::exception_to_str(e) << "\n";
+        return 1;
+    }
+}